@@ -1,5 +1,7 @@
 #include "FastDivision.h"
 
+#if defined(__AVR__)
+
 uint16_t divu10(uint16_t n)
 {
   uint16_t working;
@@ -147,3 +149,5 @@ void divmod10(uint32_t in, uint32_t &div, uint8_t &mod)
     : "r"(in), "r"(&mod), "r"(&div)
     : "r0", "r26", "r27", "r31", "r31");
 }
+
+#endif /* __AVR__ */
@@ -26,6 +26,14 @@ constexpr auto divu1(uint16_t n)
   return n;
 }
 
+#if defined(__AVR__)
 extern void divmod10(uint32_t in, uint32_t &div, uint8_t &mod) __attribute__((noinline));
+#else
+inline void divmod10(uint32_t in, uint32_t &div, uint8_t &mod)
+{
+  div = in / 10;
+  mod = static_cast< uint8_t >(in - div * 10);
+}
+#endif
 
 #endif /* FASTDIVISION_H */
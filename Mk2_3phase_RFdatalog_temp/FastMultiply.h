@@ -0,0 +1,92 @@
+/**
+ * @file FastMultiply.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Signed 16x16 -> 32 bits multiplication kernel
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The products of the ISR only have 16-bit operands, but when written as int32_t
+ *          multiplications, avr-gcc calls its generic 32x32 routine (__mulsi3).
+ *          On AVR, this kernel only uses the 4 hardware multiplications needed
+ *          (muls, mul, and 2 x mulsu, see Atmel AVR201).
+ *          Elsewhere (native tests, replay), the portable fallback is used.
+ *
+ *          The samples minus DC divided by 4 (x64) only fit in 16 bits for ±511 ADC steps:
+ *          a waveform clipped at a rail with a DC offset away from the mid-point, the phase-shift
+ *          extrapolation or the gain of the CT filter can exceed it. mulS32() checks the range
+ *          once, and falls back to the int32_t multiplication, so that the results are unchanged.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef FASTMULTIPLY_H
+#define FASTMULTIPLY_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Signed 16x16 bits multiplication, 32-bit result
+ *
+ * @param a The first operand
+ * @param b The second operand
+ * @return a * b
+ *
+ * @ingroup TimeCritical
+ */
+inline int32_t mulS16(const int16_t a, const int16_t b)
+{
+#if defined(__AVR__)
+  int32_t result;
+  uint8_t zero;
+  asm(
+    "clr   %1       \n\t"
+
+    "muls  %B2, %B3 \n\t"  // (signed)ah * (signed)bh
+    "movw  %C0, r0  \n\t"
+
+    "mul   %A2, %A3 \n\t"  // al * bl
+    "movw  %A0, r0  \n\t"
+
+    "mulsu %B2, %A3 \n\t"  // (signed)ah * bl
+    "sbc   %D0, %1  \n\t"  // sign extension
+    "add   %B0, r0  \n\t"
+    "adc   %C0, r1  \n\t"
+    "adc   %D0, %1  \n\t"
+
+    "mulsu %B3, %A2 \n\t"  // (signed)bh * al
+    "sbc   %D0, %1  \n\t"  // sign extension
+    "add   %B0, r0  \n\t"
+    "adc   %C0, r1  \n\t"
+    "adc   %D0, %1  \n\t"
+
+    "clr   r1       \n\t"  // restore __zero_reg__
+
+    : "=&r"(result), "=&r"(zero)
+    : "a"(a), "a"(b)
+    : "r0", "r1");
+  return result;
+#else
+  return static_cast< int32_t >(a) * b;
+#endif
+}
+
+/**
+ * @brief Signed 32x32 bits multiplication, 32-bit result, with the 16x16 kernel when the operands fit
+ *
+ * @param a The first operand
+ * @param b The second operand
+ * @return a * b, as the int32_t multiplication
+ *
+ * @ingroup TimeCritical
+ */
+inline int32_t mulS32(const int32_t a, const int32_t b)
+{
+  if (static_cast< int16_t >(a) == a && static_cast< int16_t >(b) == b)
+  {
+    return mulS16(static_cast< int16_t >(a), static_cast< int16_t >(b));
+  }
+  return a * b;  // beyond ±511 ADC steps, rare
+}
+
+#endif /* FASTMULTIPLY_H */
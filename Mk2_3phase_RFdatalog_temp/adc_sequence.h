@@ -0,0 +1,77 @@
+/**
+ * @file adc_sequence.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Compile-time generated sequence of the ADC conversions
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details A sample set is made of one voltage and one current conversion per phase, in the
+ *          order V1, I1, V2, I2, ... The length of the sample set therefore depends on the
+ *          number of phases: the fewer the phases, the more sample sets per mains cycle.
+ *
+ *          The ADC being in free-running mode, when a conversion has finished the next one is
+ *          already under way. Each step of the sequence therefore holds the analog input of
+ *          the conversion after next ("look ahead").
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ADC_SEQUENCE_H
+#define ADC_SEQUENCE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief One step of the ADC sequence, executed when a conversion has finished
+ *
+ */
+struct AdcStep
+{
+  uint8_t nextChannel; /**< analog input to select for the conversion after next */
+  uint8_t phase;       /**< phase of the conversion which has just finished */
+  bool voltage;        /**< true if the conversion which has just finished is a voltage, false for a current */
+};
+
+/**
+ * @brief Sequence of the ADC conversions for a sample set
+ *
+ * @tparam N Number of phases
+ */
+template< uint8_t N >
+struct AdcSequence
+{
+  static_assert(N > 0, "******** At least one phase is needed ! ********");
+
+  static constexpr uint8_t size{ 2 * N }; /**< number of conversions per sample set */
+
+  AdcStep steps[size]; /**< steps, in the order of the conversions */
+};
+
+/**
+ * @brief Builds the sequence of the ADC conversions at compile time
+ *
+ * @tparam N Number of phases
+ * @param channelV Analog input of the voltage sensor for each phase
+ * @param channelI Analog input of the current sensor for each phase
+ * @param lookAhead 2 to select the conversion after next (free-running), 1 for the next one (Timer1-triggered)
+ * @return The sequence of the conversions V1, I1, V2, I2, ...
+ */
+template< uint8_t N >
+constexpr AdcSequence< N > makeAdcSequence(const uint8_t (&channelV)[N], const uint8_t (&channelI)[N], const uint8_t lookAhead = 2)
+{
+  AdcSequence< N > sequence{};
+
+  for (uint8_t i = 0; i < AdcSequence< N >::size; ++i)
+  {
+    const uint8_t next{ static_cast< uint8_t >((i + lookAhead) % AdcSequence< N >::size) };  // the conversion whose channel is selected
+
+    sequence.steps[i].nextChannel = (next & 1) ? channelI[next >> 1] : channelV[next >> 1];
+    sequence.steps[i].phase = i >> 1;
+    sequence.steps[i].voltage = !(i & 1);
+  }
+
+  return sequence;
+}
+
+#endif /* ADC_SEQUENCE_H */
@@ -0,0 +1,88 @@
+/**
+ * @file adc_timing.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Timing of the ADC conversions, and the rate-dependent constants derived from it
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details Two trigger modes are available (see config_system.h):
+ *          - free-running (default): each conversion starts as soon as the previous one has
+ *            completed, every 13 ADC clocks. The rate only depends on the clock and the prescaler
+ *            (104 µs @ 16 MHz / 128). When the ISR runs, the next conversion is already under way,
+ *            so the ISR selects the channel of the conversion after next (look-ahead of 2).
+ *          - Timer1-triggered (ADC_TIMER_TRIGGERED): Timer1 runs in CTC mode and each compare
+ *            match B starts a conversion, every ADC_TIMER_PERIOD CPU cycles. The rate is fixed
+ *            and chosen freely, e.g. for a whole number of sample sets per mains cycle. The next
+ *            conversion only starts at the next compare match, after the ISR, so the ISR selects
+ *            the channel of the next conversion (look-ahead of 1).
+ *
+ *          The /64 prescaler (ADC_PRESCALER_64) halves the conversion time. The ADC clock is then
+ *          250 kHz @ 16 MHz, above the 200 kHz recommended for the full 10-bit resolution.
+ *
+ *          Everything depending on the sampling rate (PLL, histogram of the sample sets, table of
+ *          reciprocals, emulated ADC) is derived from ADC_SAMPLE_PERIOD_CYCLES at compile time.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ADC_TIMING_H
+#define ADC_TIMING_H
+
+#include <Arduino.h>
+
+#include "config_system.h"
+
+inline constexpr uint8_t ADC_PRESCALER{ ADC_PRESCALER_64 ? 64 : 128 }; /**< division of F_CPU for the ADC clock */
+
+inline constexpr uint8_t ADC_CLOCKS_PER_CONVERSION{ 13 };              /**< free-running conversion */
+inline constexpr uint8_t ADC_CLOCKS_PER_TRIGGERED_CONVERSION_X2{ 27 }; /**< auto-triggered conversion, 13.5 ADC clocks */
+
+inline constexpr uint16_t ADC_CONVERSION_CYCLES{ ADC_PRESCALER * ADC_CLOCKS_PER_CONVERSION };                              /**< duration of a free-running conversion, in CPU cycles */
+inline constexpr uint16_t ADC_TRIGGERED_CONVERSION_CYCLES{ ADC_PRESCALER * ADC_CLOCKS_PER_TRIGGERED_CONVERSION_X2 / 2 }; /**< duration of an auto-triggered conversion, in CPU cycles */
+
+/**
+ * @brief Period of the conversions, in CPU cycles
+ *
+ */
+inline constexpr uint16_t ADC_SAMPLE_PERIOD_CYCLES{ ADC_TIMER_TRIGGERED ? ADC_TIMER_PERIOD : ADC_CONVERSION_CYCLES };
+
+inline constexpr uint8_t ADC_LOOK_AHEAD{ ADC_TIMER_TRIGGERED ? 1 : 2 }; /**< how many conversions ahead the ISR selects the channel */
+
+/**
+ * @brief Worst-case delay, in CPU cycles, from the end of a conversion to the re-arming of the trigger
+ *
+ * @details Another ISR running when the conversion completes (Timer0 overflow of millis(), UDRE of the
+ *          serial link: ~80 cycles), the interrupt response (~10 cycles), the prologue of ISR(ADC_vect)
+ *          (~40 cycles), and its code up to acknowledgeADCTrigger() (~40 cycles), with some margin.
+ *          If the next compare match comes first, OCF1B is still set, so it has no rising edge and the
+ *          conversion of this slot is lost.
+ */
+inline constexpr uint16_t ADC_ISR_ENTRY_WORST_CASE_CYCLES{ 200 };
+
+static_assert(!ADC_TIMER_TRIGGERED || ADC_TIMER_PERIOD >= ADC_TRIGGERED_CONVERSION_CYCLES + ADC_ISR_ENTRY_WORST_CASE_CYCLES, "******** ADC_TIMER_PERIOD leaves no time to the ISR between two conversions ! ********");
+
+/**
+ * @brief Period of the conversions, in µs, rounded
+ *
+ */
+inline constexpr uint16_t ADC_SAMPLE_PERIOD_US{ static_cast< uint16_t >((ADC_SAMPLE_PERIOD_CYCLES + F_CPU / 2000000UL) / (F_CPU / 1000000UL)) };
+
+/**
+ * @brief Number of sample sets per second x100, with 8 fractional bits
+ *
+ * @details 2 conversions per phase
+ */
+inline constexpr uint32_t ADC_SAMPLE_SETS_PER_SECOND_X100_Q8{ static_cast< uint32_t >(F_CPU * 25600ULL / (ADC_SAMPLE_PERIOD_CYCLES * 2UL * NO_OF_PHASES)) };
+
+inline constexpr uint16_t ADC_SAMPLE_SETS_PER_SECOND{ static_cast< uint16_t >(F_CPU / (ADC_SAMPLE_PERIOD_CYCLES * 2UL * NO_OF_PHASES)) }; /**< number of sample sets per second, truncated */
+
+/**
+ * @brief Nominal number of sample sets per mains cycle, rounded
+ *
+ */
+inline constexpr uint8_t NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE{ static_cast< uint8_t >((F_CPU + ADC_SAMPLE_PERIOD_CYCLES * NO_OF_PHASES * SUPPLY_FREQUENCY) / (ADC_SAMPLE_PERIOD_CYCLES * 2UL * NO_OF_PHASES * SUPPLY_FREQUENCY)) };
+
+static_assert(F_CPU / (ADC_SAMPLE_PERIOD_CYCLES * 2UL * NO_OF_PHASES * SUPPLY_FREQUENCY) < UINT8_MAX, "******** Too many sample sets per mains cycle ! ********");
+
+#endif /* ADC_TIMING_H */
@@ -0,0 +1,216 @@
+/**
+ * @file binary_telemetry.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Compact binary telemetry frame, with COBS framing and CRC16
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When SERIAL_OUTPUT_TYPE is SerialOutputType::Binary (see config.h), each datalog period is
+ *          sent as a fixed-layout struct instead of text:
+ *
+ *          | header (8 bytes) | PayloadTx_struct | frequency | relay average | ... | load duties | relays | ... | CRC16 |
+ *
+ *          - all values are little-endian, the layout is the one of BinaryPayload_struct,
+ *          - the header holds the version of the layout and the number of phases, temperature sensors,
+ *            loads and relays, so a receiver can decode the frame without knowing the configuration,
+ *          - the CRC16 (CCITT, polynomial 0x1021, initial value 0xFFFF) covers the payload,
+ *          - payload and CRC are COBS-encoded, and followed by a 0x00 delimiter: a receiver joining the
+ *            stream or losing bytes resynchronizes at the next delimiter.
+ *
+ *          A 3-phase frame with 3 loads and no temperature sensor takes 40 bytes, against ~200 bytes in IoT format.
+ *
+ *          The encoding functions only depend on the standard types, and are shared with the native
+ *          decoder (see decoder/telemetry_decoder.h).
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef BINARY_TELEMETRY_H
+#define BINARY_TELEMETRY_H
+
+#include <Arduino.h>
+#include <stddef.h>
+
+#include "types.h"
+
+inline constexpr uint8_t BINARY_TELEMETRY_VERSION{ 1 }; /**< layout of BinaryPayload_struct */
+inline constexpr uint8_t BINARY_FRAME_DELIMITER{ 0x00 }; /**< end of each COBS-encoded frame */
+
+inline constexpr uint8_t BINARY_FLAG_OFF_PEAK{ 0x01 };    /**< the off-peak period is active (dual tariff) */
+inline constexpr uint8_t BINARY_FLAG_FREQUENCY{ 0x02 };   /**< the mains frequency is valid */
+inline constexpr uint8_t BINARY_FLAG_RELAYS{ 0x04 };      /**< relay diversion is enabled */
+inline constexpr uint8_t BINARY_FLAG_DUAL_TARIFF{ 0x08 }; /**< dual tariff is enabled */
+
+/**
+ * @brief Header of a binary frame
+ *
+ */
+struct BinaryHeader_struct
+{
+  uint8_t version{ BINARY_TELEMETRY_VERSION }; /**< layout of the payload */
+  uint8_t sequence{ 0 };                       /**< incremented at each frame, to detect the lost ones */
+  uint8_t flags{ 0 };                          /**< BINARY_FLAG_xxx */
+  uint8_t phases{ 0 };                         /**< number of phases */
+  uint8_t sensors{ 0 };                        /**< number of temperature sensors */
+  uint8_t loads{ 0 };                          /**< number of dump loads */
+  uint8_t relays{ 0 };                         /**< number of relays */
+  uint8_t reserved{ 0 };                       /**< keeps the 16-bit fields aligned */
+};
+
+/**
+ * @brief Payload of a binary frame
+ *
+ * @details Fields are appended in this order, each array having the size given in the header.
+ *          The 16-bit fields come first and the 8-bit ones are padded to an even size, so the layout
+ *          has no hidden padding on any target (checked below) and is sent as is.
+ *
+ * @tparam N # of phases
+ * @tparam S # of temperature sensors
+ * @tparam L # of dump loads
+ * @tparam R # of relays
+ */
+template< uint8_t N, uint8_t S, uint8_t L, uint8_t R >
+struct BinaryPayload_struct
+{
+  static_assert(R <= 8, "******** The binary telemetry carries up to 8 relays ! ********");
+
+  BinaryHeader_struct header{ BINARY_TELEMETRY_VERSION, 0, 0, N, S, L, R, 0 }; /**< version and dimensions */
+  PayloadTx_struct< N, S > data;                                               /**< powers, voltages and temperatures, as sent over RF */
+  uint16_t frequency_x100{ 0 };                                                /**< mains frequency (in 100th of Hz) */
+  int16_t relayAverage{ 0 };                                                   /**< average power seen by the relays */
+  uint16_t absenceOfDivertedEnergyCount{ 0 };                                  /**< number of seconds without diverted energy */
+  uint16_t sampleSets{ 0 };                                                    /**< number of sample sets during the datalog period */
+  uint8_t loadDuty_x2[L]{};                                                    /**< share of the period each load was ON (in 0.5 %) */
+  uint8_t relayStates{ 0 };                                                    /**< bit 'i' for relay 'i' */
+  uint8_t lowestNoOfSampleSetsPerMainsCycle{ 0 };                              /**< lowest number of sample sets in a mains cycle */
+  uint8_t padding[L % 2]{};                                                    /**< even size */
+};
+
+/**
+ * @brief Size of a payload, without any padding
+ *
+ * @param phases Number of phases
+ * @param sensors Number of temperature sensors
+ * @param loads Number of dump loads
+ * @return The size in bytes
+ */
+inline constexpr size_t binaryPayloadSize(const uint8_t phases, const uint8_t sensors, const uint8_t loads)
+{
+  return sizeof(BinaryHeader_struct)
+         + 2 + 4 * phases + 2 * sensors  // PayloadTx_struct
+         + 2 + 2 + 2 + 2                 // frequency, relay average, absence of diverted energy, sample sets
+         + loads + 1 + 1 + loads % 2;    // load duties, relay states, lowest number of sample sets, padding
+}
+
+static_assert(sizeof(BinaryPayload_struct< 3, 0, 3, 0 >) == binaryPayloadSize(3, 0, 3), "******** Padding in the binary telemetry payload ! ********");
+static_assert(sizeof(BinaryPayload_struct< 2, 4, 2, 8 >) == binaryPayloadSize(2, 4, 2), "******** Padding in the binary telemetry payload ! ********");
+
+inline constexpr uint8_t BINARY_CRC_SIZE{ 2 }; /**< CRC16 after the payload */
+
+/**
+ * @brief Size of the buffer holding an encoded frame
+ *
+ * @param payloadSize Size of the payload
+ * @return Payload, CRC, COBS overhead and delimiter
+ */
+inline constexpr size_t binaryFrameSize(const size_t payloadSize)
+{
+  return payloadSize + BINARY_CRC_SIZE + 1 + (payloadSize + BINARY_CRC_SIZE) / 254 + 1;
+}
+
+/**
+ * @brief Adds a byte to a CRC16 (CCITT, polynomial 0x1021, non-reflected)
+ *
+ * @param crc The current CRC, 0xFFFF for the first byte
+ * @param data The byte
+ * @return The new CRC
+ */
+inline uint16_t crc16Update(uint16_t crc, const uint8_t data)
+{
+  crc ^= static_cast< uint16_t >(data) << 8;
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = (crc & 0x8000) ? static_cast< uint16_t >((crc << 1) ^ 0x1021) : static_cast< uint16_t >(crc << 1);
+  }
+  return crc;
+}
+
+/**
+ * @brief CRC16 (CCITT) of a buffer
+ *
+ * @param data The buffer
+ * @param size Its size
+ * @return The CRC
+ */
+inline uint16_t crc16(const uint8_t* data, size_t size)
+{
+  uint16_t crc{ 0xFFFF };
+  while (size--)
+  {
+    crc = crc16Update(crc, *data++);
+  }
+  return crc;
+}
+
+/**
+ * @brief Encodes a buffer with COBS (Consistent Overhead Byte Stuffing)
+ *
+ * @details The output has no 0x00 byte. The delimiter is not added.
+ *
+ * @param in The buffer
+ * @param size Its size
+ * @param out The encoded buffer, of at least size + size / 254 + 1 bytes
+ * @return The size of the encoded buffer
+ */
+inline size_t cobsEncode(const uint8_t* in, const size_t size, uint8_t* out)
+{
+  size_t codePos{ 0 };
+  size_t outPos{ 1 };
+  uint8_t code{ 1 };
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (in[i])
+    {
+      out[outPos++] = in[i];
+      ++code;
+    }
+    if (!in[i] || code == 0xFF)
+    {
+      out[codePos] = code;
+      codePos = outPos++;
+      code = 1;
+    }
+  }
+  out[codePos] = code;
+
+  return outPos;
+}
+
+/**
+ * @brief Builds a complete frame: payload, CRC16, COBS encoding and delimiter
+ *
+ * @tparam T Type of the payload
+ * @param payload The payload
+ * @param frame The frame
+ * @return The size of the frame
+ */
+template< typename T >
+size_t encodeBinaryFrame(const T& payload, uint8_t (&frame)[binaryFrameSize(sizeof(T))])
+{
+  uint8_t raw[sizeof(T) + BINARY_CRC_SIZE];
+
+  memcpy(raw, &payload, sizeof(T));
+
+  const uint16_t crc{ crc16(raw, sizeof(T)) };
+  raw[sizeof(T)] = static_cast< uint8_t >(crc);
+  raw[sizeof(T) + 1] = static_cast< uint8_t >(crc >> 8);
+
+  size_t size{ cobsEncode(raw, sizeof(raw), frame) };
+  frame[size++] = BINARY_FRAME_DELIMITER;
+
+  return size;
+}
+
+#endif /* BINARY_TELEMETRY_H */
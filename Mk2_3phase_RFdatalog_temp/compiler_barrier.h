@@ -0,0 +1,27 @@
+/**
+ * @file compiler_barrier.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Compiler memory barrier, for the data shared between the ISR and the main loop
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef COMPILER_BARRIER_H
+#define COMPILER_BARRIER_H
+
+/**
+ * @brief Prevents the compiler from moving memory accesses across this point
+ *
+ * @details The AVR core has no out-of-order execution, only the compiler must be prevented
+ *          from reordering the accesses to non-volatile data around the volatile indexes.
+ */
+inline void compilerBarrier()
+{
+  asm volatile("" ::
+                 : "memory");
+}
+
+#endif /* COMPILER_BARRIER_H */
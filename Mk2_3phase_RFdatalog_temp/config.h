@@ -24,6 +24,7 @@
 //--------------------------------------------------------------------------------------------------
 //#define RF_PRESENT  /**< this line must be commented out if the RFM12B module is not present */
 #define ENABLE_DEBUG /**< enable this line to include debugging print statements */
+//#define ENERGY_BUCKET_FIXED_POINT /**< enable this line to use a fixed-point energy bucket instead of floats in the ISR */
 //--------------------------------------------------------------------------------------------------
 
 #include "config_system.h"
@@ -41,6 +42,8 @@ inline constexpr SerialOutputType SERIAL_OUTPUT_TYPE = SerialOutputType::HumanRe
 //
 inline constexpr uint8_t NO_OF_DUMPLOADS{ 3 }; /**< number of dump loads connected to the diverter */
 
+inline constexpr OutputModes outputMode{ OutputModes::NORMAL }; /**< set it to 'ANTI_FLICKER' to widen the hysteresis, or 'CYCLE_DISTRIBUTION' to spread the ON cycles of the loads evenly instead of switching them with the energy thresholds */
+
 // Feature toggles - Basic setup without advanced features
 inline constexpr bool EMONESP_CONTROL{ false };
 inline constexpr bool DIVERSION_PIN_PRESENT{ false };                   /**< set it to 'true' if you want to control diversion ON/OFF */
@@ -52,6 +55,19 @@ inline constexpr bool RELAY_DIVERSION{ false };      /**< set it to 'true' if a
 inline constexpr bool DUAL_TARIFF{ false };          /**< set it to 'true' if there's a dual tariff each day AND the router is connected to the billing meter */
 inline constexpr bool TEMP_SENSOR_PRESENT{ false };  /**< set it to 'true' if temperature sensing is needed */
 
+inline constexpr bool ISR_TIMING_INSTRUMENTATION{ false };   /**< set it to 'true' to measure the execution times of the ISR (uses Timer1) */
+inline constexpr bool SAMPLE_INTEGRITY_DIAGNOSTICS{ false }; /**< set it to 'true' to count the missed and late ADC conversions and the sample sets per mains cycle (uses Timer1, see sample_integrity.h) */
+inline constexpr bool BLOCK_PROCESSING{ false };           /**< set it to 'true' to only store the samples in the ISR and process them by blocks, with interrupts enabled */
+inline constexpr bool PLL_ZERO_CROSSING{ false };          /**< set it to 'true' to use the zero-crossings predicted by the PLL instead of the polarity persistence */
+inline constexpr bool MAINS_FREQUENCY_MEASUREMENT{ false }; /**< set it to 'true' to measure the mains frequency with the PLL of the first phase (see pll.h) */
+inline constexpr bool CURRENT_RMS_MEASUREMENT{ false };    /**< set it to 'true' to measure Irms, apparent power and power factor of each phase */
+inline constexpr bool CURRENT_DC_OFFSET_TRACKING{ false }; /**< set it to 'true' to track the DC offset of the current sensors instead of assuming the mid-point of the ADC */
+inline constexpr bool CYCLE_STREAMING{ false };            /**< set it to 'true' to stream a binary record of each mains cycle instead of the datalog output (see cycle_stream.h) */
+inline constexpr bool RUNTIME_PARAMETERS{ false };         /**< set it to 'true' to load the output mode and the thresholds from EEPROM and change them with serial commands */
+inline constexpr bool ENERGY_METERS{ false };              /**< set it to 'true' to count the imported, exported and diverted energy in Wh, saved in EEPROM (see energy_meters.h) */
+inline constexpr bool TELEMETRY_TX_QUEUE{ false };         /**< set it to 'true' to send the serial telemetry in the background instead of blocking loop() (see tx_queue.h) */
+inline constexpr bool TELEMETRY_DELTA_FRAMES{ false };     /**< set it to 'true' to only send the changed values between two keyframes in IoT format (see telemetry_delta.h) */
+
 #include "utils_temp.h"
 
 // ----------- Pinout Assignments -----------
@@ -89,8 +105,9 @@ inline constexpr bool TEMP_SENSOR_PRESENT{ false };  /**< set it to 'true' if te
 // Note: When using these pins for Home Assistant integration, ensure the ESP32
 // counterpart is properly configured to send the appropriate signals.
 
-inline constexpr uint8_t physicalLoadPin[NO_OF_DUMPLOADS]{ 5, 6, 7 };         /**< for 3-phase PCB, Load #1/#2/#3 (Rev 2 PCB) */
-inline constexpr uint8_t loadPrioritiesAtStartup[NO_OF_DUMPLOADS]{ 0, 1, 2 }; /**< load priorities and states at startup */
+inline constexpr uint8_t physicalLoadPin[NO_OF_DUMPLOADS]{ 5, 6, 7 };                 /**< for 3-phase PCB, Load #1/#2/#3 (Rev 2 PCB) */
+inline constexpr uint8_t loadPrioritiesAtStartup[NO_OF_DUMPLOADS]{ 0, 1, 2 };         /**< load priorities and states at startup */
+inline constexpr uint16_t loadRatedPowerInWatts[NO_OF_DUMPLOADS]{ 2000, 2000, 2000 }; /**< rated power of each load, to estimate the diverted energy (ENERGY_METERS) */
 
 // Set the value to 'unused_pin' when the pin is not needed (feature deactivated)
 inline constexpr uint8_t dualTariffPin{ unused_pin }; /**< for 3-phase PCB, off-peak trigger */
@@ -31,6 +31,45 @@ inline constexpr uint32_t WORKING_ZONE_IN_JOULES{ 3600UL }; /**< number of joule
 
 inline constexpr uint8_t DATALOG_PERIOD_IN_SECONDS{ 5 }; /**< Period of datalogging in seconds */
 
+inline constexpr uint32_t CYCLE_STREAMING_BAUD_RATE{ 115200 }; /**< baud rate of the serial link when CYCLE_STREAMING is set */
+inline constexpr uint8_t CYCLE_STREAM_BUFFER_SIZE{ 8 };        /**< number of per-cycle records buffered, a power of two (8: 160 ms @ 50 Hz) */
+
+inline constexpr uint16_t TX_QUEUE_SIZE{ 512 }; /**< size in bytes of the TX queue of the telemetry, a power of two holding at least one frame */
+
+inline constexpr uint8_t TELEMETRY_KEYFRAME_PERIOD{ 12 }; /**< with TELEMETRY_DELTA_FRAMES, number of datalog periods between two complete frames (12 @ 5 s: every minute) */
+
+/**
+ * @brief Smallest change of a value sent in a delta frame, per tag (TELEMETRY_DELTA_FRAMES)
+ *
+ */
+struct TelemetryDeadband
+{
+  const char* tag;   /**< the tag, without index */
+  uint16_t deadband; /**< in the unit of the value sent */
+};
+
+inline constexpr TelemetryDeadband TELEMETRY_DEADBANDS[]{
+  { "P", 20 },   // W
+  { "V", 50 },   // 0.5 V
+  { "R", 20 },   // W
+  { "D", 2 },    // %
+  { "T", 20 },   // 0.2 °C
+  { "F", 2 },    // 0.02 Hz
+  { "I", 5 },    // 0.05 A
+  { "VA", 20 },  // VA
+  { "PF", 2 },   // 0.02
+  { "S", 10 },   // sample sets
+}; /**< the values of the other tags are sent at each change */
+
+inline constexpr uint8_t ENERGY_METERS_SAVE_PERIOD_IN_MINUTES{ 15 }; /**< period of the saves of the energy meters in EEPROM */
+inline constexpr uint8_t ENERGY_METERS_EEPROM_SLOTS{ 16 };           /**< number of records of the ring in EEPROM (16 @ 15 min: each cell is written every 4 hours) */
+
+//--------------------------------------------------------------------------------------------------
+// timing of the ADC conversions, see adc_timing.h
+inline constexpr bool ADC_TIMER_TRIGGERED{ false }; /**< set it to 'true' to start the conversions with Timer1 every ADC_TIMER_PERIOD instead of free-running */
+inline constexpr bool ADC_PRESCALER_64{ false };    /**< set it to 'true' for conversions twice as fast (ADC clock F_CPU / 64 instead of / 128), at the expense of resolution */
+inline constexpr uint16_t ADC_TIMER_PERIOD{ 1975 }; /**< in CPU cycles, period of the Timer1-triggered conversions (1975 @ 16 MHz: ~123 µs, 27 sample sets per 50 Hz cycle with 3 phases) */
+
 inline constexpr typename conditional< DATALOG_PERIOD_IN_SECONDS * SUPPLY_FREQUENCY >= UINT8_MAX, uint16_t, uint8_t >::type DATALOG_PERIOD_IN_MAINS_CYCLES{ DATALOG_PERIOD_IN_SECONDS * SUPPLY_FREQUENCY }; /**< Period of datalogging in cycles */
 
 // Computes inverse value at compile time to use '*' instead of '/'
@@ -0,0 +1,71 @@
+/**
+ * @file ct_filter.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Compensation of the high-pass behaviour of the CTs (alpha, lpf_gain), in integer arithmetic
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details A low-pass filtered copy of the current is added to each current sample:
+ *          - lpf += alpha * (sample - lpf)
+ *          - sample += lpf_gain * lpf
+ *
+ *          The coefficients are scaled at compile time, so that the ISR does not use any
+ *          soft-float operation. When lpf_gain is 0, the filter is removed altogether.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef CT_FILTER_H
+#define CT_FILTER_H
+
+#include "calibration.h"
+#include "energy_bucket.h"
+
+inline constexpr uint8_t LPF_FRACTION_BITS{ 8 }; /**< extra fractional bits of the state of the filter, so that it has no dead zone */
+
+/**
+ * @brief Scales a coefficient at compile time, rounded
+ *
+ * @param value The coefficient
+ * @param shift The number of fractional bits
+ * @return The scaled coefficient
+ */
+constexpr uint16_t initLpfCoefficient(const float value, const uint8_t shift)
+{
+  return static_cast< uint16_t >(value * static_cast< float >(1UL << shift) + 0.5F);
+}
+
+inline constexpr uint16_t LPF_ALPHA_Q16{ initLpfCoefficient(alpha, 16) };                    /**< alpha * 2^16 */
+inline constexpr uint16_t LPF_GAIN_Q{ initLpfCoefficient(lpf_gain, 16 - LPF_FRACTION_BITS) }; /**< lpf_gain * 2^(16 - LPF_FRACTION_BITS) */
+
+static_assert(alpha > 0 && alpha < 1, "******** alpha must be in the range ]0..1[ ! ********");
+static_assert(lpf_gain >= 0 && lpf_gain * (1UL << (16 - LPF_FRACTION_BITS)) < 65535.5F, "******** lpf_gain must be in the range [0..256[ ! ********");
+
+/**
+ * @brief Adds the low-pass filtered current to a current sample.
+ *
+ * @tparam ALPHA_Q16 alpha * 2^16
+ * @tparam GAIN_Q lpf_gain * 2^(16 - LPF_FRACTION_BITS), 0 to disable the filter
+ * @param lpfState The state of the filter of the phase (x256, with LPF_FRACTION_BITS more fractional bits)
+ * @param sampleIminusDC The current sample, minus DC (x256)
+ * @return The compensated current sample, minus DC (x256)
+ *
+ * @ingroup TimeCritical
+ */
+template< uint16_t ALPHA_Q16 = LPF_ALPHA_Q16, uint16_t GAIN_Q = LPF_GAIN_Q >
+inline int32_t compensateCtHighPass(int32_t &lpfState, const int32_t sampleIminusDC)
+{
+  if constexpr (GAIN_Q == 0)
+  {
+    (void)lpfState;
+    return sampleIminusDC;
+  }
+  else
+  {
+    lpfState += mulShr16(sampleIminusDC * (1L << LPF_FRACTION_BITS) - lpfState, ALPHA_Q16);
+    return sampleIminusDC + mulShr16(lpfState, GAIN_Q);
+  }
+}
+
+#endif /* CT_FILTER_H */
@@ -0,0 +1,78 @@
+/**
+ * @file cycle_distribution.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Even distribution of the ON mains cycles of the loads (Bresenham), for the cycle-distribution output mode
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The total duty requested from the loads is shared out by priority: the loads of
+ *          highest priority are fully ON, the next one is modulated, the others are OFF.
+ *          Each load has an error accumulator, which gains the duty of the load at each mains cycle.
+ *          Whenever it reaches one full cycle, the load is ON for this mains cycle and a full cycle is
+ *          taken away. The ON cycles are therefore spread as evenly as possible: a duty of 1/3 gives
+ *          ON, OFF, OFF, ON, OFF, OFF, ... instead of a burst of ON cycles followed by a burst of OFF ones.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef CYCLE_DISTRIBUTION_H
+#define CYCLE_DISTRIBUTION_H
+
+#include <Arduino.h>
+
+inline constexpr uint16_t FULL_DUTY{ 256 }; /**< duty of a load which is ON at every mains cycle */
+
+/**
+ * @brief Bresenham scheduler of the ON mains cycles of N loads
+ *
+ * @tparam N Number of loads
+ */
+template< uint8_t N >
+class CycleDistributor
+{
+public:
+  static constexpr uint16_t MAX_DEMAND{ N * FULL_DUTY }; /**< all the loads fully ON */
+
+  /**
+   * @brief Decides which loads are ON during the next mains cycle.
+   *
+   * @param demand The total duty requested, in 1/FULL_DUTY of a load [0..MAX_DEMAND]
+   *
+   * @ingroup TimeCritical
+   */
+  void update(uint16_t demand)
+  {
+    for (uint8_t i = 0; i < N; ++i)
+    {
+      const uint16_t duty{ demand > FULL_DUTY ? FULL_DUTY : demand };
+      demand -= duty;
+
+      accumulator[i] += duty;
+      state[i] = (accumulator[i] >= FULL_DUTY);
+      if (state[i])
+      {
+        accumulator[i] -= FULL_DUTY;
+      }
+    }
+  }
+
+  /**
+   * @brief Whether the load of the given priority is ON during the current mains cycle.
+   *
+   * @param load The priority of the load [0..N[, 0 being the highest
+   * @return true if the load is ON
+   *
+   * @ingroup TimeCritical
+   */
+  bool isOn(const uint8_t load) const
+  {
+    return state[load];
+  }
+
+private:
+  uint16_t accumulator[N]{}; /**< error accumulator of each load, in 1/FULL_DUTY of a mains cycle */
+  bool state[N]{};           /**< state of each load during the current mains cycle */
+};
+
+#endif /* CYCLE_DISTRIBUTION_H */
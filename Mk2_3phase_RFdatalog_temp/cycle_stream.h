@@ -0,0 +1,187 @@
+/**
+ * @file cycle_stream.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Per-mains-cycle records, queued by the ISR and sent as binary frames by the main loop
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When CYCLE_STREAMING is set (see config.h), the ISR stores, at each mains cycle, the power of
+ *          each phase, the level of the energy bucket and the state of the loads in a ring buffer.
+ *          The ISR only copies a few bytes: the conversions are left to the main loop, which sends
+ *          each record as a frame when the serial link has room for it.
+ *
+ *          If the link can't keep up, the ring buffer fills up and the newest records are dropped.
+ *          Each record carries a sequence number and the number of records dropped just before it.
+ *
+ *          Frame layout (little-endian):
+ *          | 0xA5 | 0x5A | length | 'C' | sequence | dropped | loads | bucket (J, int16) | power L1..Ln (W, int16) | checksum |
+ *          'length' counts the bytes from 'C' to the last power, the checksum is such that the sum of
+ *          the bytes from 'length' to 'checksum' is 0 (modulo 256).
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef CYCLE_STREAM_H
+#define CYCLE_STREAM_H
+
+#include <Arduino.h>
+
+#include "config_system.h"
+#include "energy_bucket.h"
+#include "ring_buffer.h"
+
+inline constexpr uint8_t CYCLE_FRAME_SYNC_1{ 0xA5 }; /**< first synchronization byte of a frame */
+inline constexpr uint8_t CYCLE_FRAME_SYNC_2{ 0x5A }; /**< second synchronization byte of a frame */
+inline constexpr uint8_t CYCLE_FRAME_TYPE{ 'C' };    /**< type of a per-cycle record */
+
+inline constexpr uint8_t CYCLE_PAYLOAD_SIZE{ 4 + 2 + 2 * NO_OF_PHASES };     /**< type, sequence, dropped, loads, bucket, powers */
+inline constexpr uint8_t CYCLE_FRAME_SIZE{ 2 + 1 + CYCLE_PAYLOAD_SIZE + 1 }; /**< sync, length, payload, checksum */
+
+/**
+ * @brief State of a mains cycle, as stored by the ISR
+ *
+ */
+struct CycleRecord
+{
+  energy_t power[NO_OF_PHASES]{}; /**< energy of the last mains cycle of each phase, i.e. its average power in W */
+  energy_t energyInBucket{ 0 };   /**< level of the energy bucket, in Joules * SUPPLY_FREQUENCY */
+  uint8_t loads{ 0 };             /**< state of the physical loads, bit 'i' for load 'i' */
+  uint8_t sequence{ 0 };          /**< incremented at each mains cycle, dropped records included */
+  uint8_t dropped{ 0 };           /**< number of records dropped just before this one (saturated) */
+};
+
+/**
+ * @brief Ring buffer of the per-cycle records, with drop counters
+ *
+ * @tparam N Capacity, a power of two
+ */
+template< uint8_t N >
+class CycleStream
+{
+public:
+  /**
+   * @brief Queues the record of a mains cycle, ISR side.
+   *
+   * @param record The record, whose sequence and number of dropped records are set here
+   *
+   * @ingroup TimeCritical
+   */
+  void push(CycleRecord& record)
+  {
+    record.sequence = sequence++;
+    record.dropped = pendingDrops;
+
+    if (ring.push(record))
+    {
+      pendingDrops = 0;
+      return;
+    }
+
+    if (pendingDrops != UINT8_MAX)
+    {
+      ++pendingDrops;
+    }
+    if (droppedRecords != UINT16_MAX)
+    {
+      droppedRecords = droppedRecords + 1;
+    }
+  }
+
+  /**
+   * @brief Removes the oldest record, main loop side.
+   *
+   * @param record The record
+   * @return false if there is no record
+   */
+  bool pop(CycleRecord& record)
+  {
+    return ring.pop(record);
+  }
+
+  /**
+   * @brief Number of records waiting to be sent.
+   *
+   */
+  uint8_t size() const
+  {
+    return ring.size();
+  }
+
+  /**
+   * @brief Total number of dropped records (saturated).
+   *
+   * @note Read without disabling the interrupts, for diagnostics only.
+   */
+  uint16_t getDroppedRecords() const
+  {
+    return droppedRecords;
+  }
+
+private:
+  RingBuffer< CycleRecord, N > ring;     /**< the records */
+  uint8_t sequence{ 0 };                 /**< sequence of the next record */
+  uint8_t pendingDrops{ 0 };             /**< records dropped since the last queued one */
+  volatile uint16_t droppedRecords{ 0 }; /**< total number of dropped records */
+};
+
+/**
+ * @brief Converts an energy to a saturated 16-bit integer
+ *
+ * @param value The energy
+ * @param scale The scale to apply
+ * @return The scaled value, rounded
+ */
+inline int16_t toInt16(const energy_t value, const float scale = 1.0F)
+{
+  const float scaled{ energyToFloat(value) * scale };
+
+  if (scaled >= INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  if (scaled <= INT16_MIN)
+  {
+    return INT16_MIN;
+  }
+  return static_cast< int16_t >(scaled < 0 ? scaled - 0.5F : scaled + 0.5F);
+}
+
+/**
+ * @brief Builds the frame of a record
+ *
+ * @param record The record
+ * @param frame The frame
+ */
+inline void encodeCycleFrame(const CycleRecord& record, uint8_t (&frame)[CYCLE_FRAME_SIZE])
+{
+  uint8_t* p{ frame };
+
+  const auto put16 = [&p](const int16_t value) {
+    *p++ = static_cast< uint8_t >(value);
+    *p++ = static_cast< uint8_t >(static_cast< uint16_t >(value) >> 8);
+  };
+
+  *p++ = CYCLE_FRAME_SYNC_1;
+  *p++ = CYCLE_FRAME_SYNC_2;
+  *p++ = CYCLE_PAYLOAD_SIZE;
+  *p++ = CYCLE_FRAME_TYPE;
+  *p++ = record.sequence;
+  *p++ = record.dropped;
+  *p++ = record.loads;
+  put16(toInt16(record.energyInBucket, invSUPPLY_FREQUENCY));
+
+  for (const auto& power : record.power)
+  {
+    put16(toInt16(power));
+  }
+
+  uint8_t sum{ 0 };
+  for (uint8_t i = 2; i < CYCLE_FRAME_SIZE - 1; ++i)
+  {
+    sum += frame[i];
+  }
+  *p = static_cast< uint8_t >(-sum);
+}
+
+#endif /* CYCLE_STREAM_H */
@@ -0,0 +1,205 @@
+/**
+ * @file telemetry_decoder.cpp
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native decoder of the binary telemetry frames
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "telemetry_decoder.h"
+
+#include "binary_telemetry.h"
+
+namespace TelemetryDecoder
+{
+namespace
+{
+constexpr size_t MAX_PENDING_BYTES{ 1024 }; /**< longer runs without delimiter are garbage */
+
+/**
+ * @brief Little-endian reader of a decoded payload
+ */
+class Reader
+{
+public:
+  explicit Reader(const std::vector< uint8_t >& data)
+    : data{ data }
+  {
+  }
+
+  uint8_t u8()
+  {
+    return data[pos++];
+  }
+  uint16_t u16()
+  {
+    const uint16_t value{ static_cast< uint16_t >(data[pos] | (data[pos + 1] << 8)) };
+    pos += 2;
+    return value;
+  }
+  int16_t i16()
+  {
+    return static_cast< int16_t >(u16());
+  }
+
+private:
+  const std::vector< uint8_t >& data;
+  size_t pos{ 0 };
+};
+
+}  // namespace
+
+bool cobsDecode(const uint8_t* in, size_t size, std::vector< uint8_t >& out)
+{
+  out.clear();
+
+  size_t pos{ 0 };
+  while (pos < size)
+  {
+    const uint8_t code{ in[pos++] };
+    if (!code || pos + code - 1 > size)
+    {
+      return false;
+    }
+
+    for (uint8_t i = 1; i < code; ++i)
+    {
+      if (!in[pos])
+      {
+        return false;
+      }
+      out.push_back(in[pos++]);
+    }
+
+    if (code != 0xFF && pos < size)
+    {
+      out.push_back(0);
+    }
+  }
+  return true;
+}
+
+Status decodeFrame(const uint8_t* in, size_t size, Telemetry& telemetry)
+{
+  std::vector< uint8_t > raw;
+
+  if (!cobsDecode(in, size, raw))
+  {
+    return Status::BAD_COBS;
+  }
+  if (raw.size() < sizeof(BinaryHeader_struct) + BINARY_CRC_SIZE)
+  {
+    return Status::BAD_LENGTH;
+  }
+
+  const size_t dataSize{ raw.size() - BINARY_CRC_SIZE };
+  const uint16_t crc{ static_cast< uint16_t >(raw[dataSize] | (raw[dataSize + 1] << 8)) };
+  if (crc != crc16(raw.data(), dataSize))
+  {
+    return Status::BAD_CRC;
+  }
+
+  Reader reader{ raw };
+  BinaryHeader_struct header;
+  header.version = reader.u8();
+  header.sequence = reader.u8();
+  header.flags = reader.u8();
+  header.phases = reader.u8();
+  header.sensors = reader.u8();
+  header.loads = reader.u8();
+  header.relays = reader.u8();
+  header.reserved = reader.u8();
+
+  if (header.version != BINARY_TELEMETRY_VERSION)
+  {
+    return Status::BAD_VERSION;
+  }
+  if (dataSize != binaryPayloadSize(header.phases, header.sensors, header.loads) || header.relays > 8)
+  {
+    return Status::BAD_LENGTH;
+  }
+
+  Telemetry t;
+  t.version = header.version;
+  t.sequence = header.sequence;
+  t.offPeak = header.flags & BINARY_FLAG_OFF_PEAK;
+  t.dualTariff = header.flags & BINARY_FLAG_DUAL_TARIFF;
+  t.relayDiversion = header.flags & BINARY_FLAG_RELAYS;
+  t.frequencyValid = header.flags & BINARY_FLAG_FREQUENCY;
+
+  t.power = reader.i16();
+  for (uint8_t i = 0; i < header.phases; ++i)
+  {
+    t.power_L.push_back(reader.i16());
+  }
+  for (uint8_t i = 0; i < header.phases; ++i)
+  {
+    t.Vrms_L.push_back(reader.u16() * 0.01F);
+  }
+  for (uint8_t i = 0; i < header.sensors; ++i)
+  {
+    t.temperature_x100.push_back(reader.i16());
+    t.temperature.push_back(t.temperature_x100.back() * 0.01F);
+  }
+
+  t.frequency = reader.u16() * 0.01F;
+  t.relayAverage = reader.i16();
+  t.absenceOfDivertedEnergyCount = reader.u16();
+  t.sampleSets = reader.u16();
+
+  for (uint8_t i = 0; i < header.loads; ++i)
+  {
+    t.loadDutyInPercent.push_back(reader.u8() * 0.5F);
+  }
+
+  const uint8_t relayStates{ reader.u8() };
+  for (uint8_t i = 0; i < header.relays; ++i)
+  {
+    t.relayON.push_back(relayStates & (1U << i));
+  }
+
+  t.lowestNoOfSampleSetsPerMainsCycle = reader.u8();
+
+  telemetry = t;
+  return Status::OK;
+}
+
+bool StreamDecoder::feed(const uint8_t byte, Telemetry& telemetry)
+{
+  if (byte != BINARY_FRAME_DELIMITER)
+  {
+    if (pending.size() < MAX_PENDING_BYTES)
+    {
+      pending.push_back(byte);
+    }
+    return false;
+  }
+
+  if (pending.empty())
+  {
+    return false;  // consecutive delimiters
+  }
+
+  const Status status{ pending.size() < MAX_PENDING_BYTES ? decodeFrame(pending.data(), pending.size(), telemetry) : Status::BAD_LENGTH };
+  pending.clear();
+
+  if (status != Status::OK)
+  {
+    ++errors;
+    return false;
+  }
+
+  if (!firstFrame)
+  {
+    lostFrames += static_cast< uint8_t >(telemetry.sequence - lastSequence - 1);
+  }
+  firstFrame = false;
+  lastSequence = telemetry.sequence;
+  ++frames;
+
+  return true;
+}
+}  // namespace TelemetryDecoder
@@ -0,0 +1,113 @@
+/**
+ * @file telemetry_decoder.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native decoder of the binary telemetry frames
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details Decodes the frames sent when SERIAL_OUTPUT_TYPE is SerialOutputType::Binary (see binary_telemetry.h).
+ *          The dimensions are read from the header of each frame, so the decoder doesn't depend on the
+ *          configuration of the router it receives the frames from.
+ *
+ *          The bytes of the serial link are fed as they come. Corrupted or truncated frames are counted
+ *          and skipped, the decoder resynchronizing at the next delimiter.
+ *
+ *          This is a host-only library, hence the use of the standard library.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TelemetryDecoder
+{
+/** @brief Content of a binary frame */
+struct Telemetry
+{
+  uint8_t version{ 0 };                             /**< layout of the payload */
+  uint8_t sequence{ 0 };                            /**< frame counter */
+  bool offPeak{ false };                            /**< the off-peak period is active */
+  bool dualTariff{ false };                         /**< dual tariff is enabled */
+  bool relayDiversion{ false };                     /**< relay diversion is enabled */
+  bool frequencyValid{ false };                     /**< 'frequency' is valid */
+  int16_t power{ 0 };                               /**< total power, import = +ve (W) */
+  std::vector< int16_t > power_L;                   /**< power per phase, import = +ve (W) */
+  std::vector< float > Vrms_L;                      /**< RMS voltage per phase (V) */
+  std::vector< float > temperature;                 /**< temperature per sensor (°C) */
+  std::vector< int16_t > temperature_x100;          /**< raw temperature per sensor, with the error values */
+  float frequency{ 0 };                             /**< mains frequency (Hz) */
+  std::vector< float > loadDutyInPercent;           /**< share of the period each load was ON */
+  int16_t relayAverage{ 0 };                        /**< average power seen by the relays (W) */
+  std::vector< bool > relayON;                      /**< state of each relay */
+  uint16_t absenceOfDivertedEnergyCount{ 0 };       /**< number of seconds without diverted energy */
+  uint16_t sampleSets{ 0 };                         /**< sample sets during the period */
+  uint8_t lowestNoOfSampleSetsPerMainsCycle{ 0 };   /**< integrity check */
+};
+
+/** @brief Outcome of the decoding of a frame */
+enum class Status : uint8_t
+{
+  OK,         /**< valid frame */
+  BAD_COBS,   /**< invalid COBS encoding */
+  BAD_CRC,    /**< CRC mismatch */
+  BAD_LENGTH, /**< size not matching the dimensions of the header */
+  BAD_VERSION /**< unknown layout */
+};
+
+/**
+ * @brief Decodes a COBS-encoded buffer, without its delimiter
+ *
+ * @param in The encoded buffer
+ * @param size Its size
+ * @param out The decoded bytes
+ * @return false if the encoding is invalid
+ */
+bool cobsDecode(const uint8_t* in, size_t size, std::vector< uint8_t >& out);
+
+/**
+ * @brief Decodes a frame, without its delimiter
+ *
+ * @param in The COBS-encoded frame
+ * @param size Its size
+ * @param telemetry The content of the frame
+ * @return The outcome of the decoding, 'telemetry' being only valid with Status::OK
+ */
+Status decodeFrame(const uint8_t* in, size_t size, Telemetry& telemetry);
+
+/**
+ * @brief Decoder of a stream of bytes
+ *
+ */
+class StreamDecoder
+{
+public:
+  /**
+   * @brief Adds a byte of the stream.
+   *
+   * @param byte The byte
+   * @param telemetry The content of the frame ended by this byte, if any
+   * @return true when a valid frame has been decoded
+   */
+  bool feed(uint8_t byte, Telemetry& telemetry);
+
+  uint32_t getFrames() const { return frames; }         /**< number of valid frames */
+  uint32_t getErrors() const { return errors; }         /**< number of invalid frames */
+  uint32_t getLostFrames() const { return lostFrames; } /**< number of frames missing from the sequence */
+
+private:
+  std::vector< uint8_t > pending; /**< bytes since the last delimiter */
+  bool firstFrame{ true };        /**< no sequence number received yet */
+  uint8_t lastSequence{ 0 };      /**< sequence number of the last valid frame */
+  uint32_t frames{ 0 };           /**< number of valid frames */
+  uint32_t errors{ 0 };           /**< number of invalid frames */
+  uint32_t lostFrames{ 0 };       /**< number of frames missing from the sequence */
+};
+}  // namespace TelemetryDecoder
+
+#endif /* TELEMETRY_DECODER_H */
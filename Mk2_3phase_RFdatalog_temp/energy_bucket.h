@@ -0,0 +1,223 @@
+/**
+ * @file energy_bucket.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Arithmetic of the main energy bucket, floating-point or fixed-point (Q-format)
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details By default, the energy bucket is a float in Joules * SUPPLY_FREQUENCY.
+ *          When ENERGY_BUCKET_FIXED_POINT is defined (see config.h), it becomes an int32_t
+ *          with ENERGY_FRACTION_BITS fractional bits, so that the ISR does not use any
+ *          soft-float operation:
+ *          - the division by the number of sample sets uses a table of reciprocals,
+ *          - the power calibration is scaled at compile time.
+ *
+ *          Both implementations are always available so that they can be compared.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ENERGY_BUCKET_H
+#define ENERGY_BUCKET_H
+
+#include "adc_timing.h"
+#include "calibration.h"
+
+inline constexpr uint8_t AVG_POWER_FRACTION_BITS{ 4 }; /**< fractional bits of the average power over a mains cycle */
+
+// The reciprocals 2^(16 + AVG_POWER_FRACTION_BITS) / n must fit in 16 bits, hence n >= 17.
+// The table covers mains periods from 1/94 s to 3/100 s, whatever the sampling rate (see adc_timing.h):
+// 17..48 sample sets per mains cycle for 3 phases with the default free-running ADC.
+// Outside this range (start-up, missing mains), a normal division is used.
+inline constexpr uint8_t MIN_SAMPLES_FOR_RECIPROCAL{ ADC_SAMPLE_SETS_PER_SECOND / 94 > 17 ? ADC_SAMPLE_SETS_PER_SECOND / 94 : 17 };                        /**< lowest number of sample sets per mains cycle using the table */
+inline constexpr uint8_t MAX_SAMPLES_FOR_RECIPROCAL{ ADC_SAMPLE_SETS_PER_SECOND * 3UL / 100 < 254 ? ADC_SAMPLE_SETS_PER_SECOND * 3UL / 100 : 254 }; /**< highest number of sample sets per mains cycle using the table */
+
+static_assert(MAX_SAMPLES_FOR_RECIPROCAL > MIN_SAMPLES_FOR_RECIPROCAL, "******** The sampling rate is too low ! ********");
+
+/**
+ * @brief Table of uint16_t values
+ *
+ * @tparam N Number of values
+ */
+template< uint8_t N >
+struct Table16
+{
+  uint16_t value[N];
+};
+
+/**
+ * @brief Computes the reciprocals 2^(16 + AVG_POWER_FRACTION_BITS) / n at compile time, rounded
+ *
+ * @return The reciprocals for n in [MIN_SAMPLES_FOR_RECIPROCAL..MAX_SAMPLES_FOR_RECIPROCAL]
+ */
+constexpr auto initReciprocals()
+{
+  Table16< MAX_SAMPLES_FOR_RECIPROCAL - MIN_SAMPLES_FOR_RECIPROCAL + 1 > table{};
+
+  for (uint8_t n = MIN_SAMPLES_FOR_RECIPROCAL; n <= MAX_SAMPLES_FOR_RECIPROCAL; ++n)
+  {
+    table.value[n - MIN_SAMPLES_FOR_RECIPROCAL] = static_cast< uint16_t >(((1UL << (16 + AVG_POWER_FRACTION_BITS)) + n / 2) / n);
+  }
+  return table;
+}
+
+inline constexpr auto RECIPROCALS{ initReciprocals() }; /**< reciprocals of the number of sample sets per mains cycle */
+
+/**
+ * @brief Finds the largest shift keeping all the scaled power calibrations within 16 bits
+ *
+ * @return The shift
+ */
+constexpr uint8_t initPowerCalShift()
+{
+  float maxPowerCal{ 0 };
+  for (const auto powerCal : f_powerCal)
+  {
+    if (powerCal > maxPowerCal)
+    {
+      maxPowerCal = powerCal;
+    }
+  }
+
+  uint8_t shift{ 16 };
+  while (shift < 30 && maxPowerCal * static_cast< float >(1UL << (shift + 1)) < 65535.5F)
+  {
+    ++shift;
+  }
+  return shift;
+}
+
+inline constexpr uint8_t POWER_CAL_SHIFT{ initPowerCalShift() }; /**< f_powerCal is scaled by 2^POWER_CAL_SHIFT */
+
+/**
+ * @brief Scales the power calibration of each phase at compile time, rounded
+ *
+ * @return The scaled power calibrations
+ */
+constexpr auto initPowerCalQ()
+{
+  Table16< NO_OF_PHASES > table{};
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    table.value[phase] = static_cast< uint16_t >(f_powerCal[phase] * static_cast< float >(1UL << POWER_CAL_SHIFT) + 0.5F);
+  }
+  return table;
+}
+
+inline constexpr auto POWER_CAL_Q{ initPowerCalQ() }; /**< f_powerCal * 2^POWER_CAL_SHIFT */
+
+inline constexpr uint8_t ENERGY_FRACTION_BITS{ AVG_POWER_FRACTION_BITS + POWER_CAL_SHIFT - 16 }; /**< fractional bits of the fixed-point energy bucket */
+
+static_assert(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY * 2.0 * (1UL << ENERGY_FRACTION_BITS) < INT32_MAX, "******** The fixed-point energy bucket would overflow ! ********");
+
+#ifdef ENERGY_BUCKET_FIXED_POINT
+using energy_t = int32_t; /**< energy in Joules * SUPPLY_FREQUENCY * 2^ENERGY_FRACTION_BITS */
+#else
+using energy_t = float; /**< energy in Joules * SUPPLY_FREQUENCY */
+#endif
+
+/**
+ * @brief Converts an energy in Joules * SUPPLY_FREQUENCY to the representation of the energy bucket
+ *
+ * @param value The energy in Joules * SUPPLY_FREQUENCY
+ * @return The energy in the representation of the energy bucket
+ */
+constexpr energy_t toEnergy(const float value)
+{
+#ifdef ENERGY_BUCKET_FIXED_POINT
+  return static_cast< energy_t >(value * static_cast< float >(1UL << ENERGY_FRACTION_BITS) + (value < 0 ? -0.5F : 0.5F));
+#else
+  return value;
+#endif
+}
+
+/**
+ * @brief Converts an energy in the representation of the energy bucket to Joules * SUPPLY_FREQUENCY
+ *
+ * @param value The energy in the representation of the energy bucket
+ * @return The energy in Joules * SUPPLY_FREQUENCY
+ */
+constexpr float energyToFloat(const energy_t value)
+{
+#ifdef ENERGY_BUCKET_FIXED_POINT
+  return static_cast< float >(value) * (1.0F / static_cast< float >(1UL << ENERGY_FRACTION_BITS));
+#else
+  return value;
+#endif
+}
+
+/**
+ * @brief Multiplies a 32-bit signed value by a 16-bit unsigned value, the result being divided by 2^16 (floor)
+ *
+ * @details Two 16x16 multiplications, the 48-bit product is never built.
+ *          The high word of 'a' multiplied by 'b' must fit in 32 bits.
+ *
+ * @param a The 32-bit signed value
+ * @param b The 16-bit unsigned value
+ * @return (a * b) >> 16
+ */
+inline int32_t mulShr16(const int32_t a, const uint16_t b)
+{
+  const auto hi{ static_cast< int16_t >(a >> 16) };
+  const auto lo{ static_cast< uint16_t >(a) };
+
+  return static_cast< int32_t >(hi) * b + static_cast< int32_t >((static_cast< uint32_t >(lo) * b) >> 16);
+}
+
+/**
+ * @brief Energy contribution of a mains cycle, floating-point
+ *
+ * @param phase The phase number [0..NO_OF_PHASES[
+ * @param sumP The sum of the real power samples during the mains cycle
+ * @param samples The number of sample sets during the mains cycle
+ * @return The energy in Joules * SUPPLY_FREQUENCY
+ */
+inline float energyContributionFloat(const uint8_t phase, const int32_t sumP, const uint8_t samples)
+{
+  return (sumP / samples) * f_powerCal[phase];
+}
+
+/**
+ * @brief Energy contribution of a mains cycle, fixed-point
+ *
+ * @param phase The phase number [0..NO_OF_PHASES[
+ * @param sumP The sum of the real power samples during the mains cycle
+ * @param samples The number of sample sets during the mains cycle
+ * @return The energy in Joules * SUPPLY_FREQUENCY * 2^ENERGY_FRACTION_BITS
+ */
+inline int32_t energyContributionFixed(const uint8_t phase, const int32_t sumP, const uint8_t samples)
+{
+  int32_t avgP;  // average power, with AVG_POWER_FRACTION_BITS fractional bits
+
+  if (samples >= MIN_SAMPLES_FOR_RECIPROCAL && samples <= MAX_SAMPLES_FOR_RECIPROCAL)
+  {
+    avgP = mulShr16(sumP, RECIPROCALS.value[samples - MIN_SAMPLES_FOR_RECIPROCAL]);
+  }
+  else
+  {
+    avgP = (sumP * (1L << AVG_POWER_FRACTION_BITS)) / samples;
+  }
+
+  return mulShr16(avgP, POWER_CAL_Q.value[phase]);
+}
+
+/**
+ * @brief Energy contribution of a mains cycle, in the representation of the energy bucket
+ *
+ * @param phase The phase number [0..NO_OF_PHASES[
+ * @param sumP The sum of the real power samples during the mains cycle
+ * @param samples The number of sample sets during the mains cycle
+ * @return The energy in the representation of the energy bucket
+ */
+inline energy_t energyContribution(const uint8_t phase, const int32_t sumP, const uint8_t samples)
+{
+#ifdef ENERGY_BUCKET_FIXED_POINT
+  return energyContributionFixed(phase, sumP, samples);
+#else
+  return energyContributionFloat(phase, sumP, samples);
+#endif
+}
+
+#endif /* ENERGY_BUCKET_H */
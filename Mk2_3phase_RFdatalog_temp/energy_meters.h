@@ -0,0 +1,289 @@
+/**
+ * @file energy_meters.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Cumulative import, export and diverted energy, in Wh
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When ENERGY_METERS is set (see config.h), the main loop adds, at each datalog period, the
+ *          energy imported or exported at the supply point and the energy diverted to each load.
+ *          The diverted energy is estimated from the number of mains cycles each load was ON and its
+ *          rated power (loadRatedPowerInWatts).
+ *
+ *          The energies are added as an exact integer number of Watts * mains cycles, and converted
+ *          to Wh without any rounding error: the remainder (less than 1 Wh) is kept for the next period.
+ *
+ *          The meters are saved periodically in EEPROM (see utils_energy.h) in a ring of records,
+ *          so that each EEPROM cell is only written once every ENERGY_METERS_EEPROM_SLOTS saves.
+ *          At start-up, the valid record with the highest sequence number is restored.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ENERGY_METERS_H
+#define ENERGY_METERS_H
+
+#include <Arduino.h>
+#include <stddef.h>
+
+#include "config.h"
+
+inline constexpr uint8_t ENERGY_METERS_VERSION{ 1 }; /**< layout of the records in EEPROM */
+inline constexpr uint8_t UINT64_MAX_DIGITS{ 20 };    /**< number of digits of the highest 64-bit value */
+
+/**
+ * @brief Cumulative energy, in Wh
+ *
+ */
+class WhMeter
+{
+public:
+  /**
+   * @brief Adds an energy.
+   *
+   * @param wattCycles The energy, in Watts * mains cycles
+   * @param wattCyclesPerWh 3600 * supply frequency
+   */
+  void add(const uint32_t wattCycles, const uint32_t wattCyclesPerWh)
+  {
+    remainder += wattCycles;  // can't overflow, the remainder being lower than 3600 * 60
+
+    if (remainder >= wattCyclesPerWh)
+    {
+      wh += remainder / wattCyclesPerWh;
+      remainder %= wattCyclesPerWh;
+    }
+  }
+
+  /**
+   * @brief Total energy, in Wh.
+   *
+   */
+  uint64_t get() const
+  {
+    return wh;
+  }
+
+  /**
+   * @brief Restores the total energy, the fraction of Wh being lost.
+   *
+   * @param value The energy, in Wh
+   */
+  void set(const uint64_t value)
+  {
+    wh = value;
+    remainder = 0;
+  }
+
+private:
+  uint64_t wh{ 0 };        /**< energy, in Wh */
+  uint32_t remainder{ 0 }; /**< fraction of Wh, in Watts * mains cycles */
+};
+
+/**
+ * @brief Energy meters as stored in EEPROM
+ *
+ * @note The 64-bit values come first, so that there's no padding before the checksum on any platform.
+ */
+struct EnergyRecord
+{
+  uint64_t importWh{ 0 };                   /**< energy imported from the grid */
+  uint64_t exportWh{ 0 };                   /**< energy exported to the grid */
+  uint64_t divertedWh[NO_OF_DUMPLOADS]{};   /**< energy diverted to each load */
+  uint32_t sequence{ 0 };                   /**< incremented at each save, the highest one is the latest record */
+  uint8_t version{ ENERGY_METERS_VERSION }; /**< layout of the record */
+  uint8_t noOfDumpLoads{ NO_OF_DUMPLOADS }; /**< number of diverted energies */
+  uint8_t checksum{ 0 };                    /**< see energyRecordChecksum() */
+};
+
+/**
+ * @brief Checksum of a record, all bytes but the checksum itself
+ *
+ * @param record The record
+ * @return The checksum
+ */
+inline uint8_t energyRecordChecksum(const EnergyRecord &record)
+{
+  const auto *bytes{ reinterpret_cast< const uint8_t * >(&record) };
+  uint8_t sum{ 0xA5 };
+
+  for (uint8_t i = 0; i < offsetof(EnergyRecord, checksum); ++i)
+  {
+    sum = static_cast< uint8_t >((sum << 1) | (sum >> 7)) ^ bytes[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief Whether a record has been written by this build
+ *
+ * @param record The record
+ * @return true if the record can be restored
+ */
+inline bool isEnergyRecordValid(const EnergyRecord &record)
+{
+  return record.version == ENERGY_METERS_VERSION
+         && record.noOfDumpLoads == NO_OF_DUMPLOADS
+         && record.checksum == energyRecordChecksum(record);
+}
+
+/**
+ * @brief Finds the latest valid record of a ring
+ *
+ * @tparam Read Callable reading the record of a slot, as in 'void read(uint8_t slot, EnergyRecord &record)'
+ * @param read Reads a slot
+ * @param noOfSlots Number of slots of the ring
+ * @param latest The latest valid record, left unchanged if there's none
+ * @return The slot of the latest record, 'noOfSlots' if there's none
+ */
+template< typename Read >
+uint8_t findLatestEnergyRecord(Read read, const uint8_t noOfSlots, EnergyRecord &latest)
+{
+  uint8_t latestSlot{ noOfSlots };
+  EnergyRecord record;
+
+  for (uint8_t slot = 0; slot < noOfSlots; ++slot)
+  {
+    read(slot, record);
+
+    if (isEnergyRecordValid(record)
+        && (latestSlot == noOfSlots || record.sequence > latest.sequence))
+    {
+      latest = record;
+      latestSlot = slot;
+    }
+  }
+  return latestSlot;
+}
+
+/**
+ * @brief Import, export and diverted energy meters
+ *
+ */
+class EnergyMeters
+{
+public:
+  /**
+   * @brief Adds the energies of a datalog period.
+   *
+   * @param power Mean power at the supply point (+ve = import), in W
+   * @param countLoadON Number of mains cycles each load was ON
+   * @param periodInMainsCycles Length of the period, in mains cycles
+   * @param supplyFrequency Frequency of the mains, in Hz
+   */
+  void update(const int16_t power, const uint16_t (&countLoadON)[NO_OF_DUMPLOADS], const uint16_t periodInMainsCycles, const uint8_t supplyFrequency)
+  {
+    const uint32_t wattCyclesPerWh{ static_cast< uint32_t >(3600U) * supplyFrequency };
+    const uint32_t gridWattCycles{ static_cast< uint32_t >(power < 0 ? -static_cast< int32_t >(power) : power) * periodInMainsCycles };
+
+    if (power > 0)
+    {
+      importMeter.add(gridWattCycles, wattCyclesPerWh);
+    }
+    else
+    {
+      exportMeter.add(gridWattCycles, wattCyclesPerWh);
+    }
+
+    for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+    {
+      divertedMeter[i].add(static_cast< uint32_t >(loadRatedPowerInWatts[i]) * countLoadON[i], wattCyclesPerWh);
+    }
+  }
+
+  /**
+   * @brief Energy imported from the grid, in Wh.
+   *
+   */
+  uint64_t getImport() const
+  {
+    return importMeter.get();
+  }
+
+  /**
+   * @brief Energy exported to the grid, in Wh.
+   *
+   */
+  uint64_t getExport() const
+  {
+    return exportMeter.get();
+  }
+
+  /**
+   * @brief Energy diverted to a load, in Wh.
+   *
+   * @param load The load [0..NO_OF_DUMPLOADS[
+   */
+  uint64_t getDiverted(const uint8_t load) const
+  {
+    return divertedMeter[load].get();
+  }
+
+  /**
+   * @brief Builds the record to save.
+   *
+   * @param sequence Sequence number of the record
+   * @return The record, with its checksum
+   */
+  EnergyRecord toRecord(const uint32_t sequence) const
+  {
+    EnergyRecord record;
+
+    record.importWh = importMeter.get();
+    record.exportWh = exportMeter.get();
+    for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+    {
+      record.divertedWh[i] = divertedMeter[i].get();
+    }
+    record.sequence = sequence;
+    record.checksum = energyRecordChecksum(record);
+
+    return record;
+  }
+
+  /**
+   * @brief Restores the meters from a record.
+   *
+   * @param record A valid record
+   */
+  void restore(const EnergyRecord &record)
+  {
+    importMeter.set(record.importWh);
+    exportMeter.set(record.exportWh);
+    for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+    {
+      divertedMeter[i].set(record.divertedWh[i]);
+    }
+  }
+
+private:
+  WhMeter importMeter;                    /**< energy imported from the grid */
+  WhMeter exportMeter;                    /**< energy exported to the grid */
+  WhMeter divertedMeter[NO_OF_DUMPLOADS]; /**< energy diverted to each load */
+};
+
+inline EnergyMeters energyMeters; /**< cumulative energies, updated by the main loop */
+
+/**
+ * @brief Converts a 64-bit value to decimal, neither Serial.print() nor itoa() handle it
+ *
+ * @param value The value
+ * @param buffer The buffer, filled from its end
+ * @return The first digit, the string being null-terminated
+ */
+inline const char *uint64ToDecimal(uint64_t value, char (&buffer)[UINT64_MAX_DIGITS + 1])
+{
+  char *p{ buffer + UINT64_MAX_DIGITS };
+  *p = '\0';
+
+  do
+  {
+    *--p = static_cast< char >('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  return p;
+}
+
+#endif /* ENERGY_METERS_H */
@@ -0,0 +1,33 @@
+/**
+ * @file hal.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Thin hardware abstraction layer used by the processing engine
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The processing engine only needs three things from the hardware:
+ *          - an ADC source: read the last conversion, select the channel of a next one,
+ *          - a pin sink: switch the load outputs ON/OFF,
+ *          - a clock: milliseconds since start-up.
+ *
+ *          On AVR, these are always-inlined register accesses and compile to exactly
+ *          the same code as before. On the host ('env:native'), they are backed by plain
+ *          variables so that the real processing functions can be fed with synthetic or
+ *          recorded samples at full host speed.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+#ifdef ARDUINO
+#include "hal_avr.h"
+#else
+#include "hal_native.h"
+#endif
+
+#endif /* HAL_H */
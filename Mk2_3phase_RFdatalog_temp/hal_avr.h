@@ -0,0 +1,225 @@
+/**
+ * @file hal_avr.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief AVR backend of the hardware abstraction layer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef HAL_AVR_H
+#define HAL_AVR_H
+
+#include <Arduino.h>
+
+#include "adc_timing.h"
+#include "load_ports.h"
+#include "utils_pins.h"
+
+namespace HAL
+{
+#if !defined(__DOXYGEN__)
+inline int16_t readADC() __attribute__((always_inline));
+inline void selectADCChannel(uint8_t channel) __attribute__((always_inline));
+inline bool isConversionPending() __attribute__((always_inline));
+inline void acknowledgeADCTrigger() __attribute__((always_inline));
+inline void writeLoadPorts(PortBits mask, PortBits state) __attribute__((always_inline));
+inline unsigned long millis() __attribute__((always_inline));
+inline uint16_t readCycleCounter() __attribute__((always_inline));
+inline uint16_t readSampleClock() __attribute__((always_inline));
+inline bool isTriggerLate() __attribute__((always_inline));
+#endif
+
+/**
+ * @brief Sets up the ADC in free-running or Timer1-triggered mode (see adc_timing.h) with interrupts enabled.
+ *
+ * @note In Timer1-triggered mode, Timer1 cannot be used for anything else (PWM on pins 9 and 10, ...).
+ *
+ * @ingroup Initialization
+ */
+inline void initADC()
+{
+  // First stop the ADC
+  bit_clear(ADCSRA, ADEN);
+
+  if constexpr (ADC_TIMER_TRIGGERED)
+  {
+    // Timer1 in CTC mode (TOP = OCR1A), no prescaling: a compare match B every ADC_TIMER_PERIOD CPU cycles
+    TCCR1B = 0x00;  // stop Timer1
+    TCCR1A = 0x00;
+    TCNT1 = 0;
+    OCR1A = ADC_TIMER_PERIOD - 1;
+    OCR1B = ADC_TIMER_PERIOD - 1;
+    TIMSK1 = 0x00;       // no interrupt, the flag OCF1B alone triggers the conversion
+    TIFR1 = bit(OCF1B);  // clear any pending flag
+
+    // Trigger source: Timer/Counter1 Compare Match B
+    ADCSRB = bit(ADTS2) | bit(ADTS0);
+  }
+  else
+  {
+    // Activate free-running mode
+    ADCSRB = 0x00;
+  }
+
+  if constexpr (ADC_PRESCALER == 64)
+  {
+    bit_clear(ADCSRA, ADPS0);  // Set the ADC's clock to system clock / 64
+  }
+  else
+  {
+    bit_set(ADCSRA, ADPS0);  // Set the ADC's clock to system clock / 128
+  }
+  bit_set(ADCSRA, ADPS1);
+  bit_set(ADCSRA, ADPS2);
+
+  bit_set(ADCSRA, ADATE);  // set the Auto Trigger Enable bit in the ADCSRA register. The
+  // trigger source is set by the bits ADTS0-2: when they are all zero, the
+  // ADC's trigger source is set to "free running mode".
+
+  bit_set(ADCSRA, ADIE);  // set the ADC interrupt enable bit. When this bit is written
+  // to one and the I-bit in SREG is set, the
+  // ADC Conversion Complete Interrupt is activated.
+
+  bit_set(ADCSRA, ADEN);  // Enable the ADC
+
+  if constexpr (ADC_TIMER_TRIGGERED)
+  {
+    TCCR1B = bit(WGM12) | bit(CS10);  // start Timer1, the first conversion starts at the first compare match
+  }
+  else
+  {
+    bit_set(ADCSRA, ADSC);  // start ADC manually first time
+  }
+}
+
+/**
+ * @brief Returns the result of the conversion which has just finished.
+ *
+ * @ingroup TimeCritical
+ */
+inline int16_t readADC()
+{
+  return ADC;
+}
+
+/**
+ * @brief Selects the analog input for the next conversion to be started.
+ *
+ * @param channel The analog input [0..7]
+ *
+ * @ingroup TimeCritical
+ */
+inline void selectADCChannel(const uint8_t channel)
+{
+  ADMUX = bit(REFS0) + channel;
+}
+
+/**
+ * @brief Whether a conversion has completed and not been handled yet (ADIF).
+ *
+ * @details ADIF is cleared by the hardware when ISR(ADC_vect) is entered.
+ *
+ * @ingroup TimeCritical
+ */
+inline bool isConversionPending()
+{
+  return bit_is_set(ADCSRA, ADIF);
+}
+
+/**
+ * @brief Re-arms the trigger of the ADC in Timer1-triggered mode.
+ *
+ * @details A conversion is triggered by the rising edge of OCF1B. As no Timer1 interrupt
+ *          is used, the flag must be cleared for the next compare match to start a conversion.
+ *          It must be cleared after the channel of the next conversion has been selected: a compare
+ *          match in between would convert the previous channel.
+ *          Nothing to do in free-running mode.
+ *
+ * @ingroup TimeCritical
+ */
+inline void acknowledgeADCTrigger()
+{
+  if constexpr (ADC_TIMER_TRIGGERED)
+  {
+    TIFR1 = bit(OCF1B);
+  }
+}
+
+/**
+ * @brief Sets the given pins of PORTD and PORTB to the given state, with a single write per port.
+ *
+ * @param mask Bits of the pins to update
+ * @param state New state of these pins, a bit outside of mask is switched ON
+ *
+ * @ingroup TimeCritical
+ */
+inline void writeLoadPorts(const PortBits mask, const PortBits state)
+{
+  PORTD = (PORTD & ~mask.portD) | state.portD;
+  PORTB = (PORTB & ~mask.portB) | state.portB;
+}
+
+/**
+ * @brief Milliseconds since start-up.
+ *
+ */
+inline unsigned long millis()
+{
+  return ::millis();
+}
+
+/**
+ * @brief Sets up Timer1 as a free-running counter at the CPU clock, for timing measurements.
+ *
+ * @note Timer1 cannot be used for anything else (PWM on pins 9 and 10, ...).
+ *
+ * @ingroup Initialization
+ */
+inline void initCycleCounter()
+{
+  TCCR1A = 0x00;       // normal mode, no output compare
+  TCCR1B = bit(CS10);  // no prescaling
+  TIMSK1 = 0x00;       // no interrupt
+}
+
+/**
+ * @brief Returns the free-running counter, 1 tick per CPU cycle.
+ *
+ * @ingroup TimeCritical
+ */
+inline uint16_t readCycleCounter()
+{
+  return TCNT1;
+}
+
+/**
+ * @brief Returns the clock used to detect the missed conversions in free-running mode, 1 tick per CPU cycle.
+ *
+ * @details Timer1 running freely (see initCycleCounter()).
+ *
+ * @ingroup TimeCritical
+ */
+inline uint16_t readSampleClock()
+{
+  return TCNT1;
+}
+
+/**
+ * @brief Whether the trigger is re-armed too late for the next compare match, in Timer1-triggered mode.
+ *
+ * @details The conversion being handled started at the compare match, when TCNT1 wrapped to 0,
+ *          and lasted ADC_TRIGGERED_CONVERSION_CYCLES. If TCNT1 is below that, it has wrapped again:
+ *          the next compare match has happened while OCF1B was still set, and no conversion has started.
+ *
+ * @ingroup TimeCritical
+ */
+inline bool isTriggerLate()
+{
+  return TCNT1 < ADC_TRIGGERED_CONVERSION_CYCLES;
+}
+}
+
+#endif /* HAL_AVR_H */
@@ -0,0 +1,153 @@
+/**
+ * @file hal_native.cpp
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native (host) backend of the hardware abstraction layer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ARDUINO
+
+#include "hal.h"
+
+HardwareSerial Serial;
+
+unsigned long millis()
+{
+  return static_cast< unsigned long >(HAL::Native::clockInMicroseconds / 1000U);
+}
+
+unsigned long micros()
+{
+  return static_cast< unsigned long >(HAL::Native::clockInMicroseconds);
+}
+
+void delay(const unsigned long ms)
+{
+  HAL::Native::advanceClock(ms * 1000U);
+}
+
+namespace HAL
+{
+namespace Native
+{
+namespace
+{
+ADCSource adcSource{ nullptr };
+
+/**
+ * @brief Advances the emulated clock by one sample period.
+ *
+ */
+void advanceOnePeriod()
+{
+  const uint32_t cycles{ static_cast< uint32_t >(clockRemainderInCycles) + ADC_SAMPLE_PERIOD_CYCLES };
+  clockInMicroseconds += cycles / (F_CPU / 1000000UL);
+  clockRemainderInCycles = cycles % (F_CPU / 1000000UL);
+}
+}
+
+/**
+ * @brief Sets the function which provides the raw samples of the emulated ADC.
+ *
+ * @param source The sample source
+ */
+void setADCSource(const ADCSource source)
+{
+  adcSource = source;
+}
+
+/**
+ * @brief Emulates the given number of conversions.
+ *
+ * @details For each conversion, the result is read from the sample source for the channel
+ *          latched when that conversion started, and the ISR is run. The next conversion is
+ *          started with the currently selected channel before the ISR in free-running mode,
+ *          after it in Timer1-triggered mode. The clock then advances by one sample period.
+ *
+ *          When HAL::Native::dropConversion is set, one conversion is lost, as on the ATmega328P:
+ *          - in free-running mode, the ISR is held off during a whole conversion, whose result is
+ *            overwritten by the next one, the channels of the sequence shifting by one step,
+ *          - in Timer1-triggered mode, the ISR re-arms the trigger after the next compare match
+ *            (HAL::isTriggerLate()), so the next slot has no conversion.
+ *
+ * @param count Number of conversions
+ */
+void runADCConversions(uint32_t count)
+{
+  if (!adcRunning || !adcSource)
+  {
+    return;
+  }
+
+  while (count--)
+  {
+    if constexpr (!ADC_TIMER_TRIGGERED)
+    {
+      if (dropConversion)
+      {
+        adcChannelConverting = adcChannelSelected;  // the conversion after the lost one, with the same channel
+        advanceOnePeriod();
+        dropConversion = false;
+      }
+    }
+
+    const auto channelDone{ adcChannelConverting };
+
+    if constexpr (!ADC_TIMER_TRIGGERED)
+    {
+      adcChannelConverting = adcChannelSelected;  // in free-running mode, the next conversion is already under way
+    }
+    adcResult = adcSource(channelDone);
+
+    ADC_vect_isr();
+
+    if constexpr (ADC_TIMER_TRIGGERED)
+    {
+      adcChannelConverting = adcChannelSelected;  // the next conversion starts at the next compare match
+
+      if (dropConversion)
+      {
+        advanceOnePeriod();  // slot without conversion
+        dropConversion = false;
+      }
+    }
+
+    advanceOnePeriod();
+  }
+}
+
+/**
+ * @brief Advances the emulated clock.
+ *
+ * @param microseconds Elapsed time
+ */
+void advanceClock(const uint32_t microseconds)
+{
+  clockInMicroseconds += microseconds;
+}
+
+/**
+ * @brief Brings the emulated hardware back to its power-on state.
+ *
+ */
+void reset()
+{
+  adcChannelSelected = 0;
+  adcChannelConverting = 0;
+  adcResult = 0;
+  adcRunning = false;
+  adcFlag = false;
+  dropConversion = false;
+  pinsState = 0;
+  pinsWriteCount = 0;
+  clockInMicroseconds = 0;
+  clockRemainderInCycles = 0;
+}
+}
+}
+
+#endif  // ARDUINO
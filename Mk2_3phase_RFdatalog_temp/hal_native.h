@@ -0,0 +1,163 @@
+/**
+ * @file hal_native.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native (host) backend of the hardware abstraction layer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The ADC is emulated in free-running mode: the channel selected by the ISR
+ *          is latched when the next-but-one conversion starts, exactly as on the ATmega328P.
+ *          In Timer1-triggered mode (see adc_timing.h), it is latched when the next conversion starts.
+ *          Samples are pulled from a user-supplied source, and the clock advances by one
+ *          sample period for each emulated conversion.
+ *
+ *          For the fastest possible replay, the processing functions can also be called
+ *          directly, in which case the clock must be advanced with HAL::Native::advanceClock().
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <Arduino.h>
+
+#include "adc_timing.h"
+#include "load_ports.h"
+
+void ADC_vect_isr(); /**< body of ISR(ADC_vect) in the native build */
+
+namespace HAL
+{
+namespace Native
+{
+using ADCSource = int16_t (*)(uint8_t channel); /**< returns the raw value [0..1023] for the given channel at the current time */
+
+inline uint8_t adcChannelSelected{ 0 };      /**< equivalent of the MUX bits of ADMUX */
+inline uint8_t adcChannelConverting{ 0 };    /**< channel of the conversion under way */
+inline int16_t adcResult{ 0 };               /**< equivalent of ADC */
+inline bool adcRunning{ false };             /**< set by HAL::initADC() */
+inline bool adcFlag{ false };                /**< equivalent of ADIF, never set by the emulation, to be set by the tests */
+inline bool dropConversion{ false };         /**< set by the tests: the ISR is held off long enough for the next conversion to be lost */
+inline uint16_t pinsState{ 0 };              /**< current state of the load pins */
+inline uint32_t pinsWriteCount{ 0 };         /**< number of calls to HAL::writeLoadPorts() */
+inline uint64_t clockInMicroseconds{ 0 };    /**< emulated time since start-up */
+inline uint8_t clockRemainderInCycles{ 0 };  /**< CPU cycles of the sample periods not accounted for in clockInMicroseconds yet */
+
+void setADCSource(ADCSource source);
+void runADCConversions(uint32_t count);
+void advanceClock(uint32_t microseconds);
+void reset();
+}
+
+/**
+ * @brief Sets up the emulated ADC in free-running or Timer1-triggered mode.
+ *
+ */
+inline void initADC()
+{
+  Native::adcChannelSelected = 0;
+  Native::adcChannelConverting = 0;
+  Native::adcRunning = true;
+}
+
+/**
+ * @brief Returns the result of the conversion which has just finished.
+ *
+ */
+inline int16_t readADC()
+{
+  return Native::adcResult;
+}
+
+/**
+ * @brief Selects the analog input for the next conversion to be started.
+ *
+ * @param channel The analog input [0..7]
+ */
+inline void selectADCChannel(const uint8_t channel)
+{
+  Native::adcChannelSelected = channel;
+}
+
+/**
+ * @brief Whether a conversion has completed and not been handled yet.
+ *
+ * @details The emulated ISR is never late, unless a test sets HAL::Native::adcFlag.
+ */
+inline bool isConversionPending()
+{
+  return Native::adcFlag;
+}
+
+/**
+ * @brief Nothing to re-arm, the emulated trigger is the loop of HAL::Native::runADCConversions().
+ *
+ */
+inline void acknowledgeADCTrigger()
+{
+}
+
+/**
+ * @brief Sets the given pins to the given state, with a single write per port.
+ *
+ * @param mask Bits of the pins to update
+ * @param state New state of these pins, a bit outside of mask is switched ON
+ */
+inline void writeLoadPorts(const PortBits mask, const PortBits state)
+{
+  const uint16_t mask16{ static_cast< uint16_t >(mask.portD | (mask.portB << 8)) };
+  const uint16_t state16{ static_cast< uint16_t >(state.portD | (state.portB << 8)) };
+
+  Native::pinsState = (Native::pinsState & ~mask16) | state16;
+  ++Native::pinsWriteCount;
+}
+
+/**
+ * @brief Milliseconds since start-up (emulated).
+ *
+ */
+inline unsigned long millis()
+{
+  return ::millis();
+}
+
+/**
+ * @brief Nothing to set up, the host clock is used.
+ *
+ */
+inline void initCycleCounter()
+{
+}
+
+/**
+ * @brief Returns a free-running counter with the tick of Timer1 (1 / F_CPU), based on the host clock.
+ *
+ */
+inline uint16_t readCycleCounter()
+{
+  const auto now{ std::chrono::steady_clock::now().time_since_epoch() };
+  return static_cast< uint16_t >(std::chrono::duration_cast< std::chrono::nanoseconds >(now).count() * (F_CPU / 1000000UL) / 1000);
+}
+
+/**
+ * @brief Returns the emulated clock, in CPU cycles, as Timer1 running freely.
+ *
+ */
+inline uint16_t readSampleClock()
+{
+  return static_cast< uint16_t >(Native::clockInMicroseconds * (F_CPU / 1000000UL) + Native::clockRemainderInCycles);
+}
+
+/**
+ * @brief Whether the trigger is re-armed too late, set through HAL::Native::dropConversion.
+ *
+ */
+inline bool isTriggerLate()
+{
+  return Native::dropConversion;
+}
+}
+
+#endif /* HAL_NATIVE_H */
@@ -0,0 +1,162 @@
+/**
+ * @file isr_timing.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Optional execution time measurement of the ISR and of its heavy branches
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When ISR_TIMING_INSTRUMENTATION is set (see config.h), Timer1 runs freely at the
+ *          CPU clock (62.5 ns per tick @ 16 MHz). The entry and exit of each timed section
+ *          are timestamped, and for each section the min, the max and a histogram of the
+ *          execution times are kept over each datalogging period.
+ *
+ *          The time spent by the CPU to enter the ISR (~3 µs including the prologue) is not
+ *          measured, only the body of the ISR is.
+ *
+ *          When disabled, everything compiles to nothing.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ISR_TIMING_H
+#define ISR_TIMING_H
+
+#include <Arduino.h>
+
+#include "adc_timing.h"
+#include "config.h"
+#include "hal.h"
+
+/**
+ * @brief Timed sections of the processing engine
+ *
+ */
+enum class TimedSections : uint8_t
+{
+  ISR,             /**< whole body of ISR(ADC_vect) */
+  PLUS_HALF_CYCLE, /**< processPlusHalfCycle() */
+  START_NEW_CYCLE, /**< processStartNewCycle() */
+  DATALOGGING,     /**< processDataLogging(), only at the end of each datalogging period */
+};
+
+inline constexpr uint8_t NO_OF_TIMED_SECTIONS{ 4 };    /**< number of timed sections */
+inline constexpr uint8_t NO_OF_TIMING_BUCKETS{ 8 };    /**< number of buckets of the histograms */
+inline constexpr uint8_t TIMING_BUCKET_WIDTH_US{ 16 }; /**< width of each bucket (the last one is open) */
+
+inline constexpr uint8_t TIMER1_TICKS_PER_US{ F_CPU / 1000000UL }; /**< Timer1 runs at the CPU clock */
+
+static_assert(TIMING_BUCKET_WIDTH_US * TIMER1_TICKS_PER_US == 256, "******** The bucket of a duration must be its high byte ! ********");
+
+// ~96000 runs of the ISR in 5 s with ADC_PRESCALER_64: the buckets are 32-bit,
+// and the histogram in ‰ (count x 1000) must not overflow either
+static_assert(F_CPU / ADC_SAMPLE_PERIOD_CYCLES * DATALOG_PERIOD_IN_SECONDS * 1000ULL <= UINT32_MAX, "******** Too many runs of the ISR per datalog period for the timing histogram ! ********");
+
+/**
+ * @brief Min, max and histogram of the execution times of a section
+ *
+ */
+class TimingStats
+{
+public:
+  /**
+   * @brief Records an execution time.
+   *
+   * @param ticks Execution time in Timer1 ticks
+   *
+   * @ingroup TimeCritical
+   */
+  void record(const uint16_t ticks)
+  {
+    if (ticks < minTicks)
+    {
+      minTicks = ticks;
+    }
+    if (ticks > maxTicks)
+    {
+      maxTicks = ticks;
+    }
+
+    uint8_t bucket{ static_cast< uint8_t >(ticks >> 8) };  // 16 µs per bucket
+    if (bucket >= NO_OF_TIMING_BUCKETS)
+    {
+      bucket = NO_OF_TIMING_BUCKETS - 1;
+    }
+
+    ++histogram[bucket];
+  }
+
+  /**
+   * @brief Copies the statistics for the main code, then resets them for the next period.
+   *
+   * @param copy The copy read by the main code
+   *
+   * @ingroup TimeCritical
+   */
+  void copyAndReset(volatile TimingStats& copy)
+  {
+    copy.minTicks = minTicks;
+    copy.maxTicks = maxTicks;
+    minTicks = UINT16_MAX;
+    maxTicks = 0;
+
+    uint8_t i{ NO_OF_TIMING_BUCKETS };
+    do
+    {
+      --i;
+      copy.histogram[i] = histogram[i];
+      histogram[i] = 0;
+    } while (i);
+  }
+
+  uint16_t minTicks{ UINT16_MAX };            /**< shortest execution time */
+  uint16_t maxTicks{ 0 };                     /**< longest execution time */
+  uint32_t histogram[NO_OF_TIMING_BUCKETS]{}; /**< number of executions in each bucket */
+};
+
+inline TimingStats isrTiming[NO_OF_TIMED_SECTIONS]; /**< execution times during the current datalogging period */
+
+/**
+ * @brief Measures the execution time of the enclosing scope, when the instrumentation is enabled
+ *
+ * @tparam section The timed section
+ */
+template< TimedSections section >
+class ScopedTiming
+{
+public:
+  ScopedTiming()
+  {
+    if constexpr (ISR_TIMING_INSTRUMENTATION)
+    {
+      start = HAL::readCycleCounter();
+    }
+  }
+
+  ~ScopedTiming()
+  {
+    if constexpr (ISR_TIMING_INSTRUMENTATION)
+    {
+      isrTiming[static_cast< uint8_t >(section)].record(HAL::readCycleCounter() - start);
+    }
+  }
+
+  ScopedTiming(const ScopedTiming&) = delete;
+  ScopedTiming& operator=(const ScopedTiming&) = delete;
+
+private:
+  uint16_t start{ 0 }; /**< Timer1 at the entry of the section */
+};
+
+/**
+ * @brief Converts Timer1 ticks to micro-seconds
+ *
+ * @param ticks The number of ticks
+ * @return The number of micro-seconds
+ */
+constexpr uint16_t ticksToMicroseconds(const uint16_t ticks)
+{
+  return ticks / TIMER1_TICKS_PER_US;
+}
+
+#endif /* ISR_TIMING_H */
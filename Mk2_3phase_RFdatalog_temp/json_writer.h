@@ -0,0 +1,157 @@
+/**
+ * @file json_writer.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Streaming writer of the JSON telemetry
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The members are written to the output as they are added: no document is built in RAM,
+ *          and the keys are flash strings, their index being printed after them (e.g. "T" and 2 give "T2").
+ *
+ *          The output is the same as the one of ArduinoJson 6 for the values sent by the router:
+ *          - integers are written as is,
+ *          - the values in 100th (frequency, current, power factor, temperature) are written with up to
+ *            2 decimals, without trailing zeros ("50", "50.1", "50.02"), as ArduinoJson writes the
+ *            corresponding float. For some magnitudes between 64 and 100, ArduinoJson showed the
+ *            rounding error of the float ("64.43999" for 64.44): the exact value is written instead,
+ *          - texts are quoted, without escaping,
+ *          - raw values (e.g. the digits of a 64-bit value) are written without quotes.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Writes a JSON object member by member
+ *
+ */
+class JsonWriter
+{
+public:
+  /**
+   * @brief Opens the object.
+   *
+   * @param out The output, e.g. telemetryPort()
+   */
+  explicit JsonWriter(Print& out)
+    : output{ out }
+  {
+    output.write('{');
+  }
+
+  /**
+   * @brief Closes the object.
+   *
+   */
+  void end()
+  {
+    output.write('}');
+  }
+
+  /**
+   * @brief Adds an integer.
+   *
+   * @param key The key
+   * @param value The value
+   * @param index The index appended to the key, if not 0
+   */
+  void add(const __FlashStringHelper* key, const int32_t value, const uint8_t index = 0)
+  {
+    writeKey(key, index);
+    output.print(static_cast< long >(value));
+  }
+
+  /**
+   * @brief Adds a value given in 100th, written with up to 2 decimals.
+   *
+   * @param key The key
+   * @param value_x100 The value, in 100th
+   * @param index The index appended to the key, if not 0
+   */
+  void addHundredths(const __FlashStringHelper* key, const int32_t value_x100, const uint8_t index = 0)
+  {
+    writeKey(key, index);
+
+    const uint32_t n{ value_x100 < 0 ? 0 - static_cast< uint32_t >(value_x100) : static_cast< uint32_t >(value_x100) };
+    const uint8_t hundredths{ static_cast< uint8_t >(n % 100) };
+
+    if (value_x100 < 0)
+    {
+      output.write('-');
+    }
+    output.print(static_cast< unsigned long >(n / 100));
+
+    if (hundredths)
+    {
+      output.write('.');
+      output.write(static_cast< uint8_t >('0' + hundredths / 10));
+      if (hundredths % 10)
+      {
+        output.write(static_cast< uint8_t >('0' + hundredths % 10));
+      }
+    }
+  }
+
+  /**
+   * @brief Adds a text.
+   *
+   * @param key The key
+   * @param value The text, without any character to escape
+   * @param index The index appended to the key, if not 0
+   */
+  void addText(const __FlashStringHelper* key, const char* value, const uint8_t index = 0)
+  {
+    writeKey(key, index);
+    output.write('"');
+    output.print(value);
+    output.write('"');
+  }
+
+  /**
+   * @brief Adds a value already formatted, written without quotes.
+   *
+   * @param key The key
+   * @param value The value, e.g. the digits of a 64-bit value converted with uint64ToDecimal()
+   * @param index The index appended to the key, if not 0
+   */
+  void addRaw(const __FlashStringHelper* key, const char* value, const uint8_t index = 0)
+  {
+    writeKey(key, index);
+    output.print(value);
+  }
+
+private:
+  /**
+   * @brief Writes the separator and the key of a member.
+   *
+   * @param key The key
+   * @param index The index appended to the key, if not 0
+   */
+  void writeKey(const __FlashStringHelper* key, const uint8_t index)
+  {
+    if (!first)
+    {
+      output.write(',');
+    }
+    first = false;
+
+    output.write('"');
+    output.print(key);
+    if (index)
+    {
+      output.print(index);
+    }
+    output.write('"');
+    output.write(':');
+  }
+
+  Print& output;      /**< where the object is written */
+  bool first{ true }; /**< no member written yet */
+};
+
+#endif /* JSON_WRITER_H */
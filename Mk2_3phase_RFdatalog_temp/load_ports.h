@@ -0,0 +1,87 @@
+/**
+ * @file load_ports.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Compile-time mapping of the load pins to the bits of PORTD and PORTB
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The bit of each load in its port is computed once at compile time from physicalLoadPin,
+ *          so that the ISR only ORs constant bytes together (no variable shift, which is a loop on AVR),
+ *          and writes each port once with a single masked assignment: all the loads sharing a port
+ *          switch at the very same instruction.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef LOAD_PORTS_H
+#define LOAD_PORTS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief A bitmask, split per port
+ *
+ */
+struct PortBits
+{
+  uint8_t portD{ 0 }; /**< bits of PORTD, pins [0..7] */
+  uint8_t portB{ 0 }; /**< bits of PORTB, pins [8..13] */
+};
+
+/**
+ * @brief Bits of each load, and of all the loads, in PORTD and PORTB
+ *
+ * @tparam N Number of loads
+ */
+template< uint8_t N >
+struct LoadPortMasks
+{
+  PortBits load[N]{}; /**< bit of each load */
+  PortBits all{};     /**< bits of all the loads, i.e. the bits written by the ISR */
+};
+
+/**
+ * @brief Splits a bitmask of pins per port
+ *
+ * @param pins Bitmask of the pins [0..13], bit 'n' for pin 'n'
+ * @return The bits in each port
+ */
+constexpr PortBits toPortBits(const uint16_t pins)
+{
+  return { static_cast< uint8_t >(pins & 0xFF), static_cast< uint8_t >((pins >> 8) & 0x3F) };
+}
+
+/**
+ * @brief Whether a pin can drive a load, i.e. is in PORTD or PORTB
+ *
+ * @param pin The pin
+ * @return true if the pin is in [0..13]
+ */
+constexpr bool isLoadPortPin(const uint8_t pin)
+{
+  return pin < 14;
+}
+
+/**
+ * @brief Computes the port bits of each load
+ *
+ * @tparam N Number of loads
+ * @param pins Pin of each load [0..13]
+ * @return The masks
+ */
+template< uint8_t N >
+constexpr LoadPortMasks< N > makeLoadPortMasks(const uint8_t (&pins)[N])
+{
+  LoadPortMasks< N > masks{};
+
+  for (uint8_t i = 0; i < N; ++i)
+  {
+    masks.load[i] = toPortBits(isLoadPortPin(pins[i]) ? static_cast< uint16_t >(1U << pins[i]) : 0);
+    masks.all.portD |= masks.load[i].portD;
+    masks.all.portB |= masks.load[i].portB;
+  }
+  return masks;
+}
+
+#endif /* LOAD_PORTS_H */
@@ -28,13 +28,15 @@ static_assert(__cplusplus >= 201703L, "See also : https://github.com/FredM67/PVR
 
 #include "config.h"
 
-// In this sketch, the ADC is free-running with a cycle time of ~104uS.
+// In this sketch, the ADC is free-running with a cycle time of ~104uS by default (see adc_timing.h).
 
 #include "calibration.h"
 #include "processing.h"
 #include "shared_var.h"
 #include "types.h"
 #include "utils.h"
+#include "utils_energy.h"
+#include "utils_params.h"
 #include "utils_relay.h"
 #include "validation.h"
 #include "main.h"
@@ -324,6 +326,7 @@ bool proceedLoadPriorities(const int16_t &currentTemperature_x100)
  * @details
  * - Delays startup to allow time to open the Serial Monitor.
  * - Initializes the Serial interface and debug port.
+ * - Loads the runtime parameters from EEPROM if enabled.
  * - Displays configuration information.
  * - Initializes all loads to OFF at startup.
  * - Logs load priorities and initializes temperature sensors if present.
@@ -336,11 +339,34 @@ void setup()
   delay(initialDelay);  // allows time to open the Serial Monitor
 
   DEBUG_PORT.begin(9600);
-  Serial.begin(9600, SERIAL_OUTPUT_TYPE == SerialOutputType::IoT ? SERIAL_7E1 : SERIAL_8N1);  // initialize Serial interface, Do NOT set greater than 9600
+  if constexpr (CYCLE_STREAMING)
+  {
+    Serial.begin(CYCLE_STREAMING_BAUD_RATE);  // binary frames of each mains cycle, see cycle_stream.h
+  }
+  else
+  {
+    Serial.begin(9600, SERIAL_OUTPUT_TYPE == SerialOutputType::IoT ? SERIAL_7E1 : SERIAL_8N1);  // initialize Serial interface, Do NOT set greater than 9600
+  }
+
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    loadRuntimeParams();
+  }
 
   // On start, always display config info in the serial monitor
   printConfiguration();
 
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    printRuntimeParams();
+  }
+
+  if constexpr (ENERGY_METERS)
+  {
+    loadEnergyMeters();
+    printRestoredEnergyMeters();
+  }
+
   // initializes all loads to OFF at startup
   initializeProcessing();
 
@@ -356,6 +382,36 @@ void setup()
   DBUGLN(F("----"));
 }
 
+/**
+ * @brief Updates current, apparent power and power factor data for a phase.
+ *
+ * @tparam Datalog The datalog type, whose sum_Isquared member only exists with CURRENT_RMS_MEASUREMENT
+ * @param data The datalog values.
+ * @param phase The phase number [0..NO_OF_PHASES[.
+ *
+ * @details
+ * - The current calibration is derived from the power and voltage ones (f_powerCal / f_voltageCal).
+ * - The apparent power is Vrms * Irms, the power factor is the real power divided by the apparent power.
+ * - Must be called after the power and voltage of the phase have been updated.
+ *
+ * @ingroup GeneralProcessing
+ */
+template< typename Datalog >
+void updateCurrentData(const Datalog& data, const uint8_t phase)
+{
+  float Irms{ f_powerCal[phase] / f_voltageCal[phase] * sqrt(data.sum_Isquared[phase] / data.sampleSetsDuringThisDatalogPeriod) };
+  if constexpr (DATALOG_PERIOD_IN_SECONDS > 10)
+  {
+    Irms *= 4;  // I^2 has been scaled by 1/16
+  }
+
+  const float VA{ tx_data.Vrms_L_x100[phase] * 0.01F * Irms };
+
+  current_data.Irms_L_x100[phase] = static_cast< uint16_t >(100 * Irms);
+  current_data.VA_L[phase] = static_cast< uint16_t >(VA);
+  current_data.PF_L_x100[phase] = (VA < 1.0F) ? 0 : static_cast< int8_t >(constrain(100 * tx_data.power_L[phase] / VA, -100.0F, 100.0F));
+}
+
 /**
  * @brief Updates power and voltage data for all phases.
  *
@@ -376,18 +432,23 @@ void updatePowerAndVoltageData()
   do
   {
     --phase;
-    tx_data.power_L[phase] = Shared::copyOf_sumP_atSupplyPoint[phase] / Shared::copyOf_sampleSetsDuringThisDatalogPeriod * f_powerCal[phase];
+    tx_data.power_L[phase] = copyOf_datalog.sumP_atSupplyPoint[phase] / copyOf_datalog.sampleSetsDuringThisDatalogPeriod * f_powerCal[phase];
     tx_data.power_L[phase] *= -1;
 
     tx_data.power += tx_data.power_L[phase];
 
     if constexpr (DATALOG_PERIOD_IN_SECONDS > 10)
     {
-      tx_data.Vrms_L_x100[phase] = static_cast< uint32_t >((100U << 2) * f_voltageCal[phase] * sqrt(Shared::copyOf_sum_Vsquared[phase] / Shared::copyOf_sampleSetsDuringThisDatalogPeriod));
+      tx_data.Vrms_L_x100[phase] = static_cast< uint32_t >((100U << 2) * f_voltageCal[phase] * sqrt(copyOf_datalog.sum_Vsquared[phase] / copyOf_datalog.sampleSetsDuringThisDatalogPeriod));
     }
     else
     {
-      tx_data.Vrms_L_x100[phase] = static_cast< uint32_t >(100U * f_voltageCal[phase] * sqrt(Shared::copyOf_sum_Vsquared[phase] / Shared::copyOf_sampleSetsDuringThisDatalogPeriod));
+      tx_data.Vrms_L_x100[phase] = static_cast< uint32_t >(100U * f_voltageCal[phase] * sqrt(copyOf_datalog.sum_Vsquared[phase] / copyOf_datalog.sampleSetsDuringThisDatalogPeriod));
+    }
+
+    if constexpr (CURRENT_RMS_MEASUREMENT)
+    {
+      updateCurrentData(copyOf_datalog, phase);
     }
   } while (phase);
 }
@@ -482,9 +543,12 @@ void handlePerSecondTasks(bool &bOffPeak, int16_t &iTemperature_x100)
  * proper system operation.
  *
  * @details
+ * - Reads the serial commands changing the runtime parameters if enabled.
+ * - Sends the per-cycle records if enabled.
+ * - Moves the queued telemetry to the serial link, without blocking, if enabled.
  * - Executes tasks triggered by the `b_newMainsCycle` flag, which is set after every pair of ADC conversions.
  * - Handles per-second tasks such as load priority management and diversion state updates.
- * - Processes data logging events and updates power, voltage, and temperature data.
+ * - Processes data logging events and updates power, voltage, and temperature data, and the energy meters if enabled.
  * - Sends telemetry results and updates relay states if relay diversion is enabled.
  *
  * @ingroup GeneralProcessing
@@ -495,6 +559,21 @@ void loop()
   static bool bOffPeak{ false };
   static int16_t iTemperature_x100{ 0 };
 
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    processSerialCommands();
+  }
+
+  if constexpr (CYCLE_STREAMING)
+  {
+    sendCycleRecords();
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    txQueue.drain(Serial);
+  }
+
   if (Shared::b_newMainsCycle)  // flag is set after every pair of ADC conversions
   {
     Shared::b_newMainsCycle = false;  // reset the flag
@@ -510,9 +589,15 @@ void loop()
   if (Shared::b_datalogEventPending)
   {
     Shared::b_datalogEventPending = false;
+    Shared::datalog.read(copyOf_datalog);  // coherent copy, even if the ISR publishes new data meanwhile
 
     updatePowerAndVoltageData();
 
+    if constexpr (ENERGY_METERS)
+    {
+      updateEnergyMeters();
+    }
+
     if constexpr (RELAY_DIVERSION)
     {
       relays.update_average(tx_data.power);
@@ -0,0 +1,209 @@
+/**
+ * @file Arduino.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Minimal Arduino core replacement for the native (host) build
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details This header is only on the include path of 'env:native'. It provides just enough
+ *          of the Arduino/AVR API for the processing engine and its configuration headers
+ *          to compile on a Linux box:
+ *          - integer types and the usual helper macros (bit(), lowByte(), F(), ...),
+ *          - the I/O ports used by 'utils_pins.h', emulated as plain variables,
+ *          - a 'Serial' object writing to stdout,
+ *          - millis()/micros() driven by the native HAL clock (see hal_native.h).
+ *
+ *          Everything touching the ADC goes through the HAL, so no ADC register is emulated here.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef ARDUINO_NATIVE_H
+#define ARDUINO_NATIVE_H
+
+#include <chrono>  // before the abs() macro below, which clashes with std::chrono
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+using byte = uint8_t;
+using boolean = bool;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define SERIAL_8N1 0x06
+#define SERIAL_7E1 0x24
+
+#define B00000011 3
+
+#undef abs
+#define abs(x) ((x) > 0 ? (x) : -(x))
+
+#define bit(b) (1UL << (b))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+#define PSTR(s) (s)
+#define F(string_literal) (reinterpret_cast< const __FlashStringHelper* >(string_literal))
+
+/** On the host, an ISR is a plain function the native HAL calls, e.g. ISR(ADC_vect) => ADC_vect_isr() */
+#define ISR(vector) void vector##_isr()
+
+#define sei()
+#define cli()
+
+class __FlashStringHelper;
+
+// Emulated I/O ports (Arduino UNO)
+inline volatile uint8_t PORTB{ 0 };
+inline volatile uint8_t PORTC{ 0 };
+inline volatile uint8_t PORTD{ 0 };
+inline volatile uint8_t PINB{ 0 };
+inline volatile uint8_t PINC{ 0 };
+inline volatile uint8_t PIND{ 0 };
+inline volatile uint8_t DDRB{ 0 };
+inline volatile uint8_t DDRC{ 0 };
+inline volatile uint8_t DDRD{ 0 };
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+/**
+ * @brief Tiny subset of the Arduino 'Print' class
+ *
+ */
+class Print
+{
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t* buffer, size_t size)
+  {
+    size_t n{ 0 };
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* buffer, size_t size)
+  {
+    return write(reinterpret_cast< const uint8_t* >(buffer), size);
+  }
+
+  size_t print(const __FlashStringHelper* str)
+  {
+    return print(reinterpret_cast< const char* >(str));
+  }
+  size_t print(const char* str)
+  {
+    return write(str, strlen(str));
+  }
+  size_t print(char c)
+  {
+    return write(static_cast< uint8_t >(c));
+  }
+  size_t print(long n, int base = DEC)
+  {
+    char buf[8 * sizeof(long) + 2];
+    if (base == DEC)
+    {
+      return print(format(buf, sizeof(buf), "%ld", n));
+    }
+    return print(static_cast< unsigned long >(n), base);
+  }
+  size_t print(unsigned long n, int base = DEC)
+  {
+    char buf[8 * sizeof(long) + 1];
+    char* ptr{ buf + sizeof(buf) - 1 };
+    *ptr = '\0';
+    do
+    {
+      const auto digit{ static_cast< char >(n % base) };
+      *--ptr = digit < 10 ? '0' + digit : 'A' + digit - 10;
+      n /= base;
+    } while (n);
+    return print(ptr);
+  }
+  size_t print(int n, int base = DEC)
+  {
+    return print(static_cast< long >(n), base);
+  }
+  size_t print(unsigned int n, int base = DEC)
+  {
+    return print(static_cast< unsigned long >(n), base);
+  }
+  size_t print(unsigned char n, int base = DEC)
+  {
+    return print(static_cast< unsigned long >(n), base);
+  }
+  size_t print(double n, int digits = 2)
+  {
+    char buf[48];
+    return print(format(buf, sizeof(buf), "%.*f", digits, n));
+  }
+
+  template< typename T > size_t println(T value)
+  {
+    const auto n{ print(value) };
+    return n + println();
+  }
+  template< typename T > size_t println(T value, int base)
+  {
+    const auto n{ print(value, base) };
+    return n + println();
+  }
+  size_t println()
+  {
+    return print("\r\n");
+  }
+
+private:
+  template< typename... Args > static const char* format(char* buf, size_t size, const char* fmt, Args... args)
+  {
+    snprintf(buf, size, fmt, args...);
+    return buf;
+  }
+};
+
+/**
+ * @brief Serial port of the native build, writes to stdout
+ *
+ */
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long, uint8_t = SERIAL_8N1) {}
+
+  size_t write(uint8_t c) override
+  {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+  }
+  using Print::write;
+
+  int availableForWrite()
+  {
+    return 63;
+  }
+  void flush()
+  {
+    fflush(stdout);
+  }
+};
+
+extern HardwareSerial Serial;
+
+#endif  // ARDUINO_NATIVE_H
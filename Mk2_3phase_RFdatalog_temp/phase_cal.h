@@ -0,0 +1,50 @@
+/**
+ * @file phase_cal.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Phase-shift correction of the voltage samples (f_phaseCal), in integer arithmetic
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef PHASE_CAL_H
+#define PHASE_CAL_H
+
+#include "calibration.h"
+
+/**
+ * @brief Rounds f_phaseCal * 256 at compile time
+ *
+ * @return The rounded value
+ */
+constexpr int16_t initPhaseCal()
+{
+  return static_cast< int16_t >(f_phaseCal * 256 + (f_phaseCal < 0 ? -0.5F : 0.5F));
+}
+
+inline constexpr int16_t i_phaseCal{ initPhaseCal() }; /**< to avoid the need for floating-point maths (f_phaseCal * 256) */
+
+static_assert(i_phaseCal >= -256 && i_phaseCal <= 512, "******** f_phaseCal must be in the range [-1..2] ! ********");
+
+/**
+ * @brief Interpolates between the two most recent voltage samples of a phase.
+ *
+ * @details With phaseCal = 256, the most recent sample is returned.
+ *          With phaseCal = 0, the previous one is returned.
+ *          Values outside [0..256] extrapolate.
+ *
+ * @param lastSampleV The previous voltage sample, minus DC (x256)
+ * @param sampleV The most recent voltage sample, minus DC (x256)
+ * @param phaseCal f_phaseCal * 256
+ * @return The phase-shifted voltage sample, minus DC (x256)
+ *
+ * @ingroup TimeCritical
+ */
+inline int32_t phaseShiftedSampleV(const int32_t lastSampleV, const int32_t sampleV, const int16_t phaseCal = i_phaseCal)
+{
+  return lastSampleV + (((sampleV - lastSampleV) * phaseCal) >> 8);
+}
+
+#endif /* PHASE_CAL_H */
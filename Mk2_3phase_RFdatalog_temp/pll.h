@@ -0,0 +1,250 @@
+/**
+ * @file pll.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Software PLL tracking the zero-crossings of a voltage waveform
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The PLL runs on the sample count: each voltage sample of a phase advances its
+ *          phase accumulator by one sample set. The positive-going zero-crossings of the
+ *          waveform are located between two samples by linear interpolation, and compared
+ *          with the predicted ones. A proportional-integral loop filter then corrects the
+ *          phase accumulator and the estimated period of the mains.
+ *
+ *          All values are in sample sets, with 8 fractional bits.
+ *
+ *          Once locked:
+ *          - the next zero-crossing is predicted from the sample count, without waiting for
+ *            the polarity of the following samples to be confirmed,
+ *          - crossings far away from the prediction (noise, spikes) are ignored,
+ *          - the mains frequency is known to better than 0.01 Hz.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef PLL_H
+#define PLL_H
+
+#include <Arduino.h>
+
+#include "adc_timing.h"
+#include "types.h"
+
+inline constexpr uint16_t PLL_ONE_SAMPLE_SET{ 256 }; /**< one sample set, with 8 fractional bits */
+
+inline constexpr uint32_t PLL_SAMPLE_SETS_PER_SECOND_X100_Q8{ ADC_SAMPLE_SETS_PER_SECOND_X100_Q8 }; /**< number of sample sets per second x100, with 8 fractional bits */
+
+/**
+ * @brief Period of the mains for the given frequency, in sample sets with 8 fractional bits
+ *
+ * @param frequency The mains frequency in Hz
+ * @return The period
+ */
+constexpr uint16_t pllPeriodFor(const uint8_t frequency)
+{
+  return static_cast< uint16_t >(PLL_SAMPLE_SETS_PER_SECOND_X100_Q8 / (frequency * 100UL));
+}
+
+inline constexpr uint16_t PLL_MIN_PERIOD{ pllPeriodFor(66) }; /**< shortest period accepted while acquiring */
+inline constexpr uint16_t PLL_MAX_PERIOD{ pllPeriodFor(44) }; /**< longest period accepted while acquiring */
+
+static_assert(PLL_MAX_PERIOD < INT16_MAX, "******** The period of the mains must fit in 16 bits ! ********");
+
+/**
+ * @brief Software PLL locked on the positive-going zero-crossings of a voltage waveform
+ *
+ */
+class ZeroCrossingPll
+{
+public:
+  static constexpr uint8_t KP_SHIFT{ 2 };                    /**< proportional gain of the loop filter, 1/4 */
+  static constexpr uint8_t KI_SHIFT{ 5 };                    /**< integral gain of the loop filter, 1/32 */
+  static constexpr int16_t WINDOW{ 2 * PLL_ONE_SAMPLE_SET }; /**< crossings further from the prediction are ignored once locked */
+  static constexpr uint8_t LOCK_CYCLES{ 8 };                 /**< consecutive consistent periods to declare the lock */
+  static constexpr uint8_t UNLOCK_CYCLES{ 4 };               /**< consecutive missing crossings to lose the lock */
+
+  /**
+   * @brief Processes a new voltage sample.
+   *
+   * @param sampleV The voltage sample, minus DC (any scale)
+   *
+   * @ingroup TimeCritical
+   */
+  void update(const int32_t sampleV)
+  {
+    phase += PLL_ONE_SAMPLE_SET;
+    if (phase >= period)
+    {
+      phase -= period;  // the predicted zero-crossing has just been passed
+
+      if (locked && ++missedCrossings > UNLOCK_CYCLES)
+      {
+        locked = false;
+        lockCount = 0;
+      }
+    }
+
+    if (elapsed < UINT16_MAX - PLL_ONE_SAMPLE_SET)
+    {
+      elapsed += PLL_ONE_SAMPLE_SET;
+    }
+
+    if (lastSampleV < 0 && sampleV >= 0)
+    {
+      processCrossing(sampleV);
+    }
+
+    lastSampleV = sampleV;
+  }
+
+  /**
+   * @brief Whether the PLL is locked on the waveform
+   *
+   */
+  bool isLocked() const
+  {
+    return locked;
+  }
+
+  /**
+   * @brief Predicted polarity of the current sample
+   *
+   * @return POSITIVE during the first half of the predicted period
+   *
+   * @ingroup TimeCritical
+   */
+  Polarities polarity() const
+  {
+    return (phase < (period >> 1)) ? Polarities::POSITIVE : Polarities::NEGATIVE;
+  }
+
+  /**
+   * @brief Estimated period of the mains, in sample sets with 8 fractional bits
+   *
+   */
+  uint16_t getPeriod() const
+  {
+    return period;
+  }
+
+private:
+  /**
+   * @brief Processes a positive-going zero-crossing located between the last sample and the current one.
+   *
+   * @param sampleV The current voltage sample (>= 0)
+   */
+  void processCrossing(const int32_t sampleV)
+  {
+    // time elapsed since the crossing, as a fraction of the sample interval: sampleV / (sampleV - lastSampleV)
+    uint32_t num{ static_cast< uint32_t >(sampleV) };
+    uint32_t den{ static_cast< uint32_t >(sampleV - lastSampleV) };
+    while (den > UINT8_MAX)
+    {
+      num >>= 1;
+      den >>= 1;
+    }
+    const auto sinceCrossing{ static_cast< uint16_t >((static_cast< uint16_t >(num) << 8) / static_cast< uint16_t >(den)) };
+
+    const uint16_t measuredPeriod{ static_cast< uint16_t >(elapsed - sinceCrossing) };
+    elapsed = sinceCrossing;
+
+    // phase error: measured crossing minus predicted crossing
+    auto error{ static_cast< int16_t >(phase - sinceCrossing) };
+    if (error > static_cast< int16_t >(period >> 1))
+    {
+      error -= period;
+    }
+    else if (error < -static_cast< int16_t >(period >> 1))
+    {
+      error += period;
+    }
+
+    if (!locked)
+    {
+      acquire(measuredPeriod, sinceCrossing);
+      return;
+    }
+
+    if (error > WINDOW || error < -WINDOW)
+    {
+      return;  // not the crossing we are waiting for
+    }
+
+    missedCrossings = 0;
+
+    // the integral path keeps 8 more fractional bits, so that the period has no dead zone
+    const int32_t periodQ16{ ((static_cast< int32_t >(period) << 8) | periodFraction) + (static_cast< int32_t >(error) << (8 - KI_SHIFT)) };
+    period = static_cast< uint16_t >(periodQ16 >> 8);
+    periodFraction = static_cast< uint8_t >(periodQ16);
+
+    int16_t correctedPhase{ static_cast< int16_t >(phase - (error >> KP_SHIFT)) };
+    if (correctedPhase < 0)
+    {
+      correctedPhase += period;
+    }
+    else if (correctedPhase >= static_cast< int16_t >(period))
+    {
+      correctedPhase -= period;
+    }
+    phase = correctedPhase;
+  }
+
+  /**
+   * @brief Acquires the period and the phase of the waveform, crossing after crossing.
+   *
+   * @param measuredPeriod The interval between the last two crossings
+   * @param sinceCrossing Time elapsed since the crossing
+   */
+  void acquire(const uint16_t measuredPeriod, const uint16_t sinceCrossing)
+  {
+    if (measuredPeriod < PLL_MIN_PERIOD || measuredPeriod > PLL_MAX_PERIOD)
+    {
+      lockCount = 0;
+      return;
+    }
+
+    const auto delta{ static_cast< int16_t >(measuredPeriod - period) };
+    if (delta < PLL_ONE_SAMPLE_SET / 2 && delta > -static_cast< int16_t >(PLL_ONE_SAMPLE_SET / 2))
+    {
+      period += delta >> 2;  // average the consecutive measurements
+      periodFraction = 0;
+
+      if (++lockCount >= LOCK_CYCLES)
+      {
+        locked = true;
+        missedCrossings = 0;
+      }
+    }
+    else
+    {
+      period = measuredPeriod;
+      periodFraction = 0;
+      lockCount = 0;
+    }
+
+    phase = sinceCrossing;
+  }
+
+  int32_t lastSampleV{ 0 };                          /**< previous voltage sample */
+  uint16_t period{ pllPeriodFor(SUPPLY_FREQUENCY) }; /**< estimated period of the mains */
+  uint8_t periodFraction{ 0 };                       /**< 8 more fractional bits of the period, for the integral path */
+  uint16_t phase{ 0 };                               /**< time elapsed since the predicted zero-crossing */
+  uint16_t elapsed{ 0 };                             /**< time elapsed since the last measured zero-crossing */
+  uint8_t lockCount{ 0 };                            /**< consecutive consistent periods while acquiring */
+  uint8_t missedCrossings{ 0 };                      /**< consecutive predicted crossings without a measured one */
+  bool locked{ false };                              /**< PLL locked on the waveform */
+};
+
+/**
+ * @brief Converts a period of the mains to a frequency
+ *
+ * @param period The period, in sample sets with 8 fractional bits
+ * @return The frequency in 1/100 Hz
+ */
+inline uint16_t pllFrequency_x100(const uint16_t period)
+{
+  return period ? static_cast< uint16_t >((PLL_SAMPLE_SETS_PER_SECOND_X100_Q8 + period / 2) / period) : 0;
+}
+
+#endif /* PLL_H */
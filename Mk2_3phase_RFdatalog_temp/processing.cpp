@@ -13,8 +13,19 @@
 
 #include "config.h"
 #include "calibration.h"
+#include "ct_filter.h"
+#include "cycle_distribution.h"
 #include "dualtariff.h"
+#include "energy_bucket.h"
+#include "FastMultiply.h"
+#include "hal.h"
+#include "isr_timing.h"
+#include "load_ports.h"
+#include "phase_cal.h"
+#include "pll.h"
 #include "processing.h"
+#include "runtime_params.h"
+#include "sample_integrity.h"
 #include "utils_pins.h"
 #include "shared_var.h"
 
@@ -25,38 +36,52 @@ constexpr int32_t l_DCoffset_V_min{ (512L - 100L) * 256L }; /**< mid-point of AD
 constexpr int32_t l_DCoffset_V_max{ (512L + 100L) * 256L }; /**< mid-point of ADC plus a working margin */
 constexpr int16_t i_DCoffset_I_nom{ 512L };                 /**< nominal mid-point value of ADC @ x1 scale */
 
-int32_t l_DCoffset_V[NO_OF_PHASES]{}; /**< <--- for LPF */
-
-/**< main energy bucket for 3-phase use, with units of Joules * SUPPLY_FREQUENCY */
-constexpr float f_capacityOfEnergyBucket_main{ static_cast< float >(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY) };
-/**< for resetting flexible thresholds */
-constexpr float f_midPointOfEnergyBucket_main{ f_capacityOfEnergyBucket_main * 0.5F };
-/**< threshold in anti-flicker mode - must not exceed 0.4 */
-constexpr float f_offsetOfEnergyThresholdsInAFmode{ 0.1F };
+// Same for the current sample streams, when the DC offset is tracked (CURRENT_DC_OFFSET_TRACKING).
+constexpr int32_t l_DCoffset_I_min{ (512L - 100L) * 256L }; /**< mid-point of ADC minus a working margin */
+constexpr int32_t l_DCoffset_I_max{ (512L + 100L) * 256L }; /**< mid-point of ADC plus a working margin */
 
-constexpr OutputModes outputMode{ OutputModes::NORMAL }; /**< Output mode to be used */
-
-bool b_diversionStarted{ false }; /**< Tracks whether diversion has started */
+int32_t l_DCoffset_V[NO_OF_PHASES]{}; /**< <--- for LPF */
 
 /**
- * @brief set default threshold at compile time so the variable can be read-only
+ * @brief LP filters which identify the DC offset of the current sample streams
+ * @details The primary template is empty, so the filters take no RAM without CURRENT_DC_OFFSET_TRACKING.
+ *          The code using them takes the filters as a template parameter, so that their members
+ *          are never looked up when the feature is disabled.
  *
- * @param lower True to set the lower threshold, false for higher
- * @return the corresponding threshold
+ * @tparam enabled CURRENT_DC_OFFSET_TRACKING is set
  */
-constexpr auto initThreshold(const bool lower)
+template< bool enabled > struct CurrentDCoffsetFilters
 {
-  return lower
-           ? f_capacityOfEnergyBucket_main * (0.5F - ((OutputModes::ANTI_FLICKER == outputMode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F))
-           : f_capacityOfEnergyBucket_main * (0.5F + ((OutputModes::ANTI_FLICKER == outputMode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F));
-}
+};
+
+/** @brief LP filters of the current for CURRENT_DC_OFFSET_TRACKING */
+template<> struct CurrentDCoffsetFilters< true >
+{
+  int32_t l_DCoffset_I[NO_OF_PHASES]{};          /**< <--- for LPF */
+  int32_t l_cumIdeltasThisCycle[NO_OF_PHASES]{}; /**< for the LPF which determines DC offset (current) */
+};
 
-constexpr float f_lowerThreshold_default{ initThreshold(true) };  /**< lower default threshold set accordingly to the output mode */
-constexpr float f_upperThreshold_default{ initThreshold(false) }; /**< upper default threshold set accordingly to the output mode */
+CurrentDCoffsetFilters< CURRENT_DC_OFFSET_TRACKING > currentDCoffset; /**< DC offset of the current (CURRENT_DC_OFFSET_TRACKING) */
 
-float f_energyInBucket_main{ 0.0F };  /**< main energy bucket (over all phases) */
-float f_lowerEnergyThreshold{ 0.0F }; /**< dynamic lower threshold */
-float f_upperEnergyThreshold{ 0.0F }; /**< dynamic upper threshold */
+/**< main energy bucket for 3-phase use, with units of Joules * SUPPLY_FREQUENCY (see energy_bucket.h for the fixed-point build) */
+constexpr energy_t f_capacityOfEnergyBucket_main{ toEnergy(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY) };
+/**< for resetting flexible thresholds */
+constexpr energy_t f_midPointOfEnergyBucket_main{ toEnergy(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY * 0.5F) };
+
+/**< in cycle-distribution mode, the energy bucket from empty to full requests all the loads from OFF to fully ON */
+constexpr energy_t f_energyPerDutyStep{ toEnergy(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY / static_cast< float >(CycleDistributor< NO_OF_DUMPLOADS >::MAX_DEMAND)) };
+
+constexpr auto loadPortMasks{ makeLoadPortMasks(physicalLoadPin) }; /**< bits of the loads in PORTD and PORTB */
+
+CycleDistributor< NO_OF_DUMPLOADS > cycleDistributor; /**< scheduler of the ON cycles in cycle-distribution mode */
+
+CycleRecord cycleRecord; /**< record of the current mains cycle, when CYCLE_STREAMING is set */
+
+bool b_diversionStarted{ false }; /**< Tracks whether diversion has started */
+
+energy_t f_energyInBucket_main{ 0 };  /**< main energy bucket (over all phases) */
+energy_t f_lowerEnergyThreshold{ 0 }; /**< dynamic lower threshold */
+energy_t f_upperEnergyThreshold{ 0 }; /**< dynamic upper threshold */
 
 // for improved control of multiple loads
 bool b_recentTransition{ false };                 /**< a load state has been recently toggled */
@@ -67,20 +92,23 @@ uint8_t activeLoad{ NO_OF_DUMPLOADS }; /**< current active load */
 
 int32_t l_sumP[NO_OF_PHASES]{};                /**< cumulative power per phase */
 int32_t l_sampleVminusDC[NO_OF_PHASES]{};      /**< current raw voltage sample filtered */
+int32_t l_lastSampleVminusDC[NO_OF_PHASES]{};  /**< previous raw voltage sample filtered, for the phaseCal algorithm */
 int32_t l_cumVdeltasThisCycle[NO_OF_PHASES]{}; /**< for the LPF which determines DC offset (voltage) */
 int32_t l_sumP_atSupplyPoint[NO_OF_PHASES]{};  /**< for summation of 'real power' values during datalog period */
 int32_t l_sum_Vsquared[NO_OF_PHASES]{};        /**< for summation of V^2 values during datalog period */
+uint32_t l_sum_Isquared[NO_OF_PHASES]{};       /**< for summation of I^2 values during datalog period (CURRENT_RMS_MEASUREMENT) */
 
 uint8_t n_samplesDuringThisMainsCycle[NO_OF_PHASES]{}; /**< number of sample sets for each phase during each mains cycle */
 uint16_t i_sampleSetsDuringThisDatalogPeriod{ 0 };     /**< number of sample sets during each datalogging period */
 
-remove_cv< remove_reference< decltype(DATALOG_PERIOD_IN_MAINS_CYCLES) >::type >::type n_cycleCountForDatalogging{ 0 }; /**< for counting how often datalog is updated */
+uint16_t n_cycleCountForDatalogging{ 0 }; /**< for counting how often datalog is updated */
 
 uint8_t n_lowestNoOfSampleSetsPerMainsCycle{ 0 }; /**< For a mechanism to check the integrity of this code structure */
 
 // For an enhanced polarity detection mechanism, which includes a persistence check
 Polarities polarityOfMostRecentSampleV[NO_OF_PHASES]{};    /**< for zero-crossing detection */
 Polarities polarityConfirmed[NO_OF_PHASES]{};              /**< for zero-crossing detection */
+ZeroCrossingPll pll[PLL_ZERO_CROSSING ? NO_OF_PHASES : 1]; /**< for zero-crossing prediction (PLL_ZERO_CROSSING), the first one also measures the frequency (MAINS_FREQUENCY_MEASUREMENT) */
 Polarities polarityConfirmedOfLastSampleV[NO_OF_PHASES]{}; /**< for zero-crossing detection */
 
 LoadStates physicalLoadState[NO_OF_DUMPLOADS]{}; /**< Physical state of the loads */
@@ -226,6 +254,69 @@ constexpr uint16_t getInputPins()
   return input_pins;
 }
 
+/**
+ * @brief Initializes the LP filters of the current to the nominal mid-point of the ADC.
+ *
+ * @tparam Filters The filters type, whose members only exist with CURRENT_DC_OFFSET_TRACKING
+ * @param filters The filters
+ *
+ * @ingroup Initialization
+ */
+template< typename Filters >
+void initializeCurrentDCoffset(Filters &filters)
+{
+  initializeArray(filters.l_DCoffset_I, i_DCoffset_I_nom * 256L);  // nominal mid-point value of ADC @ x256 scale
+}
+
+/**
+ * @brief Removes the tracked DC offset from a current sample, and accumulates it for the LP filter.
+ *
+ * @tparam Filters The filters type, whose members only exist with CURRENT_DC_OFFSET_TRACKING
+ * @param filters The filters
+ * @param phase The phase number [0..NO_OF_PHASES[
+ * @param rawSample The current raw sample
+ * @return The current sample minus DC, x256
+ *
+ * @ingroup TimeCritical
+ */
+template< typename Filters >
+int32_t removeCurrentDCoffset(Filters &filters, const uint8_t phase, const int16_t rawSample)
+{
+  const int32_t sampleIminusDC{ (static_cast< int32_t >(rawSample) << 8) - filters.l_DCoffset_I[phase] };
+  filters.l_cumIdeltasThisCycle[phase] += sampleIminusDC;  // for use with LP filter
+
+  return sampleIminusDC;
+}
+
+/**
+ * @brief Updates the Low Pass Filter which determines the DC offset of the current of a phase.
+ *
+ * @tparam Filters The filters type, whose members only exist with CURRENT_DC_OFFSET_TRACKING
+ * @param filters The filters
+ * @param phase the phase number [0..NO_OF_PHASES[
+ *
+ * @details Same filter as for the voltage, once per mains cycle. Any DC offset left in the
+ *          current samples would add a DC error to the real power, seen as a phantom
+ *          import or export at low load.
+ *
+ * @ingroup TimeCritical
+ */
+template< typename Filters >
+void updateCurrentDCoffset(Filters &filters, const uint8_t phase)
+{
+  filters.l_DCoffset_I[phase] += (filters.l_cumIdeltasThisCycle[phase] >> 12);
+  filters.l_cumIdeltasThisCycle[phase] = 0;
+
+  if (filters.l_DCoffset_I[phase] < l_DCoffset_I_min)
+  {
+    filters.l_DCoffset_I[phase] = l_DCoffset_I_min;
+  }
+  else if (filters.l_DCoffset_I[phase] > l_DCoffset_I_max)
+  {
+    filters.l_DCoffset_I[phase] = l_DCoffset_I_max;
+  }
+}
+
 /**
  * @brief Initializes the processing engine, including ports, load states, and ADC setup.
  *
@@ -243,6 +334,11 @@ void initializeProcessing()
 {
   initializeArray(l_DCoffset_V, 512L * 256L);  // nominal mid-point value of ADC @ x256 scale
 
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    initializeCurrentDCoffset(currentDCoffset);
+  }
+
   setPinsAsOutput(getOutputPins());      // set the output pins as OUTPUT
   setPinsAsInputPullup(getInputPins());  // set the input pins as INPUT_PULLUP
 
@@ -254,28 +350,12 @@ void initializeProcessing()
     loadPrioritiesAndState[i] &= loadStateMask;
   } while (i);
 
-  // First stop the ADC
-  bit_clear(ADCSRA, ADEN);
-
-  // Activate free-running mode
-  ADCSRB = 0x00;
-
-  // Set up the ADC to be free-running
-  bit_set(ADCSRA, ADPS0);  // Set the ADC's clock to system clock / 128
-  bit_set(ADCSRA, ADPS1);
-  bit_set(ADCSRA, ADPS2);
-
-  bit_set(ADCSRA, ADATE);  // set the Auto Trigger Enable bit in the ADCSRA register. Because
-  // bits ADTS0-2 have not been set (i.e. they are all zero), the
-  // ADC's trigger source is set to "free running mode".
-
-  bit_set(ADCSRA, ADIE);  // set the ADC interrupt enable bit. When this bit is written
-  // to one and the I-bit in SREG is set, the
-  // ADC Conversion Complete Interrupt is activated.
-
-  bit_set(ADCSRA, ADEN);  // Enable the ADC
+  if constexpr (ISR_TIMING_INSTRUMENTATION || (SAMPLE_INTEGRITY_DIAGNOSTICS && !ADC_TIMER_TRIGGERED))
+  {
+    HAL::initCycleCounter();  // Timer1 as time base for the measurement of the ISR and the detection of the missed conversions
+  }
 
-  bit_set(ADCSRA, ADSC);  // start ADC manually first time
+  HAL::initADC();  // free-running or Timer1-triggered mode (see adc_timing.h), with interrupts enabled
 
   sei();  // Enable Global Interrupts
 }
@@ -288,17 +368,16 @@ void initializeProcessing()
  * specific pins ON when override pins are active.
  *
  * @details
- * - If a load is OFF, its corresponding pin is added to the `pinsOFF` mask.
- * - If a load is ON, its corresponding pin is added to the `pinsON` mask.
- * - Override bitmask is applied directly to `pinsON` for immediate pin activation.
- * - Finally, the pins are updated using `setPinsOFF` and `setPinsON` functions.
+ * - The bits of the loads which are ON are gathered per port, from the masks computed at compile time (see load_ports.h).
+ * - Override bitmask is applied directly to the new state for immediate pin activation.
+ * - Finally, each port is updated with a single masked write through the HAL pin sink,
+ *   so that all the loads of a port switch at once.
  *
  * @ingroup TimeCritical
  */
 void updatePortsStates()
 {
-  uint16_t pinsON{ 0 };
-  uint16_t pinsOFF{ 0 };
+  PortBits state{ toPortBits(Shared::overrideBitmask) };
 
   uint8_t i{ NO_OF_DUMPLOADS };
 
@@ -306,24 +385,15 @@ void updatePortsStates()
   {
     --i;
     // update the local load's state.
-    if (LoadStates::LOAD_OFF == physicalLoadState[i])
-    {
-      // setPinOFF(physicalLoadPin[i]);
-      pinsOFF |= bit(physicalLoadPin[i]);
-    }
-    else
+    if (LoadStates::LOAD_ON == physicalLoadState[i])
     {
       ++countLoadON[i];
-      // setPinON(physicalLoadPin[i]);
-      pinsON |= bit(physicalLoadPin[i]);
+      state.portD |= loadPortMasks.load[i].portD;
+      state.portB |= loadPortMasks.load[i].portB;
     }
   } while (i);
 
-  // Apply override bitmask directly to pinsON
-  pinsON |= Shared::overrideBitmask;
-
-  setPinsOFF(pinsOFF);
-  setPinsON(pinsON);
+  HAL::writeLoadPorts(loadPortMasks.all, state);
 }
 
 /**
@@ -375,12 +445,13 @@ void updatePhysicalLoadStates()
   }
 
   const bool bDiversionEnabled{ Shared::b_diversionEnabled };
+  const PortBits overrideBits{ toPortBits(Shared::overrideBitmask) };
   uint8_t idx{ NO_OF_DUMPLOADS };
   do
   {
     --idx;
     const auto iLoad{ loadPrioritiesAndState[idx] & loadStateMask };
-    const bool bOverrideActive = Shared::overrideBitmask & (1U << physicalLoadPin[iLoad]);
+    const bool bOverrideActive = (overrideBits.portD & loadPortMasks.load[iLoad].portD) | (overrideBits.portB & loadPortMasks.load[iLoad].portB);
     physicalLoadState[iLoad] = bDiversionEnabled && (bOverrideActive || (loadPrioritiesAndState[idx] & loadStateOnBit)) ? LoadStates::LOAD_ON : LoadStates::LOAD_OFF;
   } while (idx);
 }
@@ -406,8 +477,24 @@ void processPolarity(const uint8_t phase, const int16_t rawSample)
 {
   // remove DC offset from each raw voltage sample by subtracting the accurate value
   // as determined by its associated LP filter.
+  if constexpr (i_phaseCal != 256)
+  {
+    l_lastSampleVminusDC[phase] = l_sampleVminusDC[phase];  // required for phaseCal algorithm
+  }
   l_sampleVminusDC[phase] = (static_cast< int32_t >(rawSample) << 8) - l_DCoffset_V[phase];
   polarityOfMostRecentSampleV[phase] = (l_sampleVminusDC[phase] > 0) ? Polarities::POSITIVE : Polarities::NEGATIVE;
+
+  if constexpr (PLL_ZERO_CROSSING)
+  {
+    pll[phase].update(l_sampleVminusDC[phase]);
+  }
+  else if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    if (!phase)
+    {
+      pll[0].update(l_sampleVminusDC[0]);  // only for the mains frequency
+    }
+  }
 }
 
 /**
@@ -432,22 +519,53 @@ void processCurrentRawSample(const uint8_t phase, const int16_t rawSample)
   // extra items for an LPF to improve the processing of data samples from CT1
   static int32_t lpf_long[NO_OF_PHASES]{};  // new LPF, for offsetting the behaviour of CTx as a HPF
 
-  // remove most of the DC offset from the current sample (the precise value does not matter)
-  int32_t sampleIminusDC = (static_cast< int32_t >(rawSample - i_DCoffset_I_nom)) << 8;
+  int32_t sampleIminusDC;
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    // remove the tracked DC offset from the current sample
+    sampleIminusDC = removeCurrentDCoffset(currentDCoffset, phase, rawSample);
+  }
+  else
+  {
+    // remove most of the DC offset from the current sample (the precise value does not matter)
+    sampleIminusDC = (static_cast< int32_t >(rawSample - i_DCoffset_I_nom)) << 8;
+  }
 
-  // extra filtering to offset the HPF effect of CTx
-  const int32_t last_lpf_long{ lpf_long[phase] };
-  lpf_long[phase] += alpha * (sampleIminusDC - last_lpf_long);
-  sampleIminusDC += (lpf_gain * lpf_long[phase]);
+  // extra filtering to offset the HPF effect of CTx (removed when lpf_gain is 0)
+  sampleIminusDC = compensateCtHighPass(lpf_long[phase], sampleIminusDC);
+
+  // apply the phase-shift correction to the voltage (nothing to do with the nominal f_phaseCal of 1)
+  int32_t phaseShiftedSampleVminusDC{ l_sampleVminusDC[phase] };
+  if constexpr (i_phaseCal != 256)
+  {
+    phaseShiftedSampleVminusDC = phaseShiftedSampleV(l_lastSampleVminusDC[phase], phaseShiftedSampleVminusDC);
+  }
 
   // calculate the "real power" in this sample pair and add to the accumulated sum
-  const int32_t filtV_div4 = l_sampleVminusDC[phase] >> 2;  // reduce to 16-bits (now x64, or 2^6)
-  const int32_t filtI_div4 = sampleIminusDC >> 2;           // reduce to 16-bits (now x64, or 2^6)
-  int32_t instP = filtV_div4 * filtI_div4;                  // 32-bits (now x4096, or 2^12)
-  instP >>= 12;                                             // scaling is now x1, as for Mk2 (V_ADC x I_ADC)
+  const int32_t filtV_div4{ phaseShiftedSampleVminusDC >> 2 };  // reduce to 16-bits (now x64, or 2^6)
+  const int32_t filtI_div4{ sampleIminusDC >> 2 };              // reduce to 16-bits (now x64, or 2^6)
+  int32_t instP{ mulS32(filtV_div4, filtI_div4) };              // 32-bits (now x4096, or 2^12)
+  instP >>= 12;                                                 // scaling is now x1, as for Mk2 (V_ADC x I_ADC)
 
   l_sumP[phase] += instP;                // cumulative power, scaling as for Mk2 (V_ADC x I_ADC)
   l_sumP_atSupplyPoint[phase] += instP;  // cumulative power, scaling as for Mk2 (V_ADC x I_ADC)
+
+  // for the Irms calculation (for datalogging only)
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    auto inst_Isquared{ static_cast< uint32_t >(mulS32(filtI_div4, filtI_div4)) };  // 32-bits (now x4096, or 2^12)
+
+    if constexpr (DATALOG_PERIOD_IN_SECONDS > 10)
+    {
+      inst_Isquared >>= 16;  // scaling is now x1/16 (I_ADC x I_ADC)
+    }
+    else
+    {
+      inst_Isquared >>= 12;  // scaling is now x1 (I_ADC x I_ADC)
+    }
+
+    l_sum_Isquared[phase] += inst_Isquared;  // cumulative I^2 (I_ADC x I_ADC)
+  }
 }
 
 /**
@@ -470,6 +588,15 @@ void confirmPolarity(const uint8_t phase)
 {
   static uint8_t count[NO_OF_PHASES]{};
 
+  if constexpr (PLL_ZERO_CROSSING)
+  {
+    if (pll[phase].isLocked())
+    {
+      polarityConfirmed[phase] = pll[phase].polarity();  // predicted, no need to wait for the next samples
+      return;
+    }
+  }
+
   if (polarityOfMostRecentSampleV[phase] == polarityConfirmedOfLastSampleV[phase])
   {
     count[phase] = 0;
@@ -504,7 +631,7 @@ void processVoltage(const uint8_t phase)
 {
   // for the Vrms calculation (for datalogging only)
   const int32_t filtV_div4{ l_sampleVminusDC[phase] >> 2 };  // reduce to 16-bits (now x64, or 2^6)
-  int32_t inst_Vsquared{ filtV_div4 * filtV_div4 };          // 32-bits (now x4096, or 2^12)
+  int32_t inst_Vsquared{ mulS32(filtV_div4, filtV_div4) };    // 32-bits (now x4096, or 2^12)
 
   if constexpr (DATALOG_PERIOD_IN_SECONDS > 10)
   {
@@ -542,7 +669,7 @@ void processVoltage(const uint8_t phase)
 void processStartUp(const uint8_t phase)
 {
   // wait until the DC-blocking filters have had time to settle
-  if (millis() <= (initialDelay + startUpPeriod))
+  if (HAL::millis() <= (initialDelay + startUpPeriod))
   {
     return;  // still settling, do nothing
   }
@@ -657,21 +784,56 @@ void proceedLowEnergyLevel()
 }
 
 /**
- * @brief Processes the start of a new mains cycle on phase 0.
+ * @brief Switches the loads ON for an even share of the mains cycles, according to the surplus.
  *
- * This function is executed once per 20ms (for 50Hz), shortly after the start of each
- * new mains cycle on phase 0. It manages the energy level and load states, ensuring
- * proper operation of the system.
+ * This function replaces the energy thresholds in cycle-distribution mode.
+ *
+ * @details The energy bucket integrates the surplus left after the diversion, so its level is used
+ *          as the total duty requested from the loads: empty for all loads OFF, full for all loads ON.
+ *          The loop settles where the diverted power matches the surplus, without steady-state error.
+ *          The duty is then spread over the mains cycles by priority (see cycle_distribution.h).
+ *
+ * @ingroup TimeCritical
+ */
+void proceedCycleDistribution()
+{
+  uint16_t demand{ 0 };
+  if (f_energyInBucket_main >= f_capacityOfEnergyBucket_main)
+  {
+    demand = CycleDistributor< NO_OF_DUMPLOADS >::MAX_DEMAND;
+  }
+  else if (f_energyInBucket_main > 0)
+  {
+    demand = static_cast< uint16_t >(f_energyInBucket_main / f_energyPerDutyStep);
+  }
+
+  cycleDistributor.update(demand);
+
+  uint8_t i{ NO_OF_DUMPLOADS };
+  do
+  {
+    --i;
+    if (cycleDistributor.isOn(i))
+    {
+      loadPrioritiesAndState[i] |= loadStateOnBit;
+    }
+    else
+    {
+      loadPrioritiesAndState[i] &= loadStateMask;
+    }
+  } while (i);
+}
+
+/**
+ * @brief Switches the loads ON/OFF according to the energy thresholds (normal and anti-flicker modes).
  *
  * @details
  * - Handles recent transitions and updates the post-transition counter.
  * - Adjusts energy thresholds and determines whether to add or remove loads.
- * - Updates the physical load states and control ports.
- * - Ensures the energy bucket level remains within defined limits.
  *
  * @ingroup TimeCritical
  */
-void processStartNewCycle()
+void proceedEnergyThresholds()
 {
   // Restrictions apply for the period immediately after a load has been switched.
   // Here the b_recentTransition flag is checked and updated as necessary.
@@ -683,7 +845,7 @@ void processStartNewCycle()
   if (f_energyInBucket_main > f_midPointOfEnergyBucket_main)
   {
     // the energy state is in the upper half of the working range
-    f_lowerEnergyThreshold = f_lowerThreshold_default;  // reset the "opposite" threshold
+    f_lowerEnergyThreshold = getLowerThreshold();  // reset the "opposite" threshold
     if (f_energyInBucket_main > f_upperEnergyThreshold)
     {
       // Because the energy level is high, some action may be required
@@ -693,13 +855,66 @@ void processStartNewCycle()
   else
   {
     // the energy state is in the lower half of the working range
-    f_upperEnergyThreshold = f_upperThreshold_default;  // reset the "opposite" threshold
+    f_upperEnergyThreshold = getUpperThreshold();  // reset the "opposite" threshold
     if (f_energyInBucket_main < f_lowerEnergyThreshold)
     {
       // Because the energy level is low, some action may be required
       proceedLowEnergyLevel();
     }
   }
+}
+
+/**
+ * @brief Queues the record of the mains cycle for the per-cycle streaming.
+ *
+ * @details Only raw values are copied here, the main loop converts and sends them (see cycle_stream.h).
+ *          If the main loop can't keep up, the record is dropped and counted.
+ *
+ * @ingroup TimeCritical
+ */
+void proceedCycleStreaming()
+{
+  uint8_t loads{ 0 };
+  uint8_t i{ NO_OF_DUMPLOADS };
+  do
+  {
+    --i;
+    loads <<= 1;
+    loads |= (LoadStates::LOAD_ON == physicalLoadState[i]);
+  } while (i);
+
+  cycleRecord.loads = loads;
+  cycleRecord.energyInBucket = f_energyInBucket_main;
+
+  Shared::cycleStream.push(cycleRecord);
+}
+
+/**
+ * @brief Processes the start of a new mains cycle on phase 0.
+ *
+ * This function is executed once per 20ms (for 50Hz), shortly after the start of each
+ * new mains cycle on phase 0. It manages the energy level and load states, ensuring
+ * proper operation of the system.
+ *
+ * @details
+ * - Takes the load decisions, with the energy thresholds or by cycle distribution (see getOutputMode()).
+ * - Updates the physical load states and control ports.
+ * - Ensures the energy bucket level remains within defined limits.
+ *
+ * @ingroup TimeCritical
+ */
+void processStartNewCycle()
+{
+  const ScopedTiming< TimedSections::START_NEW_CYCLE > timing;
+
+  if (OutputModes::CYCLE_DISTRIBUTION == getOutputMode())
+  {
+    proceedCycleDistribution();
+  }
+  else
+  {
+    proceedEnergyThresholds();
+  }
 
   updatePhysicalLoadStates();  // allows the logical-to-physical mapping to be changed
 
@@ -726,6 +941,11 @@ void processStartNewCycle()
   {
     f_energyInBucket_main = 0;
   }
+
+  if constexpr (CYCLE_STREAMING)
+  {
+    proceedCycleStreaming();
+  }
 }
 
 /**
@@ -765,6 +985,11 @@ void processMinusHalfCycle(const uint8_t phase)
   {
     l_DCoffset_V[phase] = l_DCoffset_V_max;
   }
+
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    updateCurrentDCoffset(currentDCoffset, phase);
+  }
 }
 
 /**
@@ -838,7 +1063,13 @@ void processLatestContribution(const uint8_t phase)
 {
   // for efficiency, the energy scale is Joules * SUPPLY_FREQUENCY
   // add the latest energy contribution to the main energy accumulator
-  f_energyInBucket_main += (l_sumP[phase] / n_samplesDuringThisMainsCycle[phase]) * f_powerCal[phase];
+  const auto contribution{ energyContribution(phase, l_sumP[phase], n_samplesDuringThisMainsCycle[phase]) };
+  f_energyInBucket_main += contribution;
+
+  if constexpr (CYCLE_STREAMING)
+  {
+    cycleRecord.power[phase] = contribution;
+  }
 
   // apply any adjustment that is required.
   if (0 == phase)
@@ -846,10 +1077,10 @@ void processLatestContribution(const uint8_t phase)
     // If diversion hasn't started yet, use start threshold, otherwise use regular offset
     if (!b_diversionStarted)
     {
-      f_energyInBucket_main -= DIVERSION_START_THRESHOLD_WATTS;
+      f_energyInBucket_main -= getDiversionStartThreshold();
 
       // Check if we've exceeded the threshold to start diversion
-      if (f_energyInBucket_main > f_upperThreshold_default)
+      if (f_energyInBucket_main > getUpperThreshold())
       {
         b_diversionStarted = true;
         // Once started, we divert all surplus according to the configured fixed offset
@@ -859,7 +1090,7 @@ void processLatestContribution(const uint8_t phase)
     {
       // When diversion is already started, apply normal export offset if configured
       // Comment or remove this if you want to divert ALL surplus once started
-      f_energyInBucket_main -= REQUIRED_EXPORT_IN_WATTS;
+      f_energyInBucket_main -= getRequiredExport();
     }
 
     if (++perSecondCounter == SUPPLY_FREQUENCY)
@@ -883,6 +1114,64 @@ void processLatestContribution(const uint8_t phase)
   //
 }
 
+/**
+ * @brief Copies the optional current values of a phase (CURRENT_RMS_MEASUREMENT, CURRENT_DC_OFFSET_TRACKING) for the main code.
+ *
+ * @tparam Datalog The datalog type, whose optional members only exist when their feature is set (see shared_var.h)
+ * @tparam Filters The type of the LP filters of the current, whose members only exist with CURRENT_DC_OFFSET_TRACKING
+ * @param datalog The datalog being written
+ * @param filters The LP filters of the current
+ * @param phase The phase number [0..NO_OF_PHASES[
+ *
+ * @ingroup TimeCritical
+ */
+template< typename Datalog, typename Filters >
+void logCurrentValues(Datalog &datalog, const Filters &filters, const uint8_t phase)
+{
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    datalog.sum_Isquared[phase] = l_sum_Isquared[phase];
+    l_sum_Isquared[phase] = 0;
+  }
+
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    datalog.DCoffset_I[phase] = filters.l_DCoffset_I[phase];
+  }
+}
+
+/**
+ * @brief Copies the optional diagnostics (ISR_TIMING_INSTRUMENTATION, SAMPLE_INTEGRITY_DIAGNOSTICS, MAINS_FREQUENCY_MEASUREMENT) for the main code, then resets them.
+ *
+ * @tparam Datalog The datalog type, whose optional members only exist when their feature is set (see shared_var.h)
+ * @param datalog The datalog being written
+ *
+ * @ingroup TimeCritical
+ */
+template< typename Datalog >
+void logDiagnostics(Datalog &datalog)
+{
+  if constexpr (ISR_TIMING_INSTRUMENTATION)
+  {
+    uint8_t i{ NO_OF_TIMED_SECTIONS };
+    do
+    {
+      --i;
+      isrTiming[i].copyAndReset(datalog.isrTiming[i]);
+    } while (i);
+  }
+
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    sampleIntegrity.copyAndReset(datalog.sampleIntegrity);
+  }
+
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    datalog.mainsPeriod = pll[0].isLocked() ? pll[0].getPeriod() : 0;
+  }
+}
+
 /**
  * @brief Process data logging at the end of each logging period.
  *
@@ -892,6 +1181,7 @@ void processLatestContribution(const uint8_t phase)
  * @details
  * - Copies cumulative power and voltage squared values for each phase.
  * - Copies load ON counts and other diagnostic variables.
+ * - Copies the execution times of the ISR when ISR_TIMING_INSTRUMENTATION is set.
  * - Resets variables for the next data logging period.
  * - Signals the main processor that logging data is available after the startup period.
  *
@@ -904,30 +1194,40 @@ void processDataLogging()
     return;  // data logging period not yet reached
   }
 
+  const ScopedTiming< TimedSections::DATALOGGING > timing;
+
   n_cycleCountForDatalogging = 0;
 
+  auto &datalog{ Shared::datalog.beginWrite() };
+
   uint8_t phase{ NO_OF_PHASES };
   do
   {
     --phase;
-    Shared::copyOf_sumP_atSupplyPoint[phase] = l_sumP_atSupplyPoint[phase];
+    datalog.sumP_atSupplyPoint[phase] = l_sumP_atSupplyPoint[phase];
     l_sumP_atSupplyPoint[phase] = 0;
 
-    Shared::copyOf_sum_Vsquared[phase] = l_sum_Vsquared[phase];
+    datalog.sum_Vsquared[phase] = l_sum_Vsquared[phase];
     l_sum_Vsquared[phase] = 0;
+
+    logCurrentValues(datalog, currentDCoffset, phase);
   } while (phase);
 
   uint8_t i{ NO_OF_DUMPLOADS };
   do
   {
     --i;
-    Shared::copyOf_countLoadON[i] = countLoadON[i];
+    datalog.countLoadON[i] = countLoadON[i];
     countLoadON[i] = 0;
   } while (i);
 
-  Shared::copyOf_sampleSetsDuringThisDatalogPeriod = i_sampleSetsDuringThisDatalogPeriod;  // (for diags only)
-  Shared::copyOf_lowestNoOfSampleSetsPerMainsCycle = n_lowestNoOfSampleSetsPerMainsCycle;  // (for diags only)
-  Shared::copyOf_energyInBucket_main = f_energyInBucket_main;                              // (for diags only)
+  datalog.sampleSetsDuringThisDatalogPeriod = i_sampleSetsDuringThisDatalogPeriod;  // (for diags only)
+  datalog.lowestNoOfSampleSetsPerMainsCycle = n_lowestNoOfSampleSetsPerMainsCycle;  // (for diags only)
+  datalog.energyInBucket_main = energyToFloat(f_energyInBucket_main);               // (for diags only)
+
+  logDiagnostics(datalog);
+
+  Shared::datalog.endWrite();
 
   n_lowestNoOfSampleSetsPerMainsCycle = UINT8_MAX;
   i_sampleSetsDuringThisDatalogPeriod = 0;
@@ -956,10 +1256,13 @@ void processDataLogging()
  */
 void processPlusHalfCycle(const uint8_t phase)
 {
+  const ScopedTiming< TimedSections::PLUS_HALF_CYCLE > timing;
+
   processLatestContribution(phase);  // runs at 6.6 ms intervals
 
   // A performance check to monitor and display the minimum number of sets of
-  // ADC samples per mains cycle, the expected number being 20ms / (104us * 6) = 32.05
+  // ADC samples per mains cycle, the expected number being NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE
+  // (20ms / (104us * 6) = 32.05 with the default free-running ADC)
   //
   if (0 == phase)
   {
@@ -967,6 +1270,10 @@ void processPlusHalfCycle(const uint8_t phase)
     {
       n_lowestNoOfSampleSetsPerMainsCycle = n_samplesDuringThisMainsCycle[phase];
     }
+    if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+    {
+      sampleIntegrity.recordMainsCycle(n_samplesDuringThisMainsCycle[phase]);
+    }
 
     processDataLogging();
   }
@@ -1064,6 +1371,70 @@ void processVoltageRawSample(const uint8_t phase, const int16_t rawSample)
   }
 }
 
+/**
+ * @brief Processes the blocks of raw samples handed over by the ISR (block processing mode).
+ *
+ * @details Called by the ISR when a block is full, it runs as a nested interrupt: interrupts are
+ *          enabled while the samples are processed, so that the next conversions are never delayed.
+ *          The ISR can interrupt this function and only stores the new samples into the other block.
+ *          If a block is handed over while this function is already running, it is picked up
+ *          by the running instance, the 'running' flag only being written by this function.
+ *
+ *          It is not run from loop(), which can be blocked for much longer than a block by the
+ *          serial output, and waits for the ISR when rotating the priorities.
+ *
+ *          The samples of a block are processed in the same order and with the same functions
+ *          as the ISR does in the default mode, the blocks being aligned on the sample sets.
+ *
+ * @ingroup TimeCritical
+ */
+void processSampleBlocks()
+{
+  static volatile bool running{ false };
+
+  if (running)
+  {
+    return;  // the running instance will process the new block
+  }
+  running = true;
+  sei();  // the next conversions can interrupt the processing
+
+  while (true)
+  {
+    const int16_t *block{ sampleBlocks.pendingBlock() };
+    if (!block)
+    {
+      running = false;
+      if (!sampleBlocks.pendingBlock())
+      {
+        return;  // a block handed over from now on is processed by a new instance
+      }
+      running = true;  // handed over while 'running' was still set, no other instance will process it
+      continue;
+    }
+
+    uint8_t sampleSet{ SAMPLE_SETS_PER_BLOCK };
+    do
+    {
+      --sampleSet;
+      for (const auto &step : adcSequence.steps)
+      {
+        if (step.voltage)
+        {
+          processVoltageRawSample(step.phase, *block);
+        }
+        else
+        {
+          processCurrentRawSample(step.phase, *block);
+        }
+        ++block;
+      }
+    } while (sampleSet);
+
+    sampleBlocks.release();
+  }
+}
+
 /**
  * @brief Print the settings used for the selected output mode.
  *
@@ -1081,10 +1452,16 @@ void printParamsForSelectedOutputMode()
 {
   // display relevant settings for selected output mode
   DBUG(F("Output mode:    "));
-  if (OutputModes::NORMAL == outputMode)
+  if (OutputModes::NORMAL == getOutputMode())
   {
     DBUGLN(F("normal"));
   }
+  else if (OutputModes::CYCLE_DISTRIBUTION == getOutputMode())
+  {
+    DBUGLN(F("cycle distribution"));
+    DBUG(F("\tf_energyPerDutyStep       = "));
+    DBUGLN(energyToFloat(f_energyPerDutyStep));
+  }
   else
   {
     DBUGLN(F("anti-flicker"));
@@ -1092,11 +1469,11 @@ void printParamsForSelectedOutputMode()
     DBUGLN(f_offsetOfEnergyThresholdsInAFmode);
   }
   DBUG(F("\tf_capacityOfEnergyBucket_main = "));
-  DBUGLN(f_capacityOfEnergyBucket_main);
+  DBUGLN(energyToFloat(f_capacityOfEnergyBucket_main));
   DBUG(F("\tf_lowerEnergyThreshold   = "));
-  DBUGLN(f_lowerThreshold_default);
+  DBUGLN(energyToFloat(getLowerThreshold()));
   DBUG(F("\tf_upperEnergyThreshold   = "));
-  DBUGLN(f_upperThreshold_default);
+  DBUGLN(energyToFloat(getUpperThreshold()));
 }
 
 /**
@@ -1105,8 +1482,8 @@ void printParamsForSelectedOutputMode()
  * @details An Interrupt Service Routine is now defined which instructs the ADC to perform a conversion
  *          for each of the voltage and current sensors in turn.
  *
- *          This Interrupt Service Routine is for use when the ADC is in the free-running mode.
- *          It is executed whenever an ADC conversion has finished, approx every 104 µs. In
+ *          It is executed whenever an ADC conversion has finished, every ADC_SAMPLE_PERIOD_CYCLES
+ *          CPU cycles (approx 104 µs with the default free-running ADC, see adc_timing.h). In
  *          free-running mode, the ADC has already started its next conversion by the time that
  *          the ISR is executed. The ISR therefore needs to "look ahead".
  *
@@ -1114,11 +1491,24 @@ void printParamsForSelectedOutputMode()
  *          which runs at this point therefore needs to capture the results of conversion Type N,
  *          and set up the conditions for conversion Type N+2, and so on.
  *
+ *          In Timer1-triggered mode, conversion Type N+1 only starts at the next compare match of
+ *          Timer1, so the ISR sets up the conditions for conversion Type N+1, and re-arms the trigger.
+ *
+ *          The sequence of the conversions, V1, I1, V2, I2, ... for NO_OF_PHASES phases, is built at
+ *          compile time from sensorV and sensorI (see adc_sequence.h).
+ *
  *          By means of various helper functions, all of the time-critical activities are processed
  *          within the ISR.
  *
+ *          When BLOCK_PROCESSING is set, the ISR only stores the samples into a double-buffered block
+ *          (see sample_block.h). Each full block is then processed by processSampleBlocks() with
+ *          interrupts enabled.
+ *
  *          The main code is notified by means of a flag when fresh copies of loggable data are available.
  *
+ *          When ISR_TIMING_INSTRUMENTATION is set, the execution time of the body of the ISR and of
+ *          its heavy branches is measured with Timer1 (see isr_timing.h).
+ *
  *          Keep in mind, when writing an Interrupt Service Routine (ISR):
  *            - Keep it short
  *            - Don't use delay()
@@ -1131,54 +1521,62 @@ void printParamsForSelectedOutputMode()
  */
 ISR(ADC_vect)
 {
-  static uint8_t sample_index{ 0 };
-  int16_t rawSample;
-
-  switch (sample_index)
-  {
-    case 0:
-      rawSample = ADC;                  // store the ADC value (this one is for Voltage L1)
-      ADMUX = bit(REFS0) + sensorV[1];  // the conversion for I1 is already under way
-      ++sample_index;                   // increment the control flag
-      //
-      processVoltageRawSample(0, rawSample);
-      break;
-    case 1:
-      rawSample = ADC;                  // store the ADC value (this one is for Current L1)
-      ADMUX = bit(REFS0) + sensorI[1];  // the conversion for V2 is already under way
-      ++sample_index;                   // increment the control flag
-      //
-      processCurrentRawSample(0, rawSample);
-      break;
-    case 2:
-      rawSample = ADC;                  // store the ADC value (this one is for Voltage L2)
-      ADMUX = bit(REFS0) + sensorV[2];  // the conversion for I2 is already under way
-      ++sample_index;                   // increment the control flag
-      //
-      processVoltageRawSample(1, rawSample);
-      break;
-    case 3:
-      rawSample = ADC;                  // store the ADC value (this one is for Current L2)
-      ADMUX = bit(REFS0) + sensorI[2];  // the conversion for V3 is already under way
-      ++sample_index;                   // increment the control flag
-      //
-      processCurrentRawSample(1, rawSample);
-      break;
-    case 4:
-      rawSample = ADC;                  // store the ADC value (this one is for Voltage L3)
-      ADMUX = bit(REFS0) + sensorV[0];  // the conversion for I3 is already under way
-      ++sample_index;                   // increment the control flag
-      //
-      processVoltageRawSample(2, rawSample);
-      break;
-    case 5:
-      rawSample = ADC;                  // store the ADC value (this one is for Current L3)
-      ADMUX = bit(REFS0) + sensorI[0];  // the conversion for V1 is already under way
-      sample_index = 0;                 // reset the control flag
-      //
-      processCurrentRawSample(2, rawSample);
-      break;
-    default:
-      sample_index = 0;  // to prevent lockup (should never get here)
+  bool blockReady{ false };  // block processing only
+
+  {
+    const ScopedTiming< TimedSections::ISR > timing;
+
+    if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS && !ADC_TIMER_TRIGGERED)
+    {
+      sampleIntegrity.recordMissedConversions(conversionSlots.skipped(HAL::readSampleClock()));  // overwritten while the ISR was held off
+    }
+
+    static uint8_t sample_index{ 0 };
+
+    const auto &step{ adcSequence.steps[sample_index] };
+
+    const int16_t rawSample{ HAL::readADC() };  // store the ADC value (V or I, for the phase of this step)
+    HAL::selectADCChannel(step.nextChannel);    // set up the conversion ADC_LOOK_AHEAD steps ahead
+
+    if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS && ADC_TIMER_TRIGGERED)
+    {
+      if (HAL::isTriggerLate())
+      {
+        sampleIntegrity.recordMissedConversions(1);  // the next compare match has passed, its slot has no conversion
+      }
+    }
+
+    HAL::acknowledgeADCTrigger();  // Timer1-triggered mode only, once the channel of the next conversion is selected
+
+    if (++sample_index == adcSequence.size)
+    {
+      sample_index = 0;  // reset the control flag at the end of each sample set
+    }
+
+    if constexpr (BLOCK_PROCESSING)
+    {
+      blockReady = sampleBlocks.store(rawSample);
+    }
+    else if (step.voltage)
+    {
+      processVoltageRawSample(step.phase, rawSample);
+    }
+    else
+    {
+      processCurrentRawSample(step.phase, rawSample);
+    }
+
+    if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+    {
+      if (HAL::isConversionPending())
+      {
+        sampleIntegrity.recordLateConversion();  // the next conversion has completed while processing this one
+      }
+    }
+  }
+
+  if (blockReady)
+  {
+    processSampleBlocks();  // with interrupts enabled, so not part of the timed section
   }
 }  // end of ISR
@@ -13,10 +13,18 @@
 #define PROCESSING_H
 
 #include "config.h"
+#include "adc_sequence.h"
+#include "adc_timing.h"
+#include "sample_block.h"
 
 // analogue input pins
 inline constexpr uint8_t sensorV[NO_OF_PHASES]{ 0, 2, 4 }; /**< for 3-phase PCB, voltage measurement for each phase */
 inline constexpr uint8_t sensorI[NO_OF_PHASES]{ 1, 3, 5 }; /**< for 3-phase PCB, current measurement for each phase */
+
+inline constexpr auto adcSequence{ makeAdcSequence(sensorV, sensorI, ADC_LOOK_AHEAD) }; /**< V1, I1, V2, I2, ... with look-ahead */
+
+inline constexpr uint8_t SAMPLE_SETS_PER_BLOCK{ 8 }; /**< block processing: a quarter of a mains cycle for 3 phases @ 50 Hz */
+inline SampleBlocks< SAMPLE_SETS_PER_BLOCK * adcSequence.size > sampleBlocks; /**< block processing: raw samples handed over by the ISR */
 // ------------------------------------------
 
 inline uint8_t loadPrioritiesAndState[NO_OF_DUMPLOADS]; /**< load priorities */
@@ -32,10 +40,13 @@ inline PayloadTx_struct< NO_OF_PHASES, temperatureSensing.size() > tx_data; /**<
 inline PayloadTx_struct< NO_OF_PHASES > tx_data; /**< logging data */
 #endif
 
+inline CurrentData_struct< NO_OF_PHASES > current_data; /**< logging data for the current measurements (CURRENT_RMS_MEASUREMENT) */
+
 void printParamsForSelectedOutputMode();
 
 void processCurrentRawSample(const uint8_t phase, const int16_t rawSample);
 void processVoltageRawSample(const uint8_t phase, const int16_t rawSample);
+void processSampleBlocks();
 
 #if defined(__DOXYGEN__)
 void initializeProcessing();
@@ -49,6 +60,9 @@ inline void processPolarity(uint8_t phase, int16_t rawSample);
 inline void confirmPolarity(uint8_t phase);
 inline void proceedLowEnergyLevel();
 inline void proceedHighEnergyLevel();
+inline void proceedEnergyThresholds();
+inline void proceedCycleDistribution();
+inline void proceedCycleStreaming();
 inline uint8_t nextLogicalLoadToBeAdded();
 inline uint8_t nextLogicalLoadToBeRemoved();
 inline void processLatestContribution(uint8_t phase);
@@ -67,6 +81,9 @@ inline void processPolarity(uint8_t phase, int16_t rawSample) __attribute__((alw
 inline void confirmPolarity(uint8_t phase) __attribute__((always_inline));
 inline void proceedLowEnergyLevel() __attribute__((always_inline));
 inline void proceedHighEnergyLevel() __attribute__((always_inline));
+inline void proceedEnergyThresholds() __attribute__((always_inline));
+inline void proceedCycleDistribution() __attribute__((always_inline));
+inline void proceedCycleStreaming() __attribute__((always_inline));
 inline uint8_t nextLogicalLoadToBeAdded() __attribute__((always_inline, optimize("-O3")));
 inline uint8_t nextLogicalLoadToBeRemoved() __attribute__((always_inline, optimize("-O3")));
 inline void processLatestContribution(uint8_t phase) __attribute__((always_inline));
@@ -0,0 +1,130 @@
+/**
+ * @file main.cpp
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Command-line front-end of the replay engine
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details Build and run with:
+ *            pio run -e replay
+ *            .pio/build/replay/program --profile day.txt --loads 2000,2000,2000 > day.csv
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "replay.h"
+
+namespace
+{
+void usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s (--csv FILE | --bin FILE | --profile FILE) [options]\n"
+          "  --csv FILE       recorded sample sets, one 'V1,I1,V2,I2,V3,I3' line per set ('-' for stdin)\n"
+          "  --bin FILE       recorded sample sets, little-endian 16-bit raw values\n"
+          "  --profile FILE   synthetic waveforms, one 'duration_s P1 P2 P3' line per segment (import = +ve)\n"
+          "  --loads W,W,...  power of each dump load for the synthetic waveforms (closed loop)\n"
+          "  --voltage V      RMS voltage for the synthetic waveforms (default 230)\n"
+          "  --cycles         also output one record per mains cycle\n"
+          "  --max N          stop after N sample sets\n",
+          name);
+}
+
+FILE* openInput(const char* path, const char* mode)
+{
+  if (0 == strcmp(path, "-"))
+  {
+    return stdin;
+  }
+
+  FILE* file{ fopen(path, mode) };
+  if (!file)
+  {
+    fprintf(stderr, "Cannot open '%s'\n", path);
+    exit(EXIT_FAILURE);
+  }
+  return file;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  const char* csvPath{ nullptr };
+  const char* binPath{ nullptr };
+  const char* profilePath{ nullptr };
+  const char* loads{ nullptr };
+  float voltage{ 230 };
+  bool withCycles{ false };
+  uint64_t maxSampleSets{ UINT64_MAX };
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool hasValue{ i + 1 < argc };
+
+    if (!strcmp(argv[i], "--csv") && hasValue) csvPath = argv[++i];
+    else if (!strcmp(argv[i], "--bin") && hasValue) binPath = argv[++i];
+    else if (!strcmp(argv[i], "--profile") && hasValue) profilePath = argv[++i];
+    else if (!strcmp(argv[i], "--loads") && hasValue) loads = argv[++i];
+    else if (!strcmp(argv[i], "--voltage") && hasValue) voltage = strtof(argv[++i], nullptr);
+    else if (!strcmp(argv[i], "--max") && hasValue) maxSampleSets = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--cycles")) withCycles = true;
+    else
+    {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!csvPath + !binPath + !profilePath != 2)
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Replay::CsvWriter writer{ stdout, withCycles };
+  writer.printHeader();
+
+  Replay::Summary summary;
+
+  if (csvPath)
+  {
+    Replay::CsvSampleSource source{ openInput(csvPath, "r") };
+    summary = Replay::run(source, writer, maxSampleSets);
+  }
+  else if (binPath)
+  {
+    Replay::BinarySampleSource source{ openInput(binPath, "rb") };
+    summary = Replay::run(source, writer, maxSampleSets);
+  }
+  else
+  {
+    std::vector< Replay::SyntheticSampleSource::Segment > profile;
+    if (!Replay::SyntheticSampleSource::parseProfile(openInput(profilePath, "r"), profile))
+    {
+      fprintf(stderr, "Malformed profile '%s'\n", profilePath);
+      return EXIT_FAILURE;
+    }
+
+    Replay::SyntheticSampleSource source{ profile };
+    source.setVoltage(voltage);
+
+    uint8_t load{ 0 };
+    for (const char* ptr = loads; ptr && *ptr; ++load)
+    {
+      char* end{ nullptr };
+      source.setLoadPower(load, strtof(ptr, &end));
+      ptr = (*end == ',') ? end + 1 : end;
+    }
+
+    summary = Replay::run(source, writer, maxSampleSets);
+  }
+
+  Replay::printSummary(stderr, summary);
+
+  return EXIT_SUCCESS;
+}
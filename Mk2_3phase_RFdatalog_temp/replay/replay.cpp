@@ -0,0 +1,490 @@
+/**
+ * @file replay.cpp
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native waveform replay engine for the processing engine
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "replay.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "calibration.h"
+#include "energy_bucket.h"
+#include "hal.h"
+#include "processing.h"
+#include "shared_var.h"
+
+extern energy_t f_energyInBucket_main;
+
+namespace Replay
+{
+namespace
+{
+constexpr uint8_t NO_POSITION{ 0xFF };
+
+SampleSource* currentSource{ nullptr };
+SampleSet currentSet{};
+bool sourceExhausted{ false };
+uint8_t positionInSet[8]{}; /**< analog input => position in the sample set */
+
+/**
+ * @brief Builds the mapping between the analog inputs and the positions in a sample set (V1,I1,V2,I2,...)
+ */
+void initPositions()
+{
+  for (auto& position : positionInSet)
+  {
+    position = NO_POSITION;
+  }
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    positionInSet[sensorV[phase]] = 2 * phase;
+    positionInSet[sensorI[phase]] = 2 * phase + 1;
+  }
+}
+
+/**
+ * @brief ADC source for the emulated ADC, a new sample set is fetched on each conversion of V1
+ */
+int16_t replaySample(const uint8_t channel)
+{
+  const auto position{ positionInSet[channel & 0x07] };
+
+  if (NO_POSITION == position)
+  {
+    return 512;
+  }
+
+  if (0 == position && !currentSource->next(currentSet))
+  {
+    sourceExhausted = true;
+  }
+
+  return currentSet.raw[position];
+}
+
+uint8_t loadsFromPins(const uint16_t pins)
+{
+  uint8_t loads{ 0 };
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    if (pins & bit(physicalLoadPin[i]))
+    {
+      loads |= bit(i);
+    }
+  }
+  return loads;
+}
+
+double emulatedTimeInSeconds()
+{
+  return HAL::Native::clockInMicroseconds * 1e-6;
+}
+
+/**
+ * @brief Same conversion as updatePowerAndVoltageData() in the main sketch
+ */
+void fillDatalogRecord(DatalogRecord& record)
+{
+  const auto sampleSets{ copyOf_datalog.sampleSetsDuringThisDatalogPeriod };
+
+  record.timeInSeconds = emulatedTimeInSeconds();
+  record.power = 0;
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    record.power_L[phase] = -static_cast< int16_t >(copyOf_datalog.sumP_atSupplyPoint[phase] / sampleSets * f_powerCal[phase]);
+    record.power += record.power_L[phase];
+
+    const float scale{ DATALOG_PERIOD_IN_SECONDS > 10 ? 4.0F : 1.0F };
+    record.Vrms_L[phase] = scale * f_voltageCal[phase] * sqrtf(static_cast< float >(copyOf_datalog.sum_Vsquared[phase] / sampleSets));
+  }
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    record.loadDutyInPercent[i] = copyOf_datalog.countLoadON[i] * 100 * invDATALOG_PERIOD_IN_MAINS_CYCLES;
+  }
+  record.energyInBucket = copyOf_datalog.energyInBucket_main;
+  record.sampleSets = sampleSets;
+  record.lowestNoOfSampleSetsPerMainsCycle = copyOf_datalog.lowestNoOfSampleSetsPerMainsCycle;
+}
+}
+
+CsvSampleSource::CsvSampleSource(FILE* file)
+  : file{ file }
+{
+}
+
+bool CsvSampleSource::next(SampleSet& set)
+{
+  char line[128];
+
+  while (fgets(line, sizeof(line), file))
+  {
+    char* ptr{ line };
+    while (*ptr == ' ' || *ptr == '\t') ++ptr;
+
+    if (*ptr == '#' || *ptr == '\n' || *ptr == '\r' || *ptr == '\0')
+    {
+      continue;
+    }
+
+    for (auto& raw : set.raw)
+    {
+      char* end{ nullptr };
+      raw = static_cast< int16_t >(strtol(ptr, &end, 10));
+      if (end == ptr)
+      {
+        return false;  // malformed line
+      }
+      ptr = end;
+      while (*ptr == ',' || *ptr == ';' || *ptr == ' ' || *ptr == '\t') ++ptr;
+    }
+    return true;
+  }
+  return false;
+}
+
+BinarySampleSource::BinarySampleSource(FILE* file)
+  : file{ file }
+{
+}
+
+bool BinarySampleSource::next(SampleSet& set)
+{
+  uint8_t bytes[2 * SAMPLES_PER_SET];
+
+  if (fread(bytes, sizeof(bytes), 1, file) != 1)
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < SAMPLES_PER_SET; ++i)
+  {
+    set.raw[i] = static_cast< int16_t >(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+  }
+  return true;
+}
+
+SyntheticSampleSource::SyntheticSampleSource(std::vector< Segment > profile)
+  : profile{ std::move(profile) }
+{
+}
+
+void SyntheticSampleSource::setLoadPower(const uint8_t load, const float watts)
+{
+  if (load < NO_OF_DUMPLOADS)
+  {
+    loadPower[load] = watts;
+  }
+}
+
+void SyntheticSampleSource::setVoltage(const float voltage)
+{
+  vrms = voltage;
+}
+
+bool SyntheticSampleSource::next(SampleSet& set)
+{
+  constexpr double twoPi{ 6.283185307179586 };
+
+  const double now{ emulatedTimeInSeconds() };
+
+  while (segment < profile.size() && now >= segmentStart + profile[segment].durationInSeconds)
+  {
+    segmentStart += profile[segment].durationInSeconds;
+    ++segment;
+  }
+  if (segment >= profile.size())
+  {
+    return false;
+  }
+
+  float power_L[NO_OF_PHASES];
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    power_L[phase] = profile[segment].power_L[phase];
+  }
+
+  // close the loop: loads switched ON by the router draw their power from the grid
+  const auto loadsON{ loadsFromPins(HAL::Native::pinsState) };
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    if (loadsON & bit(i))
+    {
+      power_L[i % NO_OF_PHASES] += loadPower[i];
+    }
+  }
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    const double Vrms_ADC{ vrms / f_voltageCal[phase] };
+    const double Irms_ADC{ power_L[phase] / (f_powerCal[phase] * Vrms_ADC) };
+
+    for (uint8_t k = 0; k < 2; ++k)
+    {
+      // each conversion takes place one conversion time after the previous one
+      const double t{ now + (2 * phase + k) * ADC_SAMPLE_PERIOD_CYCLES / static_cast< double >(F_CPU) };
+      const double s{ M_SQRT2 * sin(twoPi * SUPPLY_FREQUENCY * t - phase * twoPi / 3) };
+
+      // import = +ve, so the current is in anti-phase with the voltage
+      const double raw{ 0 == k ? 512 + Vrms_ADC * s : 512 - Irms_ADC * s };
+      set.raw[2 * phase + k] = static_cast< int16_t >(raw < 0 ? 0 : (raw > 1023 ? 1023 : lround(raw)));
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reads a profile, one segment per line: 'duration_s P1 P2 P3' (import = +ve), '#' starts a comment
+ *
+ * @param file The profile file
+ * @param profile The segments read
+ * @return false if a line is malformed
+ */
+bool SyntheticSampleSource::parseProfile(FILE* file, std::vector< Segment >& profile)
+{
+  char line[256];
+
+  while (fgets(line, sizeof(line), file))
+  {
+    char* ptr{ line };
+    while (*ptr == ' ' || *ptr == '\t') ++ptr;
+
+    if (*ptr == '#' || *ptr == '\n' || *ptr == '\r' || *ptr == '\0')
+    {
+      continue;
+    }
+
+    Segment segment;
+    char* end{ nullptr };
+
+    segment.durationInSeconds = strtod(ptr, &end);
+    if (end == ptr)
+    {
+      return false;
+    }
+    ptr = end;
+
+    for (auto& power : segment.power_L)
+    {
+      power = strtof(ptr, &end);
+      if (end == ptr)
+      {
+        return false;
+      }
+      ptr = end;
+    }
+    profile.push_back(segment);
+  }
+  return true;
+}
+
+CsvWriter::CsvWriter(FILE* file, const bool withCycles)
+  : file{ file }, withCycles{ withCycles }
+{
+}
+
+void CsvWriter::printHeader() const
+{
+  if (withCycles)
+  {
+    fprintf(file, "# C,cycle,time_s,bucket,loadPins,loadsON\n");
+  }
+
+  fprintf(file, "# D,time_s,P");
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    fprintf(file, ",P%u", phase + 1);
+  }
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    fprintf(file, ",V%u", phase + 1);
+  }
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    fprintf(file, ",D%u", i + 1);
+  }
+  fprintf(file, ",bucket,S,S_MC\n");
+}
+
+void CsvWriter::onCycle(const CycleRecord& record)
+{
+  if (withCycles)
+  {
+    fprintf(file, "C,%u,%.4f,%.1f,0x%04X,0x%02X\n", record.cycle, record.timeInSeconds, record.energyInBucket, record.loadPins, record.loadsON);
+  }
+}
+
+void CsvWriter::onDatalog(const DatalogRecord& record)
+{
+  fprintf(file, "D,%.3f,%d", record.timeInSeconds, record.power);
+  for (const auto power : record.power_L)
+  {
+    fprintf(file, ",%d", power);
+  }
+  for (const auto voltage : record.Vrms_L)
+  {
+    fprintf(file, ",%.2f", voltage);
+  }
+  for (const auto duty : record.loadDutyInPercent)
+  {
+    fprintf(file, ",%.1f", duty);
+  }
+  fprintf(file, ",%.1f,%u,%u\n", record.energyInBucket, record.sampleSets, record.lowestNoOfSampleSetsPerMainsCycle);
+}
+
+/**
+ * @brief Replays all the sample sets of a source through the ISR.
+ *
+ * @details The processing engine is (re-)initialized, then for each sample set one conversion per
+ *          analog input is emulated. As for the main sketch, the first (incomplete) datalogging
+ *          period is skipped.
+ *
+ * @note The state of the processing engine lives in globals, so only one replay per process is meaningful.
+ *
+ * @param source The sample sets
+ * @param observer Receives the per-cycle and per-datalog records
+ * @param maxSampleSets Optional limit of sample sets to replay
+ * @return Summary The totals over the replay
+ */
+Summary run(SampleSource& source, Observer& observer, const uint64_t maxSampleSets)
+{
+  Summary summary;
+  CycleRecord cycle;
+  DatalogRecord datalog;
+  bool firstDatalog{ true };
+
+  initPositions();
+  currentSource = &source;
+  sourceExhausted = false;
+
+  HAL::Native::reset();
+  HAL::Native::setADCSource(replaySample);
+  initializeProcessing();
+
+  auto pinsWriteCount{ HAL::Native::pinsWriteCount };
+  uint8_t previousLoadsON{ 0 };
+  uint32_t run[NO_OF_DUMPLOADS]{};  // cycles since the last switch of each load, 0 before the first one
+
+  const auto start{ std::chrono::steady_clock::now() };
+
+  while (summary.sampleSets < maxSampleSets)
+  {
+    HAL::Native::runADCConversions(SAMPLES_PER_SET);
+
+    if (sourceExhausted)
+    {
+      break;
+    }
+    ++summary.sampleSets;
+
+    // the load pins are written once per mains cycle, right after the load decisions
+    if (pinsWriteCount != HAL::Native::pinsWriteCount)
+    {
+      pinsWriteCount = HAL::Native::pinsWriteCount;
+
+      cycle.timeInSeconds = emulatedTimeInSeconds();
+      cycle.energyInBucket = energyToFloat(f_energyInBucket_main);
+      cycle.loadPins = HAL::Native::pinsState;
+      cycle.loadsON = loadsFromPins(cycle.loadPins);
+
+      for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+      {
+        if (cycle.loadsON & bit(i))
+        {
+          ++summary.loadCyclesON[i];
+        }
+        if ((cycle.loadsON ^ previousLoadsON) & bit(i))
+        {
+          ++summary.loadSwitches[i];
+
+          // the run which has just ended is bounded on both sides
+          auto& longest{ (previousLoadsON & bit(i)) ? summary.longestBurstON[i] : summary.longestBurstOFF[i] };
+          if (run[i] > longest)
+          {
+            longest = run[i];
+          }
+          run[i] = 1;
+        }
+        else if (run[i])
+        {
+          ++run[i];
+        }
+      }
+      previousLoadsON = cycle.loadsON;
+
+      observer.onCycle(cycle);
+
+      ++cycle.cycle;
+      ++summary.cycles;
+    }
+
+    if (Shared::b_datalogEventPending)
+    {
+      Shared::b_datalogEventPending = false;
+      Shared::datalog.read(copyOf_datalog);
+
+      if (firstDatalog)
+      {
+        firstDatalog = false;  // reject the first datalogging which is incomplete !
+        continue;
+      }
+
+      fillDatalogRecord(datalog);
+
+      constexpr double hoursPerDatalog{ DATALOG_PERIOD_IN_SECONDS / 3600.0 };
+      if (datalog.power > 0)
+      {
+        summary.importInWh += datalog.power * hoursPerDatalog;
+      }
+      else
+      {
+        summary.exportInWh -= datalog.power * hoursPerDatalog;
+      }
+      ++summary.datalogs;
+
+      observer.onDatalog(datalog);
+    }
+  }
+
+  const std::chrono::duration< double > elapsed{ std::chrono::steady_clock::now() - start };
+  summary.elapsedInSeconds = elapsed.count();
+
+  currentSource = nullptr;
+
+  return summary;
+}
+
+void printSummary(FILE* file, const Summary& summary)
+{
+  const double emulated{ emulatedTimeInSeconds() };
+
+  fprintf(file, "Replayed %.1f s (%llu sample sets, %u mains cycles, %u datalogs) in %.2f s => %.0fx real time\n",
+          emulated, static_cast< unsigned long long >(summary.sampleSets), summary.cycles, summary.datalogs,
+          summary.elapsedInSeconds, summary.elapsedInSeconds > 0 ? emulated / summary.elapsedInSeconds : 0.0);
+  fprintf(file, "Import: %.1f Wh, export: %.1f Wh\n", summary.importInWh, summary.exportInWh);
+  if constexpr (OutputModes::CYCLE_DISTRIBUTION == outputMode)
+  {
+    fprintf(file, "Output mode: cycle distribution\n");
+  }
+  else
+  {
+    fprintf(file, "Output mode: energy thresholds\n");
+  }
+
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    fprintf(file, "Load #%u: ON %.1f %% of the cycles, %u switches, longest bursts %u ON / %u OFF\n", i + 1,
+            summary.cycles ? 100.0 * summary.loadCyclesON[i] / summary.cycles : 0.0, summary.loadSwitches[i],
+            summary.longestBurstON[i], summary.longestBurstOFF[i]);
+  }
+}
+}
@@ -0,0 +1,195 @@
+/**
+ * @file replay.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Native waveform replay engine for the processing engine
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details Streams recorded or synthetic sample sets through the emulated free-running ADC
+ *          and the real ISR(ADC_vect), so the exact same code as on the Arduino processes them.
+ *          A sample set holds one value per analog input, in the conversion order of the ISR,
+ *          i.e. V1,I1,V2,I2,V3,I3 for 3 phases.
+ *
+ *          The engine reports:
+ *          - one CycleRecord per mains cycle (energy bucket after the load decisions, load pins),
+ *          - one DatalogRecord per datalogging period (same values as sent by the telemetry).
+ *
+ *          This is a host-only tool, hence the use of the standard library.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace Replay
+{
+inline constexpr uint8_t SAMPLES_PER_SET{ 2 * NO_OF_PHASES }; /**< V and I for each phase */
+
+/** @brief One raw value per analog input, in the ISR conversion order (V1,I1,V2,I2,...) */
+struct SampleSet
+{
+  int16_t raw[SAMPLES_PER_SET]{};
+};
+
+/** @brief State of the router right after the load decisions of a mains cycle */
+struct CycleRecord
+{
+  uint32_t cycle{ 0 };         /**< mains cycle number since the beginning of the replay */
+  double timeInSeconds{ 0 };   /**< emulated time */
+  float energyInBucket{ 0 };   /**< f_energyInBucket_main, in Joules * SUPPLY_FREQUENCY */
+  uint16_t loadPins{ 0 };      /**< state of the load pins */
+  uint8_t loadsON{ 0 };        /**< bitmask of the physical loads which are ON */
+};
+
+/** @brief Snapshot of a datalogging period, as published by the telemetry */
+struct DatalogRecord
+{
+  double timeInSeconds{ 0 };                       /**< emulated time */
+  int32_t power{ 0 };                              /**< total power, import = +ve */
+  int32_t power_L[NO_OF_PHASES]{};                 /**< power per phase, import = +ve */
+  float Vrms_L[NO_OF_PHASES]{};                    /**< RMS voltage per phase */
+  float loadDutyInPercent[NO_OF_DUMPLOADS]{};      /**< share of the period each load was ON */
+  float energyInBucket{ 0 };                       /**< copy of the energy bucket */
+  uint16_t sampleSets{ 0 };                        /**< sample sets during the period */
+  uint8_t lowestNoOfSampleSetsPerMainsCycle{ 0 };  /**< integrity check */
+};
+
+/** @brief Totals over the whole replay */
+struct Summary
+{
+  uint64_t sampleSets{ 0 };                     /**< sample sets processed */
+  uint32_t cycles{ 0 };                         /**< mains cycles */
+  uint32_t datalogs{ 0 };                       /**< datalogging periods */
+  double importInWh{ 0 };                       /**< energy imported, from the datalog snapshots */
+  double exportInWh{ 0 };                       /**< energy exported, from the datalog snapshots */
+  uint32_t loadSwitches[NO_OF_DUMPLOADS]{};     /**< number of ON/OFF transitions per load */
+  uint32_t loadCyclesON[NO_OF_DUMPLOADS]{};     /**< number of mains cycles each load was ON */
+  uint32_t longestBurstON[NO_OF_DUMPLOADS]{};   /**< longest run of ON cycles between two OFF cycles (flicker) */
+  uint32_t longestBurstOFF[NO_OF_DUMPLOADS]{};  /**< longest run of OFF cycles between two ON cycles (flicker) */
+  double elapsedInSeconds{ 0 };                 /**< host time */
+};
+
+/**
+ * @brief Provides sample sets to the engine
+ *
+ */
+class SampleSource
+{
+public:
+  virtual ~SampleSource() = default;
+
+  /**
+   * @brief Fetch the next sample set
+   *
+   * @param set The set to fill
+   * @return false when the source is exhausted
+   */
+  virtual bool next(SampleSet& set) = 0;
+};
+
+/**
+ * @brief Recorded sample sets, one per line: 'V1,I1,V2,I2,V3,I3' (raw ADC values), '#' starts a comment
+ *
+ */
+class CsvSampleSource : public SampleSource
+{
+public:
+  explicit CsvSampleSource(FILE* file);
+  bool next(SampleSet& set) override;
+
+private:
+  FILE* file;
+};
+
+/**
+ * @brief Recorded sample sets as little-endian 16-bit raw values, SAMPLES_PER_SET per set
+ *
+ */
+class BinarySampleSource : public SampleSource
+{
+public:
+  explicit BinarySampleSource(FILE* file);
+  bool next(SampleSet& set) override;
+
+private:
+  FILE* file;
+};
+
+/**
+ * @brief Synthetic sinusoidal waveforms following a power profile
+ *
+ * @details The profile is a list of segments, each holding a duration and the grid power of each phase
+ *          (import = +ve) when all loads are OFF. When a load is switched ON by the router, its power is
+ *          added to the phase it is wired to (load #n on phase n % NO_OF_PHASES), so the control loop is closed.
+ */
+class SyntheticSampleSource : public SampleSource
+{
+public:
+  struct Segment
+  {
+    double durationInSeconds{ 0 };
+    float power_L[NO_OF_PHASES]{};
+  };
+
+  explicit SyntheticSampleSource(std::vector< Segment > profile);
+  bool next(SampleSet& set) override;
+
+  void setLoadPower(uint8_t load, float watts);
+  void setVoltage(float vrms);
+
+  static bool parseProfile(FILE* file, std::vector< Segment >& profile);
+
+private:
+  std::vector< Segment > profile;
+  size_t segment{ 0 };
+  double segmentStart{ 0 };
+  float loadPower[NO_OF_DUMPLOADS]{};
+  float vrms{ 230 };
+};
+
+/**
+ * @brief Receives the records produced during the replay
+ *
+ */
+class Observer
+{
+public:
+  virtual ~Observer() = default;
+
+  virtual void onCycle(const CycleRecord& /*record*/) {}
+  virtual void onDatalog(const DatalogRecord& /*record*/) {}
+};
+
+/**
+ * @brief Writes the records as CSV lines ('C,...' per cycle, 'D,...' per datalog)
+ *
+ */
+class CsvWriter : public Observer
+{
+public:
+  CsvWriter(FILE* file, bool withCycles);
+
+  void printHeader() const;
+  void onCycle(const CycleRecord& record) override;
+  void onDatalog(const DatalogRecord& record) override;
+
+private:
+  FILE* file;
+  bool withCycles;
+};
+
+Summary run(SampleSource& source, Observer& observer, uint64_t maxSampleSets = UINT64_MAX);
+
+void printSummary(FILE* file, const Summary& summary);
+}
+
+#endif /* REPLAY_H */
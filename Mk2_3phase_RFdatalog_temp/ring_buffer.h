@@ -0,0 +1,127 @@
+/**
+ * @file ring_buffer.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Lock-free ring buffer with a single producer and a single consumer
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The producer only writes the head, the consumer only writes the tail. Both are free-running
+ *          8-bit counters, so the number of elements is always 'head - tail', and the capacity is a
+ *          power of two, so the index of an element is a simple mask.
+ *          The producer can be the ISR and the consumer the main loop, or the other way around:
+ *          none of them disables the interrupts.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <Arduino.h>
+
+#include "compiler_barrier.h"
+
+/**
+ * @brief Ring buffer of N elements of type T
+ *
+ * @tparam T Type of the elements
+ * @tparam N Capacity, a power of two [2..128]
+ */
+template< typename T, uint8_t N >
+class RingBuffer
+{
+  static_assert(N >= 2 && N <= 128 && !(N & (N - 1)), "******** The capacity of a ring buffer must be a power of two in [2..128] ! ********");
+
+public:
+  static constexpr uint8_t CAPACITY{ N }; /**< capacity of the buffer */
+
+  /**
+   * @brief Adds an element, producer side.
+   *
+   * @param element The element
+   * @return false if the buffer is full, the element being dropped
+   */
+  bool push(const T& element)
+  {
+    const uint8_t h{ head };
+    if (static_cast< uint8_t >(h - tail) == N)
+    {
+      return false;
+    }
+
+    buffer[h & (N - 1)] = element;
+    compilerBarrier();
+    head = h + 1;
+    return true;
+  }
+
+  /**
+   * @brief Removes the oldest element, consumer side.
+   *
+   * @param element The element
+   * @return false if the buffer is empty
+   */
+  bool pop(T& element)
+  {
+    const uint8_t t{ tail };
+    if (t == head)
+    {
+      return false;
+    }
+
+    element = buffer[t & (N - 1)];
+    compilerBarrier();
+    tail = t + 1;
+    return true;
+  }
+
+  /**
+   * @brief Oldest element, consumer side, to be removed with pop() or drop().
+   *
+   * @return The element, undefined if the buffer is empty
+   */
+  const T& front() const
+  {
+    return buffer[tail & (N - 1)];
+  }
+
+  /**
+   * @brief Removes the oldest element, consumer side.
+   *
+   */
+  void drop()
+  {
+    if (tail != head)
+    {
+      compilerBarrier();
+      tail = tail + 1;
+    }
+  }
+
+  /**
+   * @brief Number of elements in the buffer.
+   *
+   * @return The number of elements
+   */
+  uint8_t size() const
+  {
+    return static_cast< uint8_t >(head - tail);
+  }
+
+  /**
+   * @brief Whether the buffer is empty.
+   *
+   */
+  bool isEmpty() const
+  {
+    return head == tail;
+  }
+
+private:
+  T buffer[N]{};              /**< the elements */
+  volatile uint8_t head{ 0 }; /**< number of elements pushed, written by the producer only */
+  volatile uint8_t tail{ 0 }; /**< number of elements popped, written by the consumer only */
+};
+
+#endif /* RING_BUFFER_H */
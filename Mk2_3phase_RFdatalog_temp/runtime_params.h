@@ -0,0 +1,347 @@
+/**
+ * @file runtime_params.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Output mode and diversion thresholds, fixed at compile time or adjustable at run time
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details By default, the output mode, the energy thresholds, the export rate and the diversion
+ *          start threshold are constexpr, and the getters below fold into constants.
+ *
+ *          When RUNTIME_PARAMETERS is set (see config.h), they are stored in EEPROM (see utils_params.h),
+ *          loaded at start-up, and can be changed live with serial commands. The values used by the ISR
+ *          are then converted once to the representation of the energy bucket, and grouped in a single
+ *          struct, so that the ISR only pays for a few loads from RAM.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef RUNTIME_PARAMS_H
+#define RUNTIME_PARAMS_H
+
+#include <Arduino.h>
+#include <ctype.h>
+
+#include "config.h"
+#include "energy_bucket.h"
+
+/**< threshold in anti-flicker mode - must not exceed 0.4 */
+inline constexpr float f_offsetOfEnergyThresholdsInAFmode{ 0.1F };
+
+/**
+ * @brief Default threshold of an output mode, in percent of the working zone
+ *
+ * @param mode The output mode
+ * @param lower True to get the lower threshold, false for higher
+ * @return the corresponding threshold
+ */
+constexpr uint8_t defaultThresholdInPercent(const OutputModes mode, const bool lower)
+{
+  return static_cast< uint8_t >(100.0F * (lower
+                                            ? 0.5F - ((OutputModes::ANTI_FLICKER == mode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F)
+                                            : 0.5F + ((OutputModes::ANTI_FLICKER == mode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F))
+                                + 0.5F);
+}
+
+/**
+ * @brief Converts a threshold in percent of the working zone to the representation of the energy bucket
+ *
+ * @param percent The threshold in percent
+ * @return the threshold
+ */
+constexpr energy_t thresholdFromPercent(const uint8_t percent)
+{
+  return toEnergy(WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY * 0.01F * percent);
+}
+
+/**
+ * @brief set default threshold at compile time so the variable can be read-only
+ *
+ * @param lower True to set the lower threshold, false for higher
+ * @return the corresponding threshold
+ */
+constexpr auto initThreshold(const bool lower)
+{
+  return toEnergy(lower
+                    ? WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY * (0.5F - ((OutputModes::ANTI_FLICKER == outputMode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F))
+                    : WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY * (0.5F + ((OutputModes::ANTI_FLICKER == outputMode) ? f_offsetOfEnergyThresholdsInAFmode : 0.0F)));
+}
+
+inline constexpr energy_t f_lowerThreshold_default{ initThreshold(true) };  /**< lower default threshold set accordingly to the output mode */
+inline constexpr energy_t f_upperThreshold_default{ initThreshold(false) }; /**< upper default threshold set accordingly to the output mode */
+
+inline constexpr uint8_t RUNTIME_PARAMS_VERSION{ 1 }; /**< to be incremented whenever the layout of StoredParams changes */
+
+/**
+ * @brief Parameters as stored in EEPROM and changed by the serial commands
+ *
+ */
+struct StoredParams
+{
+  uint8_t version{ RUNTIME_PARAMS_VERSION };                                                  /**< layout of the block */
+  OutputModes outputMode{ ::outputMode };                                                     /**< output mode */
+  uint8_t lowerThresholdInPercent{ defaultThresholdInPercent(::outputMode, true) };           /**< lower energy threshold, in percent of the working zone [0..50] */
+  uint8_t upperThresholdInPercent{ defaultThresholdInPercent(::outputMode, false) };          /**< upper energy threshold, in percent of the working zone [50..100] */
+  int16_t requiredExportInWatts{ REQUIRED_EXPORT_IN_WATTS };                                  /**< export rate, negative to act as a generator */
+  int16_t diversionStartThresholdInWatts{ DIVERSION_START_THRESHOLD_WATTS };                  /**< surplus needed to start the diversion */
+  uint8_t checksum{ 0 };                                                                      /**< see paramsChecksum() */
+};
+
+/**
+ * @brief Values read by the ISR, in the representation of the energy bucket
+ *
+ */
+struct RuntimeParams
+{
+  energy_t lowerThreshold;          /**< lower energy threshold */
+  energy_t upperThreshold;          /**< upper energy threshold */
+  energy_t requiredExport;          /**< export rate, per mains cycle */
+  energy_t diversionStartThreshold; /**< surplus needed to start the diversion, per mains cycle */
+  OutputModes outputMode;           /**< output mode */
+};
+
+/**
+ * @brief Checksum of a parameter block, all bytes but the checksum itself
+ *
+ * @param params The parameters
+ * @return The checksum
+ */
+inline uint8_t paramsChecksum(const StoredParams &params)
+{
+  const auto *bytes{ reinterpret_cast< const uint8_t * >(&params) };
+  uint8_t sum{ 0x5A };
+
+  for (uint8_t i = 0; i < offsetof(StoredParams, checksum); ++i)
+  {
+    sum = static_cast< uint8_t >((sum << 1) | (sum >> 7)) ^ bytes[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief Whether a parameter block holds consistent values
+ *
+ * @param params The parameters
+ * @return true if the block can be used
+ */
+inline bool areParamsValid(const StoredParams &params)
+{
+  return params.version == RUNTIME_PARAMS_VERSION
+         && params.checksum == paramsChecksum(params)
+         && params.outputMode <= OutputModes::CYCLE_DISTRIBUTION
+         && params.lowerThresholdInPercent <= 50
+         && params.upperThresholdInPercent >= 50
+         && params.upperThresholdInPercent <= 100
+         && params.diversionStartThresholdInWatts >= 0;
+}
+
+/**
+ * @brief Converts the stored parameters for the ISR
+ *
+ * @param params The parameters
+ * @return The values read by the ISR
+ */
+constexpr RuntimeParams makeRuntimeParams(const StoredParams &params)
+{
+  return { thresholdFromPercent(params.lowerThresholdInPercent),
+           thresholdFromPercent(params.upperThresholdInPercent),
+           toEnergy(params.requiredExportInWatts),
+           toEnergy(params.diversionStartThresholdInWatts),
+           params.outputMode };
+}
+
+inline RuntimeParams runtimeParams{ makeRuntimeParams(StoredParams{}) }; /**< values read by the ISR when RUNTIME_PARAMETERS is set */
+
+/**
+ * @brief Applies new parameters, atomically for the ISR
+ *
+ * @param params The parameters
+ */
+inline void applyRuntimeParams(const StoredParams &params)
+{
+  const auto values{ makeRuntimeParams(params) };
+
+  cli();
+  runtimeParams = values;
+  sei();
+}
+
+/**
+ * @brief Parses and applies a serial command to a parameter block
+ *
+ * @details One command per line, a letter followed by a value:
+ *          - 'M N', 'M A' or 'M C': output mode normal, anti-flicker or cycle distribution,
+ *            the thresholds being reset to the defaults of the mode,
+ *          - 'L <percent>' / 'U <percent>': lower/upper energy threshold, in percent of the working zone,
+ *          - 'E <watts>': export rate, negative to act as a generator,
+ *          - 'S <watts>': surplus needed to start the diversion,
+ *          - 'D': defaults of the build.
+ *
+ *          The checksum is updated on success. On failure, the block is left unchanged.
+ *
+ * @param line The command, null-terminated
+ * @param params The parameters to update
+ * @return true if the command was valid
+ */
+inline bool parseParamsCommand(const char *line, StoredParams &params)
+{
+  StoredParams updated{ params };
+
+  const char command{ static_cast< char >(toupper(line[0])) };
+  const char *arg{ line + 1 };
+  while (*arg == ' ')
+  {
+    ++arg;
+  }
+
+  char *end{ nullptr };
+  const long value{ strtol(arg, &end, 10) };
+  const bool hasNumber{ end != arg && *end == '\0' };
+
+  switch (command)
+  {
+    case 'M':
+      switch (toupper(arg[0]))
+      {
+        case 'N':
+          updated.outputMode = OutputModes::NORMAL;
+          break;
+        case 'A':
+          updated.outputMode = OutputModes::ANTI_FLICKER;
+          break;
+        case 'C':
+          updated.outputMode = OutputModes::CYCLE_DISTRIBUTION;
+          break;
+        default:
+          return false;
+      }
+      updated.lowerThresholdInPercent = defaultThresholdInPercent(updated.outputMode, true);
+      updated.upperThresholdInPercent = defaultThresholdInPercent(updated.outputMode, false);
+      break;
+    case 'L':
+      if (!hasNumber || value < 0 || value > 50)
+      {
+        return false;
+      }
+      updated.lowerThresholdInPercent = static_cast< uint8_t >(value);
+      break;
+    case 'U':
+      if (!hasNumber || value < 50 || value > 100)
+      {
+        return false;
+      }
+      updated.upperThresholdInPercent = static_cast< uint8_t >(value);
+      break;
+    case 'E':
+      if (!hasNumber || value < INT16_MIN || value > INT16_MAX)
+      {
+        return false;
+      }
+      updated.requiredExportInWatts = static_cast< int16_t >(value);
+      break;
+    case 'S':
+      if (!hasNumber || value < 0 || value > INT16_MAX)
+      {
+        return false;
+      }
+      updated.diversionStartThresholdInWatts = static_cast< int16_t >(value);
+      break;
+    case 'D':
+      updated = StoredParams{};
+      break;
+    default:
+      return false;
+  }
+
+  updated.checksum = paramsChecksum(updated);
+  params = updated;
+  return true;
+}
+
+/**
+ * @brief Output mode in use
+ *
+ * @ingroup TimeCritical
+ */
+inline OutputModes getOutputMode()
+{
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    return runtimeParams.outputMode;
+  }
+  else
+  {
+    return outputMode;
+  }
+}
+
+/**
+ * @brief Lower energy threshold in use
+ *
+ * @ingroup TimeCritical
+ */
+inline energy_t getLowerThreshold()
+{
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    return runtimeParams.lowerThreshold;
+  }
+  else
+  {
+    return f_lowerThreshold_default;
+  }
+}
+
+/**
+ * @brief Upper energy threshold in use
+ *
+ * @ingroup TimeCritical
+ */
+inline energy_t getUpperThreshold()
+{
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    return runtimeParams.upperThreshold;
+  }
+  else
+  {
+    return f_upperThreshold_default;
+  }
+}
+
+/**
+ * @brief Export rate in use, per mains cycle
+ *
+ * @ingroup TimeCritical
+ */
+inline energy_t getRequiredExport()
+{
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    return runtimeParams.requiredExport;
+  }
+  else
+  {
+    return toEnergy(REQUIRED_EXPORT_IN_WATTS);
+  }
+}
+
+/**
+ * @brief Surplus needed to start the diversion in use, per mains cycle
+ *
+ * @ingroup TimeCritical
+ */
+inline energy_t getDiversionStartThreshold()
+{
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    return runtimeParams.diversionStartThreshold;
+  }
+  else
+  {
+    return toEnergy(DIVERSION_START_THRESHOLD_WATTS);
+  }
+}
+
+#endif /* RUNTIME_PARAMS_H */
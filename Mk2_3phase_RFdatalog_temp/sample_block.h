@@ -0,0 +1,112 @@
+/**
+ * @file sample_block.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Double-buffered blocks of raw ADC samples, for the block processing mode
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When BLOCK_PROCESSING is set (see config.h), the ADC ISR only stores each raw
+ *          sample into the block being filled. When a block is full, it is handed over to the
+ *          batch stage and the ISR goes on with the other block.
+ *
+ *          The hand-off has a single producer (the ISR) and a single consumer (the batch stage),
+ *          and never disables the interrupts. Each side only ever writes its own transition of the
+ *          one-byte 'pending' index, which is atomic on AVR:
+ *          - the producer sets it from NO_BLOCK to the block it has just filled,
+ *          - the consumer sets it back to NO_BLOCK once the block has been processed.
+ *
+ *          If a block is full while the previous one is still pending, it is dropped and
+ *          filled again, and the overrun is counted.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef SAMPLE_BLOCK_H
+#define SAMPLE_BLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Two blocks of raw samples, one being filled by the ISR, the other being processed
+ *
+ * @tparam N Number of raw samples per block
+ */
+template< uint8_t N >
+class SampleBlocks
+{
+public:
+  static constexpr uint8_t NO_BLOCK{ UINT8_MAX }; /**< no block pending */
+
+  /**
+   * @brief Stores a raw sample into the block being filled (producer side).
+   *
+   * @param rawSample The raw sample
+   * @return true if a block has just been handed over to the batch stage
+   *
+   * @ingroup TimeCritical
+   */
+  bool store(const int16_t rawSample)
+  {
+    samples[filling][index] = rawSample;
+
+    if (++index != N)
+    {
+      return false;
+    }
+    index = 0;
+
+    if (NO_BLOCK != pending)
+    {
+      // the batch stage did not keep up, the block is dropped and refilled
+      if (overruns != UINT16_MAX)
+      {
+        ++overruns;
+      }
+      return false;
+    }
+
+    pending = filling;
+    filling ^= 1;
+    return true;
+  }
+
+  /**
+   * @brief Returns the block handed over to the batch stage (consumer side).
+   *
+   * @return The raw samples of the pending block, or nullptr if none
+   */
+  const int16_t *pendingBlock() const
+  {
+    const uint8_t block{ pending };
+
+    return (NO_BLOCK == block) ? nullptr : samples[block];
+  }
+
+  /**
+   * @brief Gives the pending block back to the producer, once processed (consumer side).
+   *
+   */
+  void release()
+  {
+    pending = NO_BLOCK;
+  }
+
+  /**
+   * @brief Number of blocks dropped because the batch stage did not keep up
+   *
+   */
+  uint16_t getOverruns() const
+  {
+    return overruns;
+  }
+
+private:
+  int16_t samples[2][N]{};              /**< the two blocks */
+  uint8_t filling{ 0 };                 /**< block being filled by the producer */
+  uint8_t index{ 0 };                   /**< next position in the block being filled */
+  volatile uint8_t pending{ NO_BLOCK }; /**< block waiting for the batch stage */
+  volatile uint16_t overruns{ 0 };      /**< number of dropped blocks */
+};
+
+#endif /* SAMPLE_BLOCK_H */
@@ -0,0 +1,169 @@
+/**
+ * @file sample_integrity.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Detection of missed and late ADC conversions, histogram of the sample sets per mains cycle
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When SAMPLE_INTEGRITY_DIAGNOSTICS is set (see config.h):
+ *          - missed conversions: in free-running mode, the ISR timestamps each of its runs with Timer1
+ *            running freely. The interrupt flag of the ADC (ADIF) being cleared when the ISR is entered,
+ *            a conversion overwritten before the ISR could run leaves no other trace: a gap of 2 sample
+ *            periods or more between two runs shows it. The channel sequence is then shifted by one step.
+ *            In Timer1-triggered mode, a conversion is lost when the ISR re-arms the trigger after the
+ *            next compare match (see HAL::isTriggerLate()),
+ *          - late conversions: if ADIF is set at the exit of the ISR, the next conversion has completed
+ *            while the ISR was running: the ISR has used more than its slot.
+ *
+ *          Late conversions are harmless while they remain occasional, missed ones are not.
+ *          Both are counted over each datalogging period, as well as the number of sample sets
+ *          of each mains cycle, so that a configuration starving the ISR can be spotted before
+ *          the energy accounting goes wrong.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef SAMPLE_INTEGRITY_H
+#define SAMPLE_INTEGRITY_H
+
+#include <Arduino.h>
+
+#include "adc_timing.h"
+
+inline constexpr uint8_t NO_OF_SAMPLE_SET_BUCKETS{ 8 }; /**< number of buckets of the histogram (the first and the last ones are open) */
+
+inline constexpr uint8_t SAMPLE_SETS_HISTOGRAM_BASE{ NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE - NO_OF_SAMPLE_SET_BUCKETS / 2 }; /**< number of sample sets of the first bucket */
+
+/**
+ * @brief Missed and late conversions, and histogram of the sample sets per mains cycle
+ *
+ */
+class IntegrityStats
+{
+public:
+  /**
+   * @brief Records conversions which have been lost.
+   *
+   * @param count The number of lost conversions
+   *
+   * @ingroup TimeCritical
+   */
+  void recordMissedConversions(const uint16_t count)
+  {
+    missedConversions = count > UINT16_MAX - missedConversions ? UINT16_MAX : missedConversions + count;
+  }
+
+  /**
+   * @brief Records a conversion completed before the end of the ISR.
+   *
+   * @ingroup TimeCritical
+   */
+  void recordLateConversion()
+  {
+    if (lateConversions != UINT16_MAX)
+    {
+      ++lateConversions;
+    }
+  }
+
+  /**
+   * @brief Records the number of sample sets of a mains cycle.
+   *
+   * @param sampleSets The number of sample sets
+   *
+   * @ingroup TimeCritical
+   */
+  void recordMainsCycle(const uint8_t sampleSets)
+  {
+    uint8_t bucket{ 0 };
+    if (sampleSets > SAMPLE_SETS_HISTOGRAM_BASE)
+    {
+      bucket = sampleSets - SAMPLE_SETS_HISTOGRAM_BASE;
+      if (bucket >= NO_OF_SAMPLE_SET_BUCKETS)
+      {
+        bucket = NO_OF_SAMPLE_SET_BUCKETS - 1;
+      }
+    }
+
+    if (histogram[bucket] != UINT16_MAX)
+    {
+      ++histogram[bucket];
+    }
+  }
+
+  /**
+   * @brief Copies the statistics for the main code, then resets them for the next period.
+   *
+   * @param copy The copy read by the main code
+   *
+   * @ingroup TimeCritical
+   */
+  void copyAndReset(volatile IntegrityStats& copy)
+  {
+    copy.missedConversions = missedConversions;
+    copy.lateConversions = lateConversions;
+    missedConversions = 0;
+    lateConversions = 0;
+
+    uint8_t i{ NO_OF_SAMPLE_SET_BUCKETS };
+    do
+    {
+      --i;
+      copy.histogram[i] = histogram[i];
+      histogram[i] = 0;
+    } while (i);
+  }
+
+  uint16_t missedConversions{ 0 };                /**< conversions overwritten before being read */
+  uint16_t lateConversions{ 0 };                  /**< conversions completed before the end of the ISR */
+  uint16_t histogram[NO_OF_SAMPLE_SET_BUCKETS]{}; /**< number of mains cycles with SAMPLE_SETS_HISTOGRAM_BASE + i sample sets */
+};
+
+/**
+ * @brief Conversions skipped between two runs of the ISR, in free-running mode
+ *
+ * @details The jitter of the entry of the ISR (ADC_ISR_ENTRY_WORST_CASE_CYCLES) being below half a
+ *          sample period, the gap is rounded to a whole number of periods. A gap longer than the
+ *          wrap-around of the clock (~39 periods) is under-counted.
+ */
+class ConversionSlots
+{
+public:
+  /**
+   * @brief Returns the number of conversions skipped since the previous run of the ISR.
+   *
+   * @param now The sample clock at the entry of the ISR (see HAL::readSampleClock())
+   * @return The number of skipped conversions, usually 0
+   *
+   * @ingroup TimeCritical
+   */
+  uint16_t skipped(const uint16_t now)
+  {
+    const uint16_t elapsed{ static_cast< uint16_t >(now - previous) };
+    previous = now;
+
+    if (!started)
+    {
+      started = true;
+      return 0;
+    }
+
+    if (elapsed < ADC_SAMPLE_PERIOD_CYCLES + ADC_SAMPLE_PERIOD_CYCLES / 2)
+    {
+      return 0;
+    }
+    return (elapsed + ADC_SAMPLE_PERIOD_CYCLES / 2) / ADC_SAMPLE_PERIOD_CYCLES - 1;  // rare, the division is acceptable
+  }
+
+private:
+  uint16_t previous{ 0 }; /**< sample clock at the previous run */
+  bool started{ false };  /**< no previous run yet */
+};
+
+static_assert(ADC_ISR_ENTRY_WORST_CASE_CYCLES < ADC_SAMPLE_PERIOD_CYCLES / 2, "******** The jitter of the ISR hides the missed conversions ! ********");
+
+inline IntegrityStats sampleIntegrity;  /**< integrity of the sampling during the current datalogging period */
+inline ConversionSlots conversionSlots; /**< timestamps of the ISR, free-running mode only */
+
+#endif /* SAMPLE_INTEGRITY_H */
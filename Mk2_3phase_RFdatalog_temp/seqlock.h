@@ -0,0 +1,98 @@
+/**
+ * @file seqlock.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Versioned buffer letting the main loop take a coherent copy of data written by the ISR
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details The writer (the ISR) increments a sequence number before and after each update, so that the
+ *          sequence is odd while the data are being written. The reader copies the data, then checks
+ *          that the sequence was even and did not change during the copy, and retries otherwise.
+ *          The reader never disables the interrupts, and the writer never waits.
+ *
+ *          Since the ISR cannot be interrupted by the main loop, an update is always complete when
+ *          the reader runs: a retry only happens if the ISR published new data during the copy.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <Arduino.h>
+
+#include "compiler_barrier.h"
+
+/**
+ * @brief Versioned buffer of data with a single writer and a single reader
+ *
+ * @tparam T Type of the data, copied by assignment
+ */
+template< typename T >
+class Seqlock
+{
+public:
+  /**
+   * @brief Starts an update of the data.
+   *
+   * @return The data to update, until endWrite() is called
+   *
+   * @ingroup TimeCritical
+   */
+  T& beginWrite()
+  {
+    sequence = sequence + 1;
+    compilerBarrier();
+    return data;
+  }
+
+  /**
+   * @brief Publishes the data updated since beginWrite().
+   *
+   * @ingroup TimeCritical
+   */
+  void endWrite()
+  {
+    compilerBarrier();
+    sequence = sequence + 1;
+  }
+
+  /**
+   * @brief Takes a coherent copy of the last published data.
+   *
+   * @param copy The copy
+   * @return The version of the copy, incremented at each update (modulo 128)
+   *
+   * @ingroup GeneralProcessing
+   */
+  uint8_t read(T& copy) const
+  {
+    uint8_t start;
+    do
+    {
+      start = sequence;
+      compilerBarrier();
+      copy = data;
+      compilerBarrier();
+    } while ((start & 1) || start != sequence);
+
+    return start >> 1;
+  }
+
+  /**
+   * @brief Version of the last published data.
+   *
+   * @return The version, incremented at each update (modulo 128)
+   */
+  uint8_t getVersion() const
+  {
+    return sequence >> 1;
+  }
+
+private:
+  T data{};                       /**< the data */
+  volatile uint8_t sequence{ 0 }; /**< odd while the data are being written */
+};
+
+#endif /* SEQLOCK_H */
@@ -3,6 +3,87 @@
 
 #include <Arduino.h>
 
+#include "cycle_stream.h"
+#include "isr_timing.h"
+#include "sample_integrity.h"
+#include "seqlock.h"
+
+/**
+ * @brief Optional values of a datalog period, one block per feature
+ * @details The primary templates are empty, so a disabled feature takes no RAM in DatalogData.
+ *          The code reading or writing these members takes the datalog as a template parameter,
+ *          so that the members of a disabled feature are never looked up.
+ *
+ * @tparam enabled The feature is enabled (see config.h)
+ */
+template< bool enabled > struct CurrentRmsLog
+{
+};
+
+/** @brief Values of a datalog period for CURRENT_RMS_MEASUREMENT */
+template<> struct CurrentRmsLog< true >
+{
+  uint32_t sum_Isquared[NO_OF_PHASES]{}; /**< summation of I^2 values during datalog period */
+};
+
+template< bool enabled > struct CurrentDCoffsetLog
+{
+};
+
+/** @brief Values of a datalog period for CURRENT_DC_OFFSET_TRACKING */
+template<> struct CurrentDCoffsetLog< true >
+{
+  int32_t DCoffset_I[NO_OF_PHASES]{}; /**< DC offset of the current, x256 */
+};
+
+template< bool enabled > struct IsrTimingLog
+{
+};
+
+/** @brief Values of a datalog period for ISR_TIMING_INSTRUMENTATION */
+template<> struct IsrTimingLog< true >
+{
+  TimingStats isrTiming[NO_OF_TIMED_SECTIONS]{}; /**< the execution times */
+};
+
+template< bool enabled > struct SampleIntegrityLog
+{
+};
+
+/** @brief Values of a datalog period for SAMPLE_INTEGRITY_DIAGNOSTICS */
+template<> struct SampleIntegrityLog< true >
+{
+  IntegrityStats sampleIntegrity{}; /**< the missed/late conversions and the histogram of the sample sets per mains cycle */
+};
+
+template< bool enabled > struct MainsFrequencyLog
+{
+};
+
+/** @brief Values of a datalog period for MAINS_FREQUENCY_MEASUREMENT */
+template<> struct MainsFrequencyLog< true >
+{
+  uint16_t mainsPeriod{ 0 }; /**< the mains period measured by the PLL of the first phase (0 if not locked) */
+};
+
+/**
+ * @brief Values of a datalog period, passed from the ISR to the main processor
+ *
+ */
+struct DatalogData : CurrentRmsLog< CURRENT_RMS_MEASUREMENT >,
+                     CurrentDCoffsetLog< CURRENT_DC_OFFSET_TRACKING >,
+                     IsrTimingLog< ISR_TIMING_INSTRUMENTATION >,
+                     SampleIntegrityLog< SAMPLE_INTEGRITY_DIAGNOSTICS >,
+                     MainsFrequencyLog< MAINS_FREQUENCY_MEASUREMENT >
+{
+  int32_t sumP_atSupplyPoint[NO_OF_PHASES]{};      /**< cumulative power per phase */
+  int32_t sum_Vsquared[NO_OF_PHASES]{};            /**< summation of V^2 values during datalog period */
+  float energyInBucket_main{ 0 };                  /**< main energy bucket (over all phases) */
+  uint8_t lowestNoOfSampleSetsPerMainsCycle{ 0 };  /**< a mechanism to check the integrity of this code structure */
+  uint16_t sampleSetsDuringThisDatalogPeriod{ 0 }; /**< for counting the sample sets during each datalogging period */
+  uint16_t countLoadON[NO_OF_DUMPLOADS]{};         /**< number of cycle the load was ON (over 1 datalog period) */
+};
+
 // Shared variables - carefully managed between ISR and loop
 namespace Shared
 {
@@ -15,15 +96,15 @@ inline volatile uint16_t overrideBitmask{ 0 };       /**< combined bitmask of al
 
 inline volatile uint16_t absenceOfDivertedEnergyCountInSeconds{ 0 }; /**< number of seconds without diverted energy */
 
-// since there's no real locking feature for shared variables, a couple of data
-// generated from inside the ISR are copied from time to time to be passed to the
-// main processor. When the data are available, the ISR signals it to the main processor.
-inline volatile int32_t copyOf_sumP_atSupplyPoint[NO_OF_PHASES];   /**< copy of cumulative power per phase */
-inline volatile int32_t copyOf_sum_Vsquared[NO_OF_PHASES];         /**< copy of for summation of V^2 values during datalog period */
-inline volatile float copyOf_energyInBucket_main;                  /**< copy of main energy bucket (over all phases) */
-inline volatile uint8_t copyOf_lowestNoOfSampleSetsPerMainsCycle;  /**< copy of a mechanism to check the integrity of this code structure */
-inline volatile uint16_t copyOf_sampleSetsDuringThisDatalogPeriod; /**< copy of for counting the sample sets during each datalogging period */
-inline volatile uint16_t copyOf_countLoadON[NO_OF_DUMPLOADS];      /**< copy of number of cycle the load was ON (over 1 datalog period) */
+// since there's no real locking feature for shared variables, the data generated from inside
+// the ISR are published at the end of each datalog period in a versioned buffer (see seqlock.h),
+// from which the main processor takes a coherent copy without disabling the interrupts.
+// When the data are available, the ISR signals it to the main processor.
+inline Seqlock< DatalogData > datalog; /**< datalog values, written by the ISR at the end of each datalog period */
+
+inline CycleStream< CYCLE_STREAM_BUFFER_SIZE > cycleStream; /**< per-cycle records, queued by the ISR when CYCLE_STREAMING is set */
 }
 
+inline DatalogData copyOf_datalog; /**< coherent copy of Shared::datalog, taken by the main processor */
+
 #endif /* SHARED_VAR_H */
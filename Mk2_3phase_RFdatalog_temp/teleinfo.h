@@ -24,8 +24,15 @@
 #ifndef TELEINFO_H
 #define TELEINFO_H
 
+#include "FastDivision.h"
+
 #include "config_system.h"
 #include "config.h"
+#include "energy_meters.h"
+#include "isr_timing.h"
+#include "sample_integrity.h"
+#include "telemetry_delta.h"
+#include "tx_queue.h"
 
 /**
  * @brief Calculates the size of a single telemetry line in the frame.
@@ -52,16 +59,17 @@ inline static constexpr size_t lineSize(size_t tagLen, size_t valueLen)
 }
 
 /**
- * @brief Calculates the total buffer size required for the telemetry frame.
+ * @brief Adds up the lines of the telemetry frame.
  *
- * This function computes the size of the buffer needed to store the entire telemetry frame,
- * including all tags, values, and formatting characters. The calculation takes into account
- * the presence of optional features and system configuration.
+ * This function lists all the lines a telemetry frame can hold, with the length of their tag
+ * and the maximum length of their value. The list takes into account the presence of optional
+ * features and system configuration.
  *
- * @return The total buffer size as a compile-time constant.
+ * @tparam Line Type of the callable giving the contribution of a line
+ * @param line The contribution of a line, from the length of its tag and of its value
+ * @return The sum of the contributions of all the lines, as a compile-time constant.
  *
- * The buffer size is calculated as follows:
- * - 1 byte for the start-of-text (STX) character.
+ * The lines are as follows:
  * - 1 line for the "P" tag (signed 6 digits) - power measurement.
  *
  * For multi-phase systems (`NO_OF_PHASES > 1`):
@@ -80,6 +88,11 @@ inline static constexpr size_t lineSize(size_t tagLen, size_t valueLen)
  * If temperature sensors are present (`TEMP_SENSOR_PRESENT`):
  * - `temperatureSensing.size()` lines for the "T1" to "Tn" tags (4 digits each) - temperature readings.
  *
+ * If the current measurement is enabled (`CURRENT_RMS_MEASUREMENT`), for each phase:
+ * - 1 line for the "I" or "I1" to "In" tags (unsigned 5 digits) - current in 100th of A.
+ * - 1 line for the "VA" or "VA1" to "VAn" tags (unsigned 5 digits) - apparent power.
+ * - 1 line for the "PF" or "PF1" to "PFn" tags (signed 4 digits) - power factor in 100th.
+ *
  * Common for all configurations:
  * - 1 line for the "N" tag (unsigned 5 digits) - absence of diverted energy count.
  *
@@ -88,58 +101,159 @@ inline static constexpr size_t lineSize(size_t tagLen, size_t valueLen)
  *
  * - 1 line for the "S_MC" tag (unsigned 2 digits) - sample sets per mains cycle.
  * - 1 line for the "S" tag (unsigned 5 digits) - sample count.
- * - 1 byte for the end-of-text (ETX) character.
+ *
+ * If the sample integrity diagnostics are enabled (`SAMPLE_INTEGRITY_DIAGNOSTICS`):
+ * - 2 lines for the "MISS" and "LATE" tags (unsigned 5 digits) - missed and late ADC conversions.
+ * - `NO_OF_SAMPLE_SET_BUCKETS` lines for the "S_MC_H1" to "S_MC_Hn" tags (unsigned 5 digits) - histogram of the sample sets per mains cycle.
+ *
+ * If the DC offset of the current is tracked (`CURRENT_DC_OFFSET_TRACKING`):
+ * - `NO_OF_PHASES` lines for the "I_DC1" to "I_DCn" tags (unsigned 4 digits) - DC offset in 10th of ADC steps.
+ *
+ * If the energy meters are enabled (`ENERGY_METERS`):
+ * - 2 lines for the "EI" and "EE" tags (unsigned 20 digits) - imported and exported energy in Wh.
+ * - `NO_OF_DUMPLOADS` lines for the "ED1" to "EDn" tags (unsigned 20 digits) - diverted energy in Wh.
+ *
+ * If the ISR timing instrumentation is enabled (`ISR_TIMING_INSTRUMENTATION`):
+ * - 2 lines for the "ISR_MIN" and "ISR_MAX" tags (unsigned 4 digits) - execution time of the ISR in µs.
+ * - `NO_OF_TIMING_BUCKETS` lines for the "ISR_H1" to "ISR_Hn" tags (unsigned 4 digits) - histogram in ‰.
+ * - 3 lines for the "PHC_MAX", "SNC_MAX" and "DL_MAX" tags (unsigned 4 digits) - execution times in µs.
+ *
+ * If the telemetry is queued (`TELEMETRY_TX_QUEUE`):
+ * - 1 line for the "TXD" tag (unsigned 5 digits) - number of frames dropped by the TX queue.
+ *
+ * If delta frames are enabled (`TELEMETRY_DELTA_FRAMES`):
+ * - 1 line for the "SEQ" tag (unsigned 5 digits) - sequence number of the frame.
+ * - 1 line for the "KF" tag (1 digit) - set in the keyframes.
  *
  * @ingroup Telemetry
  */
-inline static constexpr size_t calcBufferSize()
+template< typename Line >
+inline static constexpr size_t sumOfLines(Line line)
 {
-  size_t size{ 1 };  // STX
+  size_t size{ 0 };
 
-  size += lineSize(1, 6);  // P (signed 6 digits)
+  size += line(1, 6);  // P (signed 6 digits)
 
   if constexpr (NO_OF_PHASES > 1)
   {
-    size += NO_OF_PHASES * lineSize(2, 5);  // V1-Vn (unsigned 5 digits) - voltage
+    size += NO_OF_PHASES * line(2, 5);  // V1-Vn (unsigned 5 digits) - voltage
 
-    size += NO_OF_PHASES * lineSize(2, 6);  // P1-Pn (signed 6 digits) - instant power
+    size += NO_OF_PHASES * line(2, 6);  // P1-Pn (signed 6 digits) - instant power
 
-    size += NO_OF_DUMPLOADS * lineSize(2, 3);  // D1-Dn (unsigned 3 digits) - diversion rate
+    size += NO_OF_DUMPLOADS * line(2, 3);  // D1-Dn (unsigned 3 digits) - diversion rate
   }
   else
   {
-    size += lineSize(1, 5);  // V (unsigned 5 digits) - voltage
+    size += line(1, 5);  // V (unsigned 5 digits) - voltage
 
-    size += lineSize(1, 4);  // D (unsigned 4 digits) - diverted power
-    size += lineSize(1, 5);  // E (unsigned 5 digits) - diverted energy
+    size += line(1, 4);  // D (unsigned 4 digits) - diverted power
+    size += line(1, 5);  // E (unsigned 5 digits) - diverted energy
   }
 
   if constexpr (RELAY_DIVERSION)
   {
-    size += lineSize(1, 6);                  // R (signed 6 digits) - mean power for relay diversion
-    size += relays.size() * lineSize(2, 1);  // R1-Rn (1 (ON), 0 (OFF)) - relay state
+    size += line(1, 6);                  // R (signed 6 digits) - mean power for relay diversion
+    size += relays.size() * line(2, 1);  // R1-Rn (1 (ON), 0 (OFF)) - relay state
   }
 
   if constexpr (TEMP_SENSOR_PRESENT)
   {
-    size += temperatureSensing.size() * lineSize(2, 4);  // T1-Tn (4 digits) - temperature
+    size += temperatureSensing.size() * line(2, 4);  // T1-Tn (4 digits) - temperature
+  }
+
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    size += line(1, 4);  // F (unsigned 4 digits) - mains frequency in 100th of Hz
   }
 
-  size += lineSize(1, 5);  // N (unsigned 5 digits) - absence of diverted energy count
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    constexpr uint8_t indexLength{ NO_OF_PHASES > 1 ? 1 : 0 };
+
+    size += NO_OF_PHASES * line(1 + indexLength, 5);  // I1-In (unsigned 5 digits) - current
+    size += NO_OF_PHASES * line(2 + indexLength, 5);  // VA1-VAn (unsigned 5 digits) - apparent power
+    size += NO_OF_PHASES * line(2 + indexLength, 4);  // PF1-PFn (signed 4 digits) - power factor
+  }
+
+  size += line(1, 5);  // N (unsigned 5 digits) - absence of diverted energy count
 
   if constexpr (DUAL_TARIFF)
   {
-    size += lineSize(2, 1);  // TA (1 digit) - tariff state (0=high/on-peak, 1=low/off-peak)
+    size += line(2, 1);  // TA (1 digit) - tariff state (0=high/on-peak, 1=low/off-peak)
+  }
+
+  size += line(4, 2);  // S_MC (unsigned 2 digits) - sample sets per mains cycle
+  size += line(1, 5);  // S (unsigned 5 digits) - sample count
+
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    size += 2 * line(4, 5);                         // MISS, LATE (unsigned 5 digits) - missed and late ADC conversions
+    size += NO_OF_SAMPLE_SET_BUCKETS * line(7, 5);  // S_MC_H1-S_MC_Hn (unsigned 5 digits) - histogram of the sample sets per mains cycle
   }
 
-  size += lineSize(4, 2);  // S_MC (unsigned 2 digits) - sample sets per mains cycle
-  size += lineSize(1, 5);  // S (unsigned 5 digits) - sample count
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    size += NO_OF_PHASES * line(5, 4);  // I_DC1-I_DCn (unsigned 4 digits) - DC offset of the current in 10th of ADC steps
+  }
 
-  size += 1;  // ETX
+  if constexpr (ISR_TIMING_INSTRUMENTATION)
+  {
+    size += 2 * line(7, 4);                     // ISR_MIN, ISR_MAX (unsigned 4 digits) - execution time of the ISR in µs
+    size += NO_OF_TIMING_BUCKETS * line(6, 4);  // ISR_H1-ISR_Hn (unsigned 4 digits) - histogram in ‰
+    size += 2 * line(7, 4) + line(6, 4);    // PHC_MAX, SNC_MAX, DL_MAX (unsigned 4 digits) - execution times in µs
+  }
+
+  if constexpr (ENERGY_METERS)
+  {
+    size += 2 * line(2, UINT64_MAX_DIGITS);                // EI, EE (unsigned 20 digits) - imported and exported energy in Wh
+    size += NO_OF_DUMPLOADS * line(3, UINT64_MAX_DIGITS);  // ED1-EDn (unsigned 20 digits) - diverted energy in Wh
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    size += line(3, 5);  // TXD (unsigned 5 digits) - number of frames dropped by the TX queue
+  }
+
+  if constexpr (TELEMETRY_DELTA_FRAMES)
+  {
+    size += line(3, 5);  // SEQ (unsigned 5 digits) - sequence number of the frame
+    size += line(2, 1);  // KF (1 digit) - set in the keyframes
+  }
 
   return size;
 }
 
+/**
+ * @brief Calculates the total buffer size required for the telemetry frame.
+ *
+ * @return The total buffer size as a compile-time constant: start-of-text (STX) character,
+ *         all the lines (see sumOfLines()), end-of-text (ETX) character.
+ *
+ * @ingroup Telemetry
+ */
+inline static constexpr size_t calcBufferSize()
+{
+  return 1 + sumOfLines(lineSize) + 1;
+}
+
+/**
+ * @brief Calculates the maximum number of lines of the telemetry frame.
+ *
+ * @return The number of lines as a compile-time constant.
+ *
+ * @ingroup Telemetry
+ */
+inline static constexpr size_t calcLineCount()
+{
+  return sumOfLines([](size_t, size_t) {
+    return size_t{ 1 };
+  });
+}
+
+static_assert(calcLineCount() <= UINT8_MAX, "******** Too many lines in a telemetry frame ! ********");
+
+static_assert(!TELEMETRY_TX_QUEUE || SERIAL_OUTPUT_TYPE != SerialOutputType::IoT || calcBufferSize() <= TX_QUEUE_SIZE, "******** TX_QUEUE_SIZE is too small for a telemetry frame ! ********");
+
 /**
  * @class TeleInfo
  * @brief A class for managing and sending telemetry information in a structured frame format.
@@ -174,84 +288,189 @@ private:
   char buffer[calcBufferSize()]{}; /**< Buffer to store the frame data. Adjust size as needed. */
   size_t bufferPos{ 0 };           /**< Current position in the buffer. */
 
+  DeltaFilter< TELEMETRY_DELTA_FRAMES ? calcLineCount() : 0 > filter; /**< Last values sent, when only the changes are sent. */
+
   /**
-   * @brief Calculates the checksum for a portion of the buffer.
-   * @param startPos The starting position in the buffer.
-   * @param endPos The ending position in the buffer.
-   * @return The calculated checksum as a single byte.
+   * @brief Writes a character to the buffer and adds it to the checksum.
+   * @param c The character.
+   * @param sum The checksum of the line.
    */
-  [[nodiscard]] uint8_t calculateChecksum(size_t startPos, size_t endPos) const
+  __attribute__((always_inline)) void put(const char c, uint8_t& sum)
   {
-    uint8_t sum{ 0 };
-    auto* ptr = buffer + startPos;
-    const auto* end = buffer + endPos;
-
-    // Process 4 bytes at once for longer segments
-    while (ptr + 4 <= end)
-    {
-      sum += *ptr++;
-      sum += *ptr++;
-      sum += *ptr++;
-      sum += *ptr++;
-    }
-
-    // Handle remaining bytes
-    while (ptr < end)
-    {
-      sum += *ptr++;
-    }
-
-    return (sum & 0x3F) + 0x20;
+    buffer[bufferPos++] = c;
+    sum += c;
   }
 
   /**
    * @brief Writes a tag to the buffer.
    * @param tag The tag to write.
+   * @param index The index appended to the tag, if not 0.
+   * @param sum The checksum of the line.
    */
-  __attribute__((always_inline)) void writeTag(const char* tag, uint8_t index)
+  __attribute__((always_inline)) void writeTag(const char* tag, uint8_t index, uint8_t& sum)
   {
     auto* ptr{ tag };
-    while (*ptr) buffer[bufferPos++] = *ptr++;
+    while (*ptr) put(*ptr++, sum);
 
     // If an index is provided, append it to the tag
     if (index != 0)
     {
-      buffer[bufferPos++] = static_cast< char >('0' + index);  // Convert index to a character
+      put(static_cast< char >('0' + index), sum);  // Convert index to a character
+    }
+
+    put(TAB, sum);
+  }
+
+  /**
+   * @brief Writes the decimal digits of a value to the buffer.
+   * @details The digits are produced with divmod10(), from the lowest one, and added to the
+   *          checksum while they are copied to the buffer.
+   * @param value The value to write.
+   * @param sum The checksum of the line.
+   */
+  void writeValue(const int32_t value, uint8_t& sum)
+  {
+    char digits[10];  // 4294967295
+    uint8_t count{ 0 };
+    uint32_t n{ value < 0 ? 0 - static_cast< uint32_t >(value) : static_cast< uint32_t >(value) };
+
+    if (value < 0)
+    {
+      put('-', sum);
     }
 
-    buffer[bufferPos++] = TAB;
+    do
+    {
+      uint8_t digit;
+      divmod10(n, n, digit);
+      digits[count++] = static_cast< char >('0' + digit);
+    } while (n);
+
+    do
+    {
+      put(digits[--count], sum);
+    } while (count);
+  }
+
+  /**
+   * @brief Ends a line with its checksum.
+   * @param sum The checksum of the line, from the tag to the separator before the checksum.
+   */
+  __attribute__((always_inline)) void endLine(uint8_t sum)
+  {
+    put(TAB, sum);
+
+    buffer[bufferPos++] = static_cast< char >((sum & 0x3F) + 0x20);
+    buffer[bufferPos++] = CR;
+  }
+
+  /**
+   * @brief Writes a line with a number.
+   * @param tag The tag associated with the value.
+   * @param value The value to send.
+   * @param index The index appended to the tag, if not 0.
+   */
+  void writeLine(const char* tag, const int32_t value, uint8_t index)
+  {
+    uint8_t sum{ 0 };
+
+    buffer[bufferPos++] = LF;
+
+    writeTag(tag, index, sum);
+    writeValue(value, sum);
+    endLine(sum);
   }
 
 public:
   /**
    * @brief Initializes a new frame by resetting the buffer and adding the start character.
+   * @details With delta frames, the frame starts with its sequence number, followed by the
+   *          "KF" line in the keyframes.
    */
   __attribute__((always_inline)) void startFrame()
   {
     bufferPos = 0;
     buffer[bufferPos++] = STX;
+
+    if constexpr (TELEMETRY_DELTA_FRAMES)
+    {
+      const bool keyframe{ filter.startFrame() };
+
+      writeLine("SEQ", filter.getSequence(), 0);
+      if (keyframe)
+      {
+        writeLine("KF", 1, 0);
+      }
+    }
   }
 
   /**
    * @brief Sends a telemetry value as an integer.
+   * @details The line is written in a single pass, the checksum being computed on the fly.
+   *          Any value fitting in an int32_t is sent as is, floats being truncated.
+   *          With delta frames, the line is skipped if the value didn't change enough.
+   * @tparam T The type of the value.
    * @param tag The tag associated with the value.
-   * @param value The integer value to send.
+   * @param value The value to send.
+   * @param index The index appended to the tag, if not 0.
    */
-  void send(const char* tag, int16_t value, uint8_t index = 0)
+  template< typename T >
+  void send(const char* tag, const T value, uint8_t index = 0)
   {
-    buffer[bufferPos++] = LF;
+    static_assert(is_integral< T >::value || is_floating_point< T >::value, "******** TeleInfo only sends numbers or text ! ********");
 
-    const auto startPos{ bufferPos };
+    const int32_t number{ static_cast< int32_t >(value) };
 
-    writeTag(tag, index);
-    auto str = itoa(value, buffer + bufferPos, 10);
-    bufferPos += strlen(str);  // Advance bufferPos by the length of the written string
-    buffer[bufferPos++] = TAB;
+    if constexpr (TELEMETRY_DELTA_FRAMES)
+    {
+      if (!filter.changed(telemetryLineKey(tag, index), static_cast< uint16_t >(number), telemetryDeadband(tag)))
+      {
+        return;
+      }
+    }
 
-    const auto crc{ calculateChecksum(startPos, bufferPos) };
-    buffer[bufferPos++] = crc;
+    writeLine(tag, number, index);
+  }
 
-    buffer[bufferPos++] = CR;
+  /**
+   * @brief Sends a telemetry value already converted to text.
+   * @param tag The tag associated with the value.
+   * @param value The digits of the value, e.g. a 64-bit value converted with uint64ToDecimal().
+   * @param index The index appended to the tag, if not 0.
+   */
+  void send(const char* tag, const char* value, uint8_t index = 0)
+  {
+    if constexpr (TELEMETRY_DELTA_FRAMES)
+    {
+      if (!filter.changed(telemetryLineKey(tag, index), telemetryTextHash(value), 0))
+      {
+        return;
+      }
+    }
+
+    uint8_t sum{ 0 };
+
+    buffer[bufferPos++] = LF;
+
+    writeTag(tag, index, sum);
+    while (*value) put(*value++, sum);
+    endLine(sum);
+  }
+
+  /**
+   * @brief Content of the current frame.
+   */
+  const char* data() const
+  {
+    return buffer;
+  }
+
+  /**
+   * @brief Number of bytes of the current frame.
+   */
+  size_t size() const
+  {
+    return bufferPos;
   }
 
   /**
@@ -260,7 +479,7 @@ public:
   __attribute__((always_inline)) void endFrame()
   {
     buffer[bufferPos++] = ETX;
-    Serial.write(buffer, bufferPos);
+    telemetryPort().write(reinterpret_cast< const uint8_t* >(buffer), bufferPos);
   }
 };
 
@@ -0,0 +1,188 @@
+/**
+ * @file telemetry_delta.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Selection of the changed values sent in the delta telemetry frames
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details When TELEMETRY_DELTA_FRAMES is set (see config.h), only one IoT frame out of
+ *          TELEMETRY_KEYFRAME_PERIOD holds all the values (keyframe). The other frames only hold the
+ *          values which moved away from the last value sent by more than the deadband of their tag
+ *          (TELEMETRY_DEADBANDS), so a slow drift is still sent once it exceeds the deadband.
+ *
+ *          Each frame starts with a "SEQ" line, incremented at each frame, and the keyframes with a
+ *          "KF" line. A receiver detecting a gap in the sequence keeps the values it has, and gets
+ *          them all again at the next keyframe.
+ *
+ *          The lines are identified by their position in the frame, which doesn't change from one
+ *          period to the next, and a hash of their tag. A line whose hash doesn't match the one
+ *          stored at its position (e.g. a temperature sensor being disconnected shifts the following
+ *          lines) is always sent.
+ *
+ *          Only 16 bits of each value are kept, the difference being computed modulo 2^16: a change
+ *          larger than 32767 may be missed until the next keyframe.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef TELEMETRY_DELTA_H
+#define TELEMETRY_DELTA_H
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "config_system.h"
+
+/**
+ * @brief Deadband of a tag
+ *
+ * @param tag The tag, without index
+ * @return The deadband from TELEMETRY_DEADBANDS, 0 if the tag is not listed
+ */
+inline uint16_t telemetryDeadband(const char* tag)
+{
+  for (const auto& entry : TELEMETRY_DEADBANDS)
+  {
+    if (!strcmp(tag, entry.tag))
+    {
+      return entry.deadband;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Hash of the tag and index of a line
+ *
+ * @param tag The tag
+ * @param index The index appended to the tag, 0 if none
+ * @return The hash
+ */
+inline uint8_t telemetryLineKey(const char* tag, const uint8_t index)
+{
+  uint8_t key{ index };
+  while (*tag)
+  {
+    key = static_cast< uint8_t >(key * 31 + *tag++);
+  }
+  return key;
+}
+
+/**
+ * @brief 16-bit hash of a value sent as text, to detect its changes
+ *
+ * @param value The text
+ * @return The hash (FNV-1a folded to 16 bits)
+ */
+inline uint16_t telemetryTextHash(const char* value)
+{
+  uint32_t hash{ 2166136261UL };
+  while (*value)
+  {
+    hash = (hash ^ static_cast< uint8_t >(*value++)) * 16777619UL;
+  }
+  return static_cast< uint16_t >(hash ^ (hash >> 16));
+}
+
+/**
+ * @brief Last values sent, and keyframe scheduling
+ *
+ * @tparam N Maximum number of lines of a frame
+ */
+template< uint8_t N >
+class DeltaFilter
+{
+public:
+  /**
+   * @brief Starts a new frame.
+   *
+   * @return true if this frame is a keyframe
+   */
+  bool startFrame()
+  {
+    line = 0;
+    ++sequence;
+
+    keyframe = !periodsToKeyframe;
+    periodsToKeyframe = keyframe ? TELEMETRY_KEYFRAME_PERIOD - 1 : periodsToKeyframe - 1;
+
+    return keyframe;
+  }
+
+  /**
+   * @brief Sequence number of the current frame.
+   *
+   */
+  uint16_t getSequence() const
+  {
+    return sequence;
+  }
+
+  /**
+   * @brief Tells if the next line of the frame has to be sent, and records its value if so.
+   *
+   * @param key The hash of the tag and index of the line
+   * @param value The value, only the 16 lowest bits are compared
+   * @param deadband The smallest change to send
+   * @return true if the line has to be sent
+   */
+  bool changed(const uint8_t key, const uint16_t value, const uint16_t deadband)
+  {
+    if (line >= N)
+    {
+      return true;
+    }
+
+    auto& slot{ slots[line++] };
+    const int16_t delta{ static_cast< int16_t >(value - slot.value) };
+
+    if (keyframe || slot.key != key || static_cast< uint16_t >(delta < 0 ? -delta : delta) > deadband)
+    {
+      slot.key = key;
+      slot.value = value;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  /** @brief Last value sent for a line */
+  struct Slot
+  {
+    uint8_t key{ 0 };    /**< hash of the tag and index */
+    uint16_t value{ 0 }; /**< 16 lowest bits of the value */
+  };
+
+  Slot slots[N]{};                   /**< one per line of the frame */
+  uint16_t sequence{ UINT16_MAX };   /**< sequence number of the current frame, the first one being 0 */
+  uint8_t line{ 0 };                 /**< position of the next line in the frame */
+  uint8_t periodsToKeyframe{ 0 };    /**< the first frame is a keyframe */
+  bool keyframe{ false };            /**< the current frame is a keyframe */
+};
+
+/**
+ * @brief Without delta frames (TELEMETRY_DELTA_FRAMES not set): no state, every line is sent
+ *
+ */
+template<>
+class DeltaFilter< 0 >
+{
+public:
+  bool startFrame()
+  {
+    return true;
+  }
+
+  uint16_t getSequence() const
+  {
+    return 0;
+  }
+
+  bool changed(const uint8_t /*key*/, const uint16_t /*value*/, const uint16_t /*deadband*/)
+  {
+    return true;
+  }
+};
+
+#endif /* TELEMETRY_DELTA_H */
@@ -0,0 +1,112 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "ct_filter.h"  // Include the header file for the functions to test
+
+constexpr float kGain{ 8.0F };
+constexpr uint16_t kGainQ{ initLpfCoefficient(kGain, 16 - LPF_FRACTION_BITS) };
+constexpr uint8_t kRuns{ 100 };
+
+volatile int32_t sampleIminusDC{ 12345L * 4 };  // volatile, so that nothing is computed at compile time
+volatile int32_t result{ 0 };
+
+int32_t lpfState{ 0 };
+int32_t lpfFloat{ 0 };
+
+/**
+ * @brief Float version of the filter, as in the original code
+ */
+int32_t compensateCtHighPassFloat(int32_t sample)
+{
+  const int32_t last_lpf_long{ lpfFloat };
+  lpfFloat += alpha * (sample - last_lpf_long);
+  sample += (kGain * lpfFloat);
+  return sample;
+}
+
+/**
+ * @brief Average number of CPU cycles of one filtered sample, Timer1 running at the CPU clock
+ */
+template< typename F >
+uint16_t measureCycles(F filter)
+{
+  TCCR1A = 0;
+  TCCR1B = bit(CS10);
+  TIMSK1 = 0;
+
+  // cost of the measurement itself
+  uint8_t oldSREG{ SREG };
+  cli();
+  uint16_t start{ TCNT1 };
+  result = sampleIminusDC;
+  const uint16_t overhead{ static_cast< uint16_t >(TCNT1 - start) };
+  SREG = oldSREG;
+
+  uint32_t total{ 0 };
+  for (uint8_t i = 0; i < kRuns; ++i)
+  {
+    oldSREG = SREG;
+    cli();
+    start = TCNT1;
+    result = filter(sampleIminusDC);
+    total += static_cast< uint16_t >(TCNT1 - start) - overhead;
+    SREG = oldSREG;
+  }
+
+  return total / kRuns;
+}
+
+void setUp(void)
+{
+  // Set up code here (if needed)
+}
+
+void tearDown(void)
+{
+  // Clean up code here (if needed)
+}
+
+void test_cycle_cost(void)
+{
+  const uint16_t cyclesFloat{ measureCycles([](const int32_t sample) {
+    return compensateCtHighPassFloat(sample);
+  }) };
+  const uint16_t cyclesInteger{ measureCycles([](const int32_t sample) {
+    return compensateCtHighPass< LPF_ALPHA_Q16, kGainQ >(lpfState, sample);
+  }) };
+  const uint16_t cyclesDisabled{ measureCycles([](const int32_t sample) {
+    return compensateCtHighPass< LPF_ALPHA_Q16, 0 >(lpfState, sample);
+  }) };
+
+  char buffer[80];
+  snprintf(buffer, sizeof(buffer), "CT filter: float %u cycles, integer %u cycles, disabled %u cycles", cyclesFloat, cyclesInteger, cyclesDisabled);
+  TEST_MESSAGE(buffer);
+
+  // each ADC conversion lasts 1664 CPU cycles, the whole ISR must fit in it
+  TEST_ASSERT_TRUE(cyclesInteger < 100);
+  TEST_ASSERT_TRUE(cyclesInteger * 4 < cyclesFloat);
+  TEST_ASSERT_TRUE(cyclesDisabled < 4);
+}
+
+void setup()
+{
+  delay(1000);    // Wait for Serial to initialize
+  UNITY_BEGIN();  // Start Unity test framework
+}
+
+uint8_t i = 0;
+uint8_t max_blinks = 1;
+
+void loop()
+{
+  if (i < max_blinks)
+  {
+    RUN_TEST(test_cycle_cost);
+    delay(100);
+    ++i;
+  }
+  else if (i == max_blinks)
+  {
+    UNITY_END();  // End Unity test framework
+  }
+}
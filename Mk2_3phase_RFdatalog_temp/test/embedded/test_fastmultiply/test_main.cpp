@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "FastMultiply.h"  // Include the header file for the functions to test
+
+constexpr uint8_t kRuns{ 100 };
+
+volatile int16_t sampleV{ -12345 };  // volatile, so that nothing is computed at compile time
+volatile int16_t sampleI{ 23456 };
+volatile int32_t sampleV32{ -12345 };  // as in the ISR before, 16-bit values held in int32_t
+volatile int32_t sampleI32{ 23456 };
+volatile int32_t result{ 0 };
+
+/**
+ * @brief Average number of CPU cycles of one multiplication, Timer1 running at the CPU clock
+ */
+template< typename T, typename F >
+uint16_t measureCycles(const volatile T &a, const volatile T &b, F multiply)
+{
+  TCCR1A = 0;
+  TCCR1B = bit(CS10);
+  TIMSK1 = 0;
+
+  // cost of the measurement itself
+  uint8_t oldSREG{ SREG };
+  cli();
+  uint16_t start{ TCNT1 };
+  result = a + b;
+  const uint16_t overhead{ static_cast< uint16_t >(TCNT1 - start) };
+  SREG = oldSREG;
+
+  uint32_t total{ 0 };
+  for (uint8_t i = 0; i < kRuns; ++i)
+  {
+    oldSREG = SREG;
+    cli();
+    start = TCNT1;
+    result = multiply(a, b);
+    total += static_cast< uint16_t >(TCNT1 - start) - overhead;
+    SREG = oldSREG;
+  }
+
+  return total / kRuns;
+}
+
+void setUp(void)
+{
+  // Set up code here (if needed)
+}
+
+void tearDown(void)
+{
+  // Clean up code here (if needed)
+}
+
+// Test for mulS16
+void test_mulS16(void)
+{
+  // Basic cases
+  TEST_ASSERT_EQUAL_INT32(0L, mulS16(0, 12345));
+  TEST_ASSERT_EQUAL_INT32(12345L, mulS16(1, 12345));
+  TEST_ASSERT_EQUAL_INT32(-12345L, mulS16(-1, 12345));
+  TEST_ASSERT_EQUAL_INT32(-289564320L, mulS16(sampleV, sampleI));
+
+  // Edge cases
+  TEST_ASSERT_EQUAL_INT32(1073741824L, mulS16(INT16_MIN, INT16_MIN));   // -32768 * -32768
+  TEST_ASSERT_EQUAL_INT32(-1073709056L, mulS16(INT16_MIN, INT16_MAX));  // -32768 * 32767
+  TEST_ASSERT_EQUAL_INT32(1073676289L, mulS16(INT16_MAX, INT16_MAX));   // 32767 * 32767
+  TEST_ASSERT_EQUAL_INT32(-32640L, mulS16(-128, 255));                  // low byte with the sign bit set
+  TEST_ASSERT_EQUAL_INT32(65536L, mulS16(256, 256));
+  TEST_ASSERT_EQUAL_INT32(-65280L, mulS16(256, -255));
+
+  // Random values
+  for (uint16_t i = 0; i < 1000; ++i)
+  {
+    const auto a{ static_cast< int16_t >(random(INT16_MIN, INT16_MAX)) };
+    const auto b{ static_cast< int16_t >(random(INT16_MIN, INT16_MAX)) };
+
+    TEST_ASSERT_EQUAL_INT32(static_cast< int32_t >(a) * b, mulS16(a, b));
+  }
+}
+
+void test_cycle_cost(void)
+{
+  const uint16_t cyclesKernel{ measureCycles(sampleV, sampleI, [](const int16_t a, const int16_t b) {
+    return mulS16(a, b);
+  }) };
+  const uint16_t cyclesGeneric{ measureCycles(sampleV32, sampleI32, [](const int32_t a, const int32_t b) {
+    return a * b;
+  }) };
+
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "16x16: kernel %u cycles, int32_t %u cycles", cyclesKernel, cyclesGeneric);
+  TEST_MESSAGE(buffer);
+
+  TEST_ASSERT_TRUE(cyclesKernel < cyclesGeneric);
+}
+
+void setup()
+{
+  delay(1000);    // Wait for Serial to initialize
+  UNITY_BEGIN();  // Start Unity test framework
+}
+
+uint8_t i = 0;
+uint8_t max_blinks = 1;
+
+void loop()
+{
+  if (i < max_blinks)
+  {
+    RUN_TEST(test_mulS16);
+    delay(100);
+    RUN_TEST(test_cycle_cost);
+    delay(100);
+    ++i;
+  }
+  else if (i == max_blinks)
+  {
+    UNITY_END();  // End Unity test framework
+  }
+}
@@ -0,0 +1,111 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "phase_cal.h"  // Include the header file for the functions to test
+
+constexpr int16_t kPhaseCal{ 207 };  // ~4° of CT lag @ 50 Hz, 3 phases
+constexpr uint8_t kRuns{ 100 };
+
+volatile int32_t lastSampleV{ -12345L * 4 };  // volatile, so that nothing is computed at compile time
+volatile int32_t sampleV{ 23456L * 4 };
+volatile int32_t result{ 0 };
+
+/**
+ * @brief Float version of the phaseCal algorithm, as a reference
+ */
+int32_t phaseShiftedSampleVFloat(const int32_t last, const int32_t sample)
+{
+  return last + static_cast< int32_t >((sample - last) * (kPhaseCal / 256.0F));
+}
+
+/**
+ * @brief Average number of CPU cycles of one interpolation, Timer1 running at the CPU clock
+ */
+template< typename F >
+uint16_t measureCycles(F interpolate)
+{
+  TCCR1A = 0;
+  TCCR1B = bit(CS10);
+  TIMSK1 = 0;
+
+  // cost of the measurement itself
+  uint8_t oldSREG{ SREG };
+  cli();
+  uint16_t start{ TCNT1 };
+  result = lastSampleV + sampleV;
+  const uint16_t overhead{ static_cast< uint16_t >(TCNT1 - start) };
+  SREG = oldSREG;
+
+  uint32_t total{ 0 };
+  for (uint8_t i = 0; i < kRuns; ++i)
+  {
+    oldSREG = SREG;
+    cli();
+    start = TCNT1;
+    result = interpolate(lastSampleV, sampleV);
+    total += static_cast< uint16_t >(TCNT1 - start) - overhead;
+    SREG = oldSREG;
+  }
+
+  return total / kRuns;
+}
+
+void setUp(void)
+{
+  // Set up code here (if needed)
+}
+
+void tearDown(void)
+{
+  // Clean up code here (if needed)
+}
+
+void test_integer_matches_float(void)
+{
+  const int32_t expected{ phaseShiftedSampleVFloat(lastSampleV, sampleV) };
+
+  TEST_ASSERT_INT32_WITHIN(1, expected, phaseShiftedSampleV(lastSampleV, sampleV, kPhaseCal));
+}
+
+void test_integer_cycle_cost(void)
+{
+  const uint16_t cyclesInteger{ measureCycles([](const int32_t last, const int32_t sample) {
+    return phaseShiftedSampleV(last, sample, kPhaseCal);
+  }) };
+  const uint16_t cyclesFloat{ measureCycles([](const int32_t last, const int32_t sample) {
+    return phaseShiftedSampleVFloat(last, sample);
+  }) };
+
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "phaseCal: integer %u cycles, float %u cycles", cyclesInteger, cyclesFloat);
+  TEST_MESSAGE(buffer);
+
+  // each ADC conversion lasts 1664 CPU cycles, the whole ISR must fit in it
+  TEST_ASSERT_TRUE(cyclesInteger < 100);
+  TEST_ASSERT_TRUE(cyclesInteger * 4 < cyclesFloat);
+}
+
+void setup()
+{
+  delay(1000);    // Wait for Serial to initialize
+  UNITY_BEGIN();  // Start Unity test framework
+}
+
+uint8_t i = 0;
+uint8_t max_blinks = 1;
+
+void loop()
+{
+  if (i < max_blinks)
+  {
+    RUN_TEST(test_integer_matches_float);
+    delay(100);
+    RUN_TEST(test_integer_cycle_cost);
+    delay(100);
+    ++i;
+  }
+  else if (i == max_blinks)
+  {
+    UNITY_END();  // End Unity test framework
+  }
+}
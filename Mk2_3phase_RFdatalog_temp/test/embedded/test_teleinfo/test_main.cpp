@@ -4,6 +4,43 @@
 #include "teleinfo.h"
 #include "config_system.h"
 
+#include <string.h>
+
+/**
+ * @brief Checks the content of the current frame of a TeleInfo object
+ */
+#define TEST_ASSERT_FRAME(expected, teleinfo)                                    \
+  do                                                                             \
+  {                                                                              \
+    TEST_ASSERT_EQUAL(sizeof(expected) - 1, (teleinfo).size());                  \
+    TEST_ASSERT_EQUAL_MEMORY((expected), (teleinfo).data(), sizeof(expected) - 1); \
+  } while (0)
+
+/**
+ * @brief Line formatting before the single-pass formatter: itoa(), strlen(), then a checksum pass
+ */
+size_t legacyLine(char* buffer, const char* tag, int16_t value)
+{
+  size_t pos{ 0 };
+  buffer[pos++] = 0x0A;
+  const size_t startPos{ pos };
+  while (*tag) buffer[pos++] = *tag++;
+  buffer[pos++] = 0x09;
+  auto str = itoa(value, buffer + pos, 10);
+  pos += strlen(str);
+  buffer[pos++] = 0x09;
+  uint8_t sum{ 0 };
+  for (size_t i = startPos; i < pos; ++i)
+  {
+    sum += buffer[i];
+  }
+  buffer[pos++] = (sum & 0x3F) + 0x20;
+  buffer[pos++] = 0x0D;
+  return pos;
+}
+
+volatile int16_t benchmarkValue{ -31234 };  // volatile, so that nothing is computed at compile time
+
 void setUp(void)
 {
   // Setup for each test
@@ -123,6 +160,94 @@ void test_teleinfo_long_sequences(void)
   TEST_ASSERT_TRUE(true);
 }
 
+void test_teleinfo_exact_frame(void)
+{
+  // Expected bytes: STX, then for each line LF tag TAB value TAB checksum CR, then ETX
+  TeleInfo teleinfo;
+
+  teleinfo.startFrame();
+  teleinfo.send("P", 1234);
+  teleinfo.send("V", 23012, 1);
+  teleinfo.send("T", -15, 2);
+  teleinfo.endFrame();
+
+  TEST_ASSERT_FRAME("\x02"
+                    "\nP\t1234\tL\r"
+                    "\nV1\t23012\t1\r"
+                    "\nT2\t-15\tK\r"
+                    "\x03",
+                    teleinfo);
+}
+
+void test_teleinfo_exact_edge_values(void)
+{
+  TeleInfo teleinfo;
+
+  teleinfo.startFrame();
+  teleinfo.send("ZERO", 0);
+  teleinfo.send("MIN", -32768);
+  teleinfo.send("S", static_cast< uint16_t >(65535));  // no longer truncated to int16_t
+  teleinfo.send("P", 100000L);                         // e.g. a sum of powers
+  teleinfo.send("BIG", INT32_MIN);
+  teleinfo.send("EI", "18446744073709551615");
+  teleinfo.endFrame();
+
+  TEST_ASSERT_FRAME("\x02"
+                    "\nZERO\t0\t\"\r"
+                    "\nMIN\t-32768\tM\r"
+                    "\nS\t65535\tM\r"
+                    "\nP\t100000\t#\r"
+                    "\nBIG\t-2147483648\t@\r"
+                    "\nEI\t18446744073709551615\tW\r"
+                    "\x03",
+                    teleinfo);
+}
+
+void test_teleinfo_matches_legacy_format(void)
+{
+  TeleInfo teleinfo;
+  char expected[32];
+
+  for (int32_t value = -32768; value <= 32767; value += 97)
+  {
+    teleinfo.startFrame();
+    teleinfo.send("PHC", static_cast< int16_t >(value));
+
+    const size_t size{ legacyLine(expected, "PHC", static_cast< int16_t >(value)) };
+    TEST_ASSERT_EQUAL(1 + size, teleinfo.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected, teleinfo.data() + 1, size);
+  }
+}
+
+void test_teleinfo_cycle_count(void)
+{
+  TeleInfo teleinfo;
+  char buffer[32];
+
+  TCCR1A = 0;
+  TCCR1B = bit(CS10);  // Timer1 at the CPU clock
+  TIMSK1 = 0;
+
+  const uint8_t oldSREG{ SREG };
+  cli();
+
+  uint16_t start{ TCNT1 };
+  legacyLine(buffer, "P1", benchmarkValue);
+  const uint16_t cyclesLegacy{ static_cast< uint16_t >(TCNT1 - start) };
+
+  teleinfo.startFrame();
+  start = TCNT1;
+  teleinfo.send("P", benchmarkValue, 1);
+  const uint16_t cyclesSinglePass{ static_cast< uint16_t >(TCNT1 - start) };
+
+  SREG = oldSREG;
+
+  snprintf(buffer, sizeof(buffer), "line: %u cycles, was %u", cyclesSinglePass, cyclesLegacy);
+  TEST_MESSAGE(buffer);
+
+  TEST_ASSERT_TRUE(cyclesSinglePass < cyclesLegacy);
+}
+
 void setup()
 {
   delay(2000);  // Give time for Serial to initialize
@@ -142,6 +267,10 @@ void loop()
   RUN_TEST(test_teleinfo_edge_values);
   RUN_TEST(test_teleinfo_multiple_frames);
   RUN_TEST(test_teleinfo_long_sequences);
+  RUN_TEST(test_teleinfo_exact_frame);
+  RUN_TEST(test_teleinfo_exact_edge_values);
+  RUN_TEST(test_teleinfo_matches_legacy_format);
+  RUN_TEST(test_teleinfo_cycle_count);
 
   Serial.println("All TeleInfo tests completed!");
 
@@ -0,0 +1,192 @@
+#include <unity.h>
+
+#include "adc_sequence.h"
+#include "processing.h"
+
+namespace
+{
+constexpr uint8_t kSensorV1[1]{ 0 };
+constexpr uint8_t kSensorI1[1]{ 1 };
+constexpr uint8_t kSensorV2[2]{ 0, 2 };
+constexpr uint8_t kSensorI2[2]{ 1, 3 };
+constexpr uint8_t kSensorV3[3]{ 0, 2, 4 };
+constexpr uint8_t kSensorI3[3]{ 1, 3, 5 };
+
+constexpr uint32_t kConversionTimeInMicroseconds{ 104 }; /**< 13 ADC clocks @ 16 MHz / 128 */
+
+// the sequence is usable at compile time
+static_assert(makeAdcSequence(kSensorV3, kSensorI3).steps[0].nextChannel == 2);
+static_assert(makeAdcSequence(kSensorV3, kSensorI3).steps[5].nextChannel == 1);
+static_assert(makeAdcSequence(kSensorV1, kSensorI1).size == 2);
+
+/**
+ * @brief Emulates the ADC. In free-running mode (look-ahead of 2), when a conversion finishes,
+ *        the next one has already started with the previously selected channel. In Timer1-triggered
+ *        mode (look-ahead of 1), the next one starts after the ISR with the channel it has selected.
+ *
+ * @details Counts the results handed to an ISR step expecting another channel, and the number
+ *          of complete sample sets during 'durationInMicroseconds'.
+ */
+struct RunResult
+{
+  uint32_t sampleSets{ 0 };
+  uint32_t mismatches{ 0 };
+};
+
+template< uint8_t N >
+RunResult runSequence(const AdcSequence< N >& sequence, const uint8_t (&channelV)[N], const uint8_t (&channelI)[N], const uint32_t durationInMicroseconds, const uint8_t lookAhead = 2)
+{
+  uint8_t channelConverting{ channelV[0] };
+  uint8_t channelSelected{ lookAhead == 2 ? channelI[0] : channelV[0] };
+  uint8_t index{ 0 };
+  RunResult result;
+
+  for (uint32_t t = 0; t < durationInMicroseconds; t += kConversionTimeInMicroseconds)
+  {
+    const uint8_t channelDone{ channelConverting };
+    if (lookAhead == 2)
+    {
+      channelConverting = channelSelected;  // free-running: starts immediately
+    }
+
+    const auto& step{ sequence.steps[index] };
+    const uint8_t expected{ step.voltage ? channelV[step.phase] : channelI[step.phase] };
+
+    if (expected != channelDone)
+    {
+      ++result.mismatches;
+    }
+
+    channelSelected = step.nextChannel;
+    if (lookAhead == 1)
+    {
+      channelConverting = channelSelected;  // triggered: starts after the ISR
+    }
+    if (++index == sequence.size)
+    {
+      index = 0;
+      ++result.sampleSets;
+    }
+  }
+
+  return result;
+}
+
+template< uint8_t N >
+void checkSequence(const uint8_t (&channelV)[N], const uint8_t (&channelI)[N])
+{
+  const auto sequence{ makeAdcSequence(channelV, channelI) };
+
+  TEST_ASSERT_EQUAL_UINT8(2 * N, sequence.size);
+
+  for (uint8_t i = 0; i < sequence.size; ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT8(i / 2, sequence.steps[i].phase);
+    TEST_ASSERT_EQUAL(i % 2 == 0, sequence.steps[i].voltage);
+  }
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_sequence_layout(void)
+{
+  checkSequence(kSensorV1, kSensorI1);
+  checkSequence(kSensorV2, kSensorI2);
+  checkSequence(kSensorV3, kSensorI3);
+}
+
+void test_look_ahead_three_phases(void)
+{
+  constexpr auto sequence{ makeAdcSequence(kSensorV3, kSensorI3) };
+
+  // same channels as the former hand-written switch
+  const uint8_t expected[]{ 2, 3, 4, 5, 0, 1 };
+  for (uint8_t i = 0; i < sequence.size; ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT8(expected[i], sequence.steps[i].nextChannel);
+  }
+}
+
+void test_look_ahead_single_phase(void)
+{
+  constexpr auto sequence{ makeAdcSequence(kSensorV1, kSensorI1) };
+
+  // with only 2 conversions per set, the conversion after next is the same type
+  TEST_ASSERT_EQUAL_UINT8(kSensorV1[0], sequence.steps[0].nextChannel);
+  TEST_ASSERT_EQUAL_UINT8(kSensorI1[0], sequence.steps[1].nextChannel);
+}
+
+void test_look_ahead_triggered(void)
+{
+  constexpr auto sequence3{ makeAdcSequence(kSensorV3, kSensorI3, 1) };
+  constexpr auto sequence1{ makeAdcSequence(kSensorV1, kSensorI1, 1) };
+
+  // the channel of the next conversion
+  const uint8_t expected[]{ 1, 2, 3, 4, 5, 0 };
+  for (uint8_t i = 0; i < sequence3.size; ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT8(expected[i], sequence3.steps[i].nextChannel);
+  }
+  TEST_ASSERT_EQUAL_UINT8(kSensorI1[0], sequence1.steps[0].nextChannel);
+  TEST_ASSERT_EQUAL_UINT8(kSensorV1[0], sequence1.steps[1].nextChannel);
+
+  TEST_ASSERT_EQUAL_UINT32(0, runSequence(sequence3, kSensorV3, kSensorI3, 1000000, 1).mismatches);
+  TEST_ASSERT_EQUAL_UINT32(0, runSequence(sequence1, kSensorV1, kSensorI1, 1000000, 1).mismatches);
+
+  // a free-running sequence is wrong when triggered, and vice versa
+  TEST_ASSERT_NOT_EQUAL(0, runSequence(makeAdcSequence(kSensorV3, kSensorI3), kSensorV3, kSensorI3, 1000000, 1).mismatches);
+  TEST_ASSERT_NOT_EQUAL(0, runSequence(sequence3, kSensorV3, kSensorI3, 1000000, 2).mismatches);
+}
+
+void test_firmware_sequence_matches_configuration(void)
+{
+  TEST_ASSERT_EQUAL_UINT8(2 * NO_OF_PHASES, adcSequence.size);
+  TEST_ASSERT_EQUAL_UINT32(0, runSequence(adcSequence, sensorV, sensorI, 1000000, ADC_LOOK_AHEAD).mismatches);
+}
+
+void test_sample_sets_per_mains_cycle(void)
+{
+  // 1 s of conversions, then per mains cycle
+  const auto run1{ runSequence(makeAdcSequence(kSensorV1, kSensorI1), kSensorV1, kSensorI1, 1000000) };
+  const auto run2{ runSequence(makeAdcSequence(kSensorV2, kSensorI2), kSensorV2, kSensorI2, 1000000) };
+  const auto run3{ runSequence(makeAdcSequence(kSensorV3, kSensorI3), kSensorV3, kSensorI3, 1000000) };
+
+  TEST_ASSERT_EQUAL_UINT32(0, run1.mismatches);
+  TEST_ASSERT_EQUAL_UINT32(0, run2.mismatches);
+  TEST_ASSERT_EQUAL_UINT32(0, run3.mismatches);
+
+  const uint32_t sets1{ run1.sampleSets };
+  const uint32_t sets2{ run2.sampleSets };
+  const uint32_t sets3{ run3.sampleSets };
+
+  // 50 Hz: 20 ms / (104 µs * 2 * N)
+  TEST_ASSERT_EQUAL_UINT32(96, sets1 / 50);
+  TEST_ASSERT_EQUAL_UINT32(48, sets2 / 50);
+  TEST_ASSERT_EQUAL_UINT32(32, sets3 / 50);
+
+  // 60 Hz
+  TEST_ASSERT_EQUAL_UINT32(80, sets1 / 60);
+  TEST_ASSERT_EQUAL_UINT32(40, sets2 / 60);
+  TEST_ASSERT_EQUAL_UINT32(26, sets3 / 60);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_sequence_layout);
+  RUN_TEST(test_look_ahead_three_phases);
+  RUN_TEST(test_look_ahead_single_phase);
+  RUN_TEST(test_look_ahead_triggered);
+  RUN_TEST(test_firmware_sequence_matches_configuration);
+  RUN_TEST(test_sample_sets_per_mains_cycle);
+
+  return UNITY_END();
+}
@@ -0,0 +1,100 @@
+#include <unity.h>
+
+#include "adc_timing.h"
+#include "energy_bucket.h"
+#include "hal.h"
+#include "pll.h"
+#include "processing.h"
+
+namespace
+{
+/**
+ * @brief Mid-point of the ADC on all the channels
+ */
+int16_t flatSample(const uint8_t)
+{
+  return 512;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_sample_period(void)
+{
+  if constexpr (ADC_TIMER_TRIGGERED)
+  {
+    TEST_ASSERT_EQUAL_UINT16(ADC_TIMER_PERIOD, ADC_SAMPLE_PERIOD_CYCLES);
+    TEST_ASSERT_EQUAL_UINT8(1, ADC_LOOK_AHEAD);
+  }
+  else
+  {
+    TEST_ASSERT_EQUAL_UINT16(ADC_PRESCALER * 13U, ADC_SAMPLE_PERIOD_CYCLES);
+    TEST_ASSERT_EQUAL_UINT8(2, ADC_LOOK_AHEAD);
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(ADC_PRESCALER_64 ? 64 : 128, ADC_PRESCALER);
+  TEST_ASSERT_INT_WITHIN(1, ADC_SAMPLE_PERIOD_CYCLES / (F_CPU / 1000000UL), ADC_SAMPLE_PERIOD_US);
+}
+
+void test_default_free_running(void)
+{
+  if constexpr (ADC_TIMER_TRIGGERED || ADC_PRESCALER_64)
+  {
+    TEST_IGNORE();
+  }
+
+  // 13 ADC clocks @ 16 MHz / 128
+  TEST_ASSERT_EQUAL_UINT16(1664, ADC_SAMPLE_PERIOD_CYCLES);
+  TEST_ASSERT_EQUAL_UINT16(104, ADC_SAMPLE_PERIOD_US);
+
+  // the former hard-coded constants
+  TEST_ASSERT_EQUAL_UINT32(static_cast< uint32_t >(F_CPU * 25600ULL / (128UL * 13UL * 2UL * NO_OF_PHASES)), ADC_SAMPLE_SETS_PER_SECOND_X100_Q8);
+  TEST_ASSERT_EQUAL_UINT8((F_CPU / (128UL * 13UL * 2UL * NO_OF_PHASES) + SUPPLY_FREQUENCY / 2) / SUPPLY_FREQUENCY, NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);
+  TEST_ASSERT_EQUAL_UINT8(17 * 3 / NO_OF_PHASES, MIN_SAMPLES_FOR_RECIPROCAL);
+  TEST_ASSERT_EQUAL_UINT8(48 * 3 / NO_OF_PHASES, MAX_SAMPLES_FOR_RECIPROCAL);
+}
+
+void test_derived_rates(void)
+{
+  const double setsPerSecond{ static_cast< double >(F_CPU) / (ADC_SAMPLE_PERIOD_CYCLES * 2.0 * NO_OF_PHASES) };
+
+  TEST_ASSERT_EQUAL_UINT32(static_cast< uint32_t >(setsPerSecond * 25600), ADC_SAMPLE_SETS_PER_SECOND_X100_Q8);
+  TEST_ASSERT_EQUAL_UINT32(PLL_SAMPLE_SETS_PER_SECOND_X100_Q8, ADC_SAMPLE_SETS_PER_SECOND_X100_Q8);
+  TEST_ASSERT_EQUAL_UINT16(static_cast< uint16_t >(setsPerSecond), ADC_SAMPLE_SETS_PER_SECOND);
+  TEST_ASSERT_EQUAL_UINT8(static_cast< uint8_t >(setsPerSecond / SUPPLY_FREQUENCY + 0.5), NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);
+
+  // the table of reciprocals covers the mains frequencies accepted by the PLL
+  TEST_ASSERT_TRUE(MIN_SAMPLES_FOR_RECIPROCAL <= setsPerSecond / 66);
+  TEST_ASSERT_TRUE(MAX_SAMPLES_FOR_RECIPROCAL >= static_cast< uint16_t >(setsPerSecond / 44));
+}
+
+void test_emulated_clock_does_not_drift(void)
+{
+  HAL::Native::reset();
+  HAL::Native::setADCSource(flatSample);
+  initializeProcessing();
+
+  // the fractional µs of the sample period are carried over
+  constexpr uint32_t conversions{ 100000 };
+  HAL::Native::runADCConversions(conversions);
+
+  TEST_ASSERT_EQUAL_UINT32(conversions * ADC_SAMPLE_PERIOD_CYCLES / (F_CPU / 1000000UL), micros());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_sample_period);
+  RUN_TEST(test_default_free_running);
+  RUN_TEST(test_derived_rates);
+  RUN_TEST(test_emulated_clock_does_not_drift);
+
+  return UNITY_END();
+}
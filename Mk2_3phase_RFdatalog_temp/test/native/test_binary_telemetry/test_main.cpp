@@ -0,0 +1,205 @@
+#include <unity.h>
+
+#include "binary_telemetry.h"
+#include "decoder/telemetry_decoder.h"
+
+using TelemetryDecoder::Status;
+using TelemetryDecoder::StreamDecoder;
+using TelemetryDecoder::Telemetry;
+
+namespace
+{
+using Payload = BinaryPayload_struct< 3, 2, 2, 3 >;
+
+/**
+ * @brief Builds a payload with a value in each field
+ */
+Payload makePayload(const uint8_t sequence)
+{
+  Payload payload;
+
+  payload.header.sequence = sequence;
+  payload.header.flags = BINARY_FLAG_FREQUENCY | BINARY_FLAG_RELAYS | BINARY_FLAG_DUAL_TARIFF | BINARY_FLAG_OFF_PEAK;
+  payload.data.power = -1234;
+  payload.data.power_L[0] = 500;
+  payload.data.power_L[1] = -2000;
+  payload.data.power_L[2] = 266;
+  payload.data.Vrms_L_x100[0] = 23012;
+  payload.data.Vrms_L_x100[1] = 22950;
+  payload.data.Vrms_L_x100[2] = 0;  // zero bytes are stuffed by COBS
+  payload.data.temperature_x100[0] = 5525;
+  payload.data.temperature_x100[1] = -12700;
+  payload.frequency_x100 = 4998;
+  payload.loadDuty_x2[0] = 200;
+  payload.loadDuty_x2[1] = 73;
+  payload.relayAverage = -850;
+  payload.relayStates = 0b101;
+  payload.absenceOfDivertedEnergyCount = 3600;
+  payload.sampleSets = 7812;
+  payload.lowestNoOfSampleSetsPerMainsCycle = 31;
+
+  return payload;
+}
+
+/**
+ * @brief Encodes a payload and feeds the frame to a decoder
+ */
+bool feed(StreamDecoder& decoder, const Payload& payload, Telemetry& telemetry)
+{
+  uint8_t frame[binaryFrameSize(sizeof(Payload))];
+  const size_t size{ encodeBinaryFrame(payload, frame) };
+  bool decoded{ false };
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    decoded = decoder.feed(frame[i], telemetry);
+  }
+  return decoded;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_crc16_check_value(void)
+{
+  const uint8_t data[]{ '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16(data, sizeof(data)));  // CRC-16/CCITT-FALSE
+}
+
+void test_cobs_round_trip(void)
+{
+  uint8_t in[600];
+  uint8_t out[600 + 600 / 254 + 1];
+  std::vector< uint8_t > decoded;
+
+  // runs of non-zero bytes longer than a COBS block, and zeros at both ends
+  for (size_t i = 0; i < sizeof(in); ++i)
+  {
+    in[i] = (i % 300) ? static_cast< uint8_t >(i) | 1 : 0;
+  }
+  in[sizeof(in) - 1] = 0;
+
+  for (size_t size : { size_t{ 0 }, size_t{ 1 }, size_t{ 253 }, size_t{ 254 }, size_t{ 255 }, sizeof(in) })
+  {
+    const size_t encodedSize{ cobsEncode(in, size, out) };
+
+    TEST_ASSERT_TRUE(encodedSize <= size + size / 254 + 1);
+    for (size_t i = 0; i < encodedSize; ++i)
+    {
+      TEST_ASSERT_NOT_EQUAL(0, out[i]);
+    }
+
+    TEST_ASSERT_TRUE(TelemetryDecoder::cobsDecode(out, encodedSize, decoded));
+    TEST_ASSERT_EQUAL_UINT32(size, decoded.size());
+    TEST_ASSERT_EQUAL_MEMORY(in, decoded.data(), size);
+  }
+}
+
+void test_frame_round_trip(void)
+{
+  StreamDecoder decoder;
+  Telemetry telemetry;
+
+  TEST_ASSERT_TRUE(feed(decoder, makePayload(42), telemetry));
+
+  TEST_ASSERT_EQUAL_UINT8(BINARY_TELEMETRY_VERSION, telemetry.version);
+  TEST_ASSERT_EQUAL_UINT8(42, telemetry.sequence);
+  TEST_ASSERT_TRUE(telemetry.offPeak);
+  TEST_ASSERT_TRUE(telemetry.dualTariff);
+  TEST_ASSERT_TRUE(telemetry.relayDiversion);
+  TEST_ASSERT_TRUE(telemetry.frequencyValid);
+
+  TEST_ASSERT_EQUAL_INT16(-1234, telemetry.power);
+  TEST_ASSERT_EQUAL_UINT32(3, telemetry.power_L.size());
+  TEST_ASSERT_EQUAL_INT16(500, telemetry.power_L[0]);
+  TEST_ASSERT_EQUAL_INT16(-2000, telemetry.power_L[1]);
+  TEST_ASSERT_EQUAL_INT16(266, telemetry.power_L[2]);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 230.12F, telemetry.Vrms_L[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 229.50F, telemetry.Vrms_L[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 0.0F, telemetry.Vrms_L[2]);
+
+  TEST_ASSERT_EQUAL_UINT32(2, telemetry.temperature_x100.size());
+  TEST_ASSERT_EQUAL_INT16(5525, telemetry.temperature_x100[0]);
+  TEST_ASSERT_EQUAL_INT16(-12700, telemetry.temperature_x100[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 55.25F, telemetry.temperature[0]);
+
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 49.98F, telemetry.frequency);
+
+  TEST_ASSERT_EQUAL_UINT32(2, telemetry.loadDutyInPercent.size());
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 100.0F, telemetry.loadDutyInPercent[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.001F, 36.5F, telemetry.loadDutyInPercent[1]);
+
+  TEST_ASSERT_EQUAL_INT16(-850, telemetry.relayAverage);
+  TEST_ASSERT_EQUAL_UINT32(3, telemetry.relayON.size());
+  TEST_ASSERT_TRUE(telemetry.relayON[0]);
+  TEST_ASSERT_FALSE(telemetry.relayON[1]);
+  TEST_ASSERT_TRUE(telemetry.relayON[2]);
+
+  TEST_ASSERT_EQUAL_UINT16(3600, telemetry.absenceOfDivertedEnergyCount);
+  TEST_ASSERT_EQUAL_UINT16(7812, telemetry.sampleSets);
+  TEST_ASSERT_EQUAL_UINT8(31, telemetry.lowestNoOfSampleSetsPerMainsCycle);
+
+  TEST_ASSERT_EQUAL_UINT32(1, decoder.getFrames());
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.getErrors());
+}
+
+void test_corrupted_frame_is_rejected(void)
+{
+  uint8_t frame[binaryFrameSize(sizeof(Payload))];
+  const size_t size{ encodeBinaryFrame(makePayload(0), frame) };
+  Telemetry telemetry;
+
+  for (size_t i = 0; i < size - 1; ++i)
+  {
+    uint8_t corrupted[sizeof(frame)];
+    memcpy(corrupted, frame, size);
+    corrupted[i] ^= (corrupted[i] == 0x10) ? 0x20 : 0x10;  // never creates a delimiter
+
+    TEST_ASSERT_TRUE(TelemetryDecoder::decodeFrame(corrupted, size - 1, telemetry) != Status::OK);
+  }
+
+  TEST_ASSERT_TRUE(TelemetryDecoder::decodeFrame(frame, size - 1, telemetry) == Status::OK);
+}
+
+void test_stream_resynchronizes_and_counts_lost_frames(void)
+{
+  StreamDecoder decoder;
+  Telemetry telemetry;
+  uint8_t frame[binaryFrameSize(sizeof(Payload))];
+
+  // the decoder joins in the middle of a frame
+  const size_t size{ encodeBinaryFrame(makePayload(9), frame) };
+  for (size_t i = size / 2; i < size; ++i)
+  {
+    TEST_ASSERT_FALSE(decoder.feed(frame[i], telemetry));
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, decoder.getErrors());
+
+  TEST_ASSERT_TRUE(feed(decoder, makePayload(10), telemetry));
+  TEST_ASSERT_TRUE(feed(decoder, makePayload(11), telemetry));
+  TEST_ASSERT_TRUE(feed(decoder, makePayload(14), telemetry));  // 12 and 13 lost
+  TEST_ASSERT_EQUAL_UINT8(14, telemetry.sequence);
+
+  TEST_ASSERT_EQUAL_UINT32(3, decoder.getFrames());
+  TEST_ASSERT_EQUAL_UINT32(2, decoder.getLostFrames());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_cobs_round_trip);
+  RUN_TEST(test_frame_round_trip);
+  RUN_TEST(test_corrupted_frame_is_rejected);
+  RUN_TEST(test_stream_resynchronizes_and_counts_lost_frames);
+
+  return UNITY_END();
+}
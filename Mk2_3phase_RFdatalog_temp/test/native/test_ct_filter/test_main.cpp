@@ -0,0 +1,100 @@
+#include <unity.h>
+#include <cmath>
+
+#include "ct_filter.h"
+
+namespace
+{
+constexpr double kPi{ 3.14159265358979323846 };
+constexpr float kAlpha{ 0.002F };
+constexpr float kGain{ 8.0F };
+constexpr uint16_t kAlphaQ16{ initLpfCoefficient(kAlpha, 16) };
+constexpr uint16_t kGainQ{ initLpfCoefficient(kGain, 16 - LPF_FRACTION_BITS) };
+
+constexpr uint16_t kSamplesPerCycle{ 32 }; /**< sample sets per mains cycle, 3 phases @ 50 Hz */
+
+/**
+ * @brief Current sample minus DC (x256), 10 cycles of mains plus a DC step
+ */
+int32_t currentSample(const uint16_t n, const double amplitude)
+{
+  return static_cast< int32_t >(256 * amplitude * sin(2 * kPi * n / kSamplesPerCycle)) + (n > 3200 ? 256 * 20 : 0);
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_coefficients(void)
+{
+  TEST_ASSERT_EQUAL_UINT16(131, initLpfCoefficient(0.002F, 16));
+  TEST_ASSERT_EQUAL_UINT16(2048, initLpfCoefficient(8.0F, 8));
+  TEST_ASSERT_EQUAL_UINT16(0, initLpfCoefficient(0.0F, 8));
+}
+
+void test_disabled_filter_is_identity(void)
+{
+  int32_t state{ 12345 };
+
+  for (uint16_t n = 0; n < 1000; ++n)
+  {
+    const int32_t sample{ currentSample(n, 400) };
+    TEST_ASSERT_EQUAL_INT32(sample, (compensateCtHighPass< kAlphaQ16, 0 >(state, sample)));
+  }
+  TEST_ASSERT_EQUAL_INT32(12345, state);
+}
+
+void test_integer_matches_ideal_filter(void)
+{
+  constexpr double amplitudes[]{ 5.0, 50.0, 500.0 };
+
+  for (const double amplitude : amplitudes)
+  {
+    int32_t state{ 0 };
+    double lpf{ 0 };
+
+    for (uint16_t n = 0; n < 6400; ++n)
+    {
+      const int32_t sample{ currentSample(n, amplitude) };
+
+      lpf += kAlpha * (sample - lpf);
+      const int32_t expected{ sample + static_cast< int32_t >(kGain * lpf) };
+
+      const int32_t actual{ compensateCtHighPass< kAlphaQ16, kGainQ >(state, sample) };
+      const int32_t correction{ expected > sample ? expected - sample : sample - expected };
+
+      // within 1% of the correction, or 1 LSB of the ADC
+      TEST_ASSERT_INT_WITHIN(256 + correction / 100, expected, actual);
+    }
+  }
+}
+
+void test_no_dead_zone(void)
+{
+  // a small constant current must still charge the filter, even with alpha * (sample - lpf) < 1
+  int32_t state{ 0 };
+  int32_t result{ 0 };
+
+  for (uint16_t n = 0; n < 10000; ++n)
+  {
+    result = compensateCtHighPass< kAlphaQ16, kGainQ >(state, 100);
+  }
+
+  // the remaining dead zone is 2^16 / kAlphaQ16 >> LPF_FRACTION_BITS, ~2 (x256)
+  TEST_ASSERT_INT_WITHIN(2 * 8 + 1, 100 + 8 * 100, result);
+}
+
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_coefficients);
+  RUN_TEST(test_disabled_filter_is_identity);
+  RUN_TEST(test_integer_matches_ideal_filter);
+  RUN_TEST(test_no_dead_zone);
+  return UNITY_END();
+}
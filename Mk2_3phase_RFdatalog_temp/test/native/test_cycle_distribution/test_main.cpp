@@ -0,0 +1,160 @@
+#include <unity.h>
+
+#include "cycle_distribution.h"
+
+namespace
+{
+/**
+ * @brief Counts the ON cycles and the longest runs of identical states of one load
+ */
+struct LoadPattern
+{
+  uint16_t cyclesON{ 0 };
+  uint16_t switches{ 0 };
+  uint16_t longestON{ 0 };
+  uint16_t longestOFF{ 0 };
+};
+
+template< uint8_t N >
+LoadPattern runLoad(CycleDistributor< N >& distributor, const uint16_t demand, const uint8_t load, const uint16_t cycles)
+{
+  LoadPattern pattern;
+  bool previous{ false };
+  uint16_t run{ 0 };
+
+  for (uint16_t i = 0; i < cycles; ++i)
+  {
+    distributor.update(demand);
+    const bool on{ distributor.isOn(load) };
+
+    if (on)
+    {
+      ++pattern.cyclesON;
+    }
+    if (i && on != previous)
+    {
+      ++pattern.switches;
+      run = 0;
+    }
+    ++run;
+
+    uint16_t& longest{ on ? pattern.longestON : pattern.longestOFF };
+    if (run > longest)
+    {
+      longest = run;
+    }
+    previous = on;
+  }
+  return pattern;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_no_demand_all_off(void)
+{
+  CycleDistributor< 3 > distributor;
+
+  for (uint16_t i = 0; i < 1000; ++i)
+  {
+    distributor.update(0);
+    TEST_ASSERT_FALSE(distributor.isOn(0));
+    TEST_ASSERT_FALSE(distributor.isOn(1));
+    TEST_ASSERT_FALSE(distributor.isOn(2));
+  }
+}
+
+void test_full_demand_all_on(void)
+{
+  CycleDistributor< 3 > distributor;
+
+  for (uint16_t i = 0; i < 1000; ++i)
+  {
+    distributor.update(CycleDistributor< 3 >::MAX_DEMAND);
+    TEST_ASSERT_TRUE(distributor.isOn(0));
+    TEST_ASSERT_TRUE(distributor.isOn(1));
+    TEST_ASSERT_TRUE(distributor.isOn(2));
+  }
+}
+
+void test_duty_is_exact(void)
+{
+  // over FULL_DUTY cycles, a load with a duty of d / FULL_DUTY is ON exactly d times
+  for (uint16_t duty = 0; duty <= FULL_DUTY; ++duty)
+  {
+    CycleDistributor< 1 > distributor;
+    TEST_ASSERT_EQUAL_UINT16(duty, runLoad(distributor, duty, 0, FULL_DUTY).cyclesON);
+  }
+}
+
+void test_on_cycles_are_spread_evenly(void)
+{
+  for (uint16_t duty = 1; duty < FULL_DUTY; ++duty)
+  {
+    CycleDistributor< 1 > distributor;
+    const auto pattern{ runLoad(distributor, duty, 0, 10 * FULL_DUTY) };
+
+    // the runs never exceed the ideal ones, rounded up
+    const uint16_t idealON{ static_cast< uint16_t >((duty + FULL_DUTY - duty - 1) / (FULL_DUTY - duty)) };
+    const uint16_t idealOFF{ static_cast< uint16_t >((FULL_DUTY - duty + duty - 1) / duty) };
+
+    TEST_ASSERT_TRUE(pattern.longestON <= idealON);
+    TEST_ASSERT_TRUE(pattern.longestOFF <= idealOFF);
+  }
+}
+
+void test_loads_filled_by_priority(void)
+{
+  CycleDistributor< 3 > distributor;
+
+  // 1.5 loads: the first one fully ON, the second one every other cycle, the last one OFF
+  uint16_t cyclesON[3]{};
+  for (uint16_t i = 0; i < 100; ++i)
+  {
+    distributor.update(FULL_DUTY + FULL_DUTY / 2);
+    for (uint8_t load = 0; load < 3; ++load)
+    {
+      cyclesON[load] += distributor.isOn(load);
+    }
+    if (i)
+    {
+      TEST_ASSERT_TRUE(distributor.isOn(1) == (i % 2 == 1));
+    }
+  }
+
+  TEST_ASSERT_EQUAL_UINT16(100, cyclesON[0]);
+  TEST_ASSERT_EQUAL_UINT16(50, cyclesON[1]);
+  TEST_ASSERT_EQUAL_UINT16(0, cyclesON[2]);
+}
+
+void test_quarter_duty_pattern(void)
+{
+  CycleDistributor< 1 > distributor;
+
+  // a duty of 1/4: ON, OFF, OFF, OFF, ... i.e. one ON cycle every 4 cycles
+  const auto pattern{ runLoad(distributor, FULL_DUTY / 4, 0, 400) };
+
+  TEST_ASSERT_EQUAL_UINT16(100, pattern.cyclesON);
+  TEST_ASSERT_EQUAL_UINT16(1, pattern.longestON);
+  TEST_ASSERT_EQUAL_UINT16(3, pattern.longestOFF);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_no_demand_all_off);
+  RUN_TEST(test_full_demand_all_on);
+  RUN_TEST(test_duty_is_exact);
+  RUN_TEST(test_on_cycles_are_spread_evenly);
+  RUN_TEST(test_loads_filled_by_priority);
+  RUN_TEST(test_quarter_duty_pattern);
+
+  return UNITY_END();
+}
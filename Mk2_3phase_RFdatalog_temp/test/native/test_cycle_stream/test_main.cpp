@@ -0,0 +1,148 @@
+#include <unity.h>
+
+#include "cycle_stream.h"
+
+namespace
+{
+/**
+ * @brief Reads a little-endian 16-bit value from a frame
+ */
+int16_t get16(const uint8_t* p)
+{
+  return static_cast< int16_t >(p[0] | (p[1] << 8));
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_ring_buffer_push_pop_wrap(void)
+{
+  RingBuffer< uint8_t, 4 > ring;
+  uint8_t value{ 0 };
+
+  TEST_ASSERT_TRUE(ring.isEmpty());
+  TEST_ASSERT_FALSE(ring.pop(value));
+
+  // several laps, the free-running counters wrap around after 256 elements
+  for (uint16_t lap = 0; lap < 200; ++lap)
+  {
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+      TEST_ASSERT_TRUE(ring.push(static_cast< uint8_t >(lap + i)));
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, ring.size());
+    TEST_ASSERT_EQUAL_UINT8(static_cast< uint8_t >(lap), ring.front());
+
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+      TEST_ASSERT_TRUE(ring.pop(value));
+      TEST_ASSERT_EQUAL_UINT8(static_cast< uint8_t >(lap + i), value);
+    }
+    TEST_ASSERT_TRUE(ring.isEmpty());
+  }
+}
+
+void test_ring_buffer_full(void)
+{
+  RingBuffer< uint8_t, 4 > ring;
+  uint8_t value{ 0 };
+
+  for (uint8_t i = 0; i < 4; ++i)
+  {
+    TEST_ASSERT_TRUE(ring.push(i));
+  }
+  TEST_ASSERT_FALSE(ring.push(4));  // dropped
+  TEST_ASSERT_EQUAL_UINT8(4, ring.size());
+
+  ring.drop();
+  TEST_ASSERT_TRUE(ring.push(5));
+  TEST_ASSERT_TRUE(ring.pop(value));
+  TEST_ASSERT_EQUAL_UINT8(1, value);
+}
+
+void test_stream_counts_drops(void)
+{
+  CycleStream< 2 > stream;
+  CycleRecord record;
+
+  for (uint8_t i = 0; i < 5; ++i)
+  {
+    stream.push(record);  // the last 3 ones are dropped
+  }
+  TEST_ASSERT_EQUAL_UINT16(3, stream.getDroppedRecords());
+
+  TEST_ASSERT_TRUE(stream.pop(record));
+  TEST_ASSERT_EQUAL_UINT8(0, record.sequence);
+  TEST_ASSERT_EQUAL_UINT8(0, record.dropped);
+  TEST_ASSERT_TRUE(stream.pop(record));
+  TEST_ASSERT_EQUAL_UINT8(1, record.sequence);
+
+  // the next queued record tells how many ones are missing before it
+  stream.push(record);
+  TEST_ASSERT_TRUE(stream.pop(record));
+  TEST_ASSERT_EQUAL_UINT8(5, record.sequence);
+  TEST_ASSERT_EQUAL_UINT8(3, record.dropped);
+
+  stream.push(record);
+  TEST_ASSERT_TRUE(stream.pop(record));
+  TEST_ASSERT_EQUAL_UINT8(6, record.sequence);
+  TEST_ASSERT_EQUAL_UINT8(0, record.dropped);
+  TEST_ASSERT_FALSE(stream.pop(record));
+}
+
+void test_frame_encoding(void)
+{
+  CycleRecord record;
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    record.power[phase] = toEnergy(-1000.0F * (phase + 1) + 0.4F);
+  }
+  record.power[0] = toEnergy(40000.0F);  // saturated
+  record.energyInBucket = toEnergy(1800.0F * SUPPLY_FREQUENCY);
+  record.loads = 0b101;
+  record.sequence = 42;
+  record.dropped = 7;
+
+  uint8_t frame[CYCLE_FRAME_SIZE];
+  encodeCycleFrame(record, frame);
+
+  TEST_ASSERT_EQUAL_HEX8(CYCLE_FRAME_SYNC_1, frame[0]);
+  TEST_ASSERT_EQUAL_HEX8(CYCLE_FRAME_SYNC_2, frame[1]);
+  TEST_ASSERT_EQUAL_UINT8(CYCLE_FRAME_SIZE - 4, frame[2]);
+  TEST_ASSERT_EQUAL_UINT8('C', frame[3]);
+  TEST_ASSERT_EQUAL_UINT8(42, frame[4]);
+  TEST_ASSERT_EQUAL_UINT8(7, frame[5]);
+  TEST_ASSERT_EQUAL_HEX8(0b101, frame[6]);
+  TEST_ASSERT_EQUAL_INT16(1800, get16(frame + 7));
+
+  TEST_ASSERT_EQUAL_INT16(INT16_MAX, get16(frame + 9));
+  for (uint8_t phase = 1; phase < NO_OF_PHASES; ++phase)
+  {
+    TEST_ASSERT_EQUAL_INT16(-1000 * (phase + 1), get16(frame + 9 + 2 * phase));
+  }
+
+  uint8_t sum{ 0 };
+  for (uint8_t i = 2; i < CYCLE_FRAME_SIZE; ++i)
+  {
+    sum += frame[i];
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, sum);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_ring_buffer_push_pop_wrap);
+  RUN_TEST(test_ring_buffer_full);
+  RUN_TEST(test_stream_counts_drops);
+  RUN_TEST(test_frame_encoding);
+
+  return UNITY_END();
+}
@@ -0,0 +1,203 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "energy_bucket.h"
+
+namespace
+{
+constexpr float kEnergyLSB{ 1.0F / (1UL << ENERGY_FRACTION_BITS) }; /**< resolution of the fixed-point bucket, in Joules * SUPPLY_FREQUENCY */
+constexpr int32_t kMaxSumP{ 48L * 512L * 512L };                    /**< largest |sumP| over a mains cycle */
+
+uint32_t rngState{ 0x12345678 };
+
+/**
+ * @brief Small xorshift generator, reproducible on every host
+ */
+uint32_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+int32_t randomSumP(const int32_t range)
+{
+  return static_cast< int32_t >(nextRandom() % (2UL * range + 1)) - range;
+}
+
+/**
+ * @brief Worst case difference between the fixed-point and the float contributions
+ *
+ * @details The float path truncates sumP / n to an integer (< 1 step of average power),
+ *          the rounded reciprocal is off by < 0.5 / 2^16 relatively to 2^(16+4) / n,
+ *          each mulShr16() floors (< 1 LSB).
+ */
+float contributionTolerance(const uint8_t phase, const int32_t sumP)
+{
+  const float avgPowerError{ 1.0F + std::fabs(static_cast< float >(sumP)) / (1UL << (17 + AVG_POWER_FRACTION_BITS)) + 1.0F / (1UL << AVG_POWER_FRACTION_BITS) };
+  const float calibrationError{ 0.5F / (1UL << POWER_CAL_SHIFT) };
+
+  return avgPowerError * f_powerCal[phase] + static_cast< float >(kMaxSumP) * calibrationError + 2 * kEnergyLSB;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_mulShr16_is_exact_floor(void)
+{
+  for (uint32_t i = 0; i < 200000; ++i)
+  {
+    const auto a{ randomSumP(kMaxSumP * 16) };
+    const auto b{ static_cast< uint16_t >(nextRandom()) };
+
+    const int64_t expected{ (static_cast< int64_t >(a) * b) >> 16 };
+    TEST_ASSERT_EQUAL_INT32(expected, mulShr16(a, b));
+  }
+}
+
+void test_scaled_power_calibration(void)
+{
+  TEST_ASSERT_TRUE(POWER_CAL_SHIFT >= 16);
+  TEST_ASSERT_EQUAL_UINT8(AVG_POWER_FRACTION_BITS + POWER_CAL_SHIFT - 16, ENERGY_FRACTION_BITS);
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    const double scaled{ static_cast< double >(f_powerCal[phase]) * (1UL << POWER_CAL_SHIFT) };
+
+    TEST_ASSERT_TRUE(scaled < 65535.5);
+    TEST_ASSERT_TRUE(std::fabs(scaled - POWER_CAL_Q.value[phase]) <= 0.5);
+  }
+}
+
+void test_reciprocal_division(void)
+{
+  for (uint8_t n = MIN_SAMPLES_FOR_RECIPROCAL; n <= MAX_SAMPLES_FOR_RECIPROCAL; ++n)
+  {
+    const uint32_t reciprocal{ RECIPROCALS.value[n - MIN_SAMPLES_FOR_RECIPROCAL] };
+    TEST_ASSERT_TRUE(reciprocal <= UINT16_MAX);
+
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+      const auto sumP{ randomSumP(kMaxSumP) };
+
+      const double exact{ static_cast< double >(sumP) * (1UL << AVG_POWER_FRACTION_BITS) / n };
+      const double fixed{ static_cast< double >(mulShr16(sumP, reciprocal)) };
+
+      TEST_ASSERT_TRUE(std::fabs(fixed - exact) <= 1.0 + std::fabs(static_cast< double >(sumP)) / (1UL << 17));
+    }
+  }
+
+  // exact for a power of 2
+  TEST_ASSERT_EQUAL_INT32(-3, mulShr16(-5, RECIPROCALS.value[32 - MIN_SAMPLES_FOR_RECIPROCAL]));
+  TEST_ASSERT_EQUAL_INT32(1234567 / 2, mulShr16(1234567, RECIPROCALS.value[32 - MIN_SAMPLES_FOR_RECIPROCAL]));
+}
+
+void test_contribution_matches_float_path(void)
+{
+  float maxError{ 0 };
+
+  for (uint8_t n = 1; n < UINT8_MAX; ++n)
+  {
+    for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+    {
+      for (uint16_t i = 0; i < 2000; ++i)
+      {
+        const auto sumP{ randomSumP(n * 512L * 512L) };
+
+        const float reference{ energyContributionFloat(phase, sumP, n) };
+        const float fixed{ energyContributionFixed(phase, sumP, n) * kEnergyLSB };
+        const float error{ std::fabs(fixed - reference) };
+
+        if (error > maxError)
+        {
+          maxError = error;
+        }
+        TEST_ASSERT_TRUE(error <= contributionTolerance(phase, sumP));
+      }
+    }
+  }
+
+  printf("Largest difference: %.4f J x SUPPLY_FREQUENCY\n", maxError);
+}
+
+void test_bucket_decisions_match_float_path(void)
+{
+  // Same bucket, thresholds and clamping as processStartNewCycle(), fed with a random walk
+  // of the grid power around the diversion thresholds. An exact (double) bucket is the reference.
+  constexpr double capacity{ WORKING_ZONE_IN_JOULES * SUPPLY_FREQUENCY };
+  constexpr int32_t capacityFixed{ static_cast< int32_t >(capacity * (1UL << ENERGY_FRACTION_BITS)) };
+
+  double bucketExact{ 0 };
+  float bucketFloat{ 0 };
+  int32_t bucketFixed{ 0 };
+  int32_t avgPower{ 0 };
+  double maxDriftFloat{ 0 };
+  double maxDriftFixed{ 0 };
+  uint32_t decisions{ 0 };
+  uint32_t mismatches{ 0 };
+
+  for (uint32_t cycle = 0; cycle < 1000000; ++cycle)
+  {
+    avgPower += randomSumP(2000);
+    if (avgPower > 60000 || avgPower < -60000)
+    {
+      avgPower /= 2;
+    }
+
+    for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+    {
+      const uint8_t n{ static_cast< uint8_t >(31 + nextRandom() % 3) };
+      const int32_t sumP{ avgPower * n + randomSumP(n * 100L) };
+
+      bucketExact += static_cast< double >(sumP) / n * f_powerCal[phase];
+      bucketFloat += energyContributionFloat(phase, sumP, n);
+      bucketFixed += energyContributionFixed(phase, sumP, n);
+    }
+
+    const bool highFloat{ bucketFloat > capacity * 0.5 };
+    const bool highFixed{ bucketFixed > capacityFixed / 2 };
+    ++decisions;
+    if (highFloat != highFixed)
+    {
+      ++mismatches;
+    }
+
+    const double driftFloat{ std::fabs(bucketFloat - bucketExact) };
+    const double driftFixed{ std::fabs(bucketFixed * static_cast< double >(kEnergyLSB) - bucketExact) };
+    maxDriftFloat = driftFloat > maxDriftFloat ? driftFloat : maxDriftFloat;
+    maxDriftFixed = driftFixed > maxDriftFixed ? driftFixed : maxDriftFixed;
+
+    // all buckets saturate together, which bounds the drift
+    bucketExact = bucketExact > capacity ? capacity : (bucketExact < 0 ? 0 : bucketExact);
+    bucketFloat = bucketFloat > capacity ? capacity : (bucketFloat < 0 ? 0 : bucketFloat);
+    bucketFixed = bucketFixed > capacityFixed ? capacityFixed : (bucketFixed < 0 ? 0 : bucketFixed);
+  }
+
+  printf("Largest drift: float %.2f, fixed %.2f J x SUPPLY_FREQUENCY, %u mismatches over %u decisions\n", maxDriftFloat, maxDriftFixed, mismatches, decisions);
+
+  // the fixed-point bucket is at least as close to the exact energy as the float one
+  TEST_ASSERT_TRUE(maxDriftFixed <= maxDriftFloat);
+  TEST_ASSERT_TRUE(mismatches * 10000UL < decisions);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_mulShr16_is_exact_floor);
+  RUN_TEST(test_scaled_power_calibration);
+  RUN_TEST(test_reciprocal_division);
+  RUN_TEST(test_contribution_matches_float_path);
+  RUN_TEST(test_bucket_decisions_match_float_path);
+
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include <unity.h>
+#include <string.h>
+
+#include "energy_meters.h"
+
+namespace
+{
+constexpr uint8_t kNoOfSlots{ 4 };
+
+EnergyRecord eeprom[kNoOfSlots]; /**< emulated ring of records */
+
+void readSlot(const uint8_t slot, EnergyRecord &record)
+{
+  record = eeprom[slot];
+}
+
+void eraseEeprom()
+{
+  memset(eeprom, 0xFF, sizeof(eeprom));
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_wh_meter_keeps_the_fractions(void)
+{
+  WhMeter meter;
+
+  // 1 W during 1 hour @ 50 Hz, added every 5 s: 720 periods of 250 W.cycles
+  for (uint16_t i = 0; i < 720; ++i)
+  {
+    meter.add(250, 3600UL * 50);
+  }
+  TEST_ASSERT_EQUAL_UINT64(1, meter.get());
+
+  // 10 kW during 1 hour @ 60 Hz
+  meter.set(0);
+  for (uint16_t i = 0; i < 720; ++i)
+  {
+    meter.add(10000UL * 300, 3600UL * 60);
+  }
+  TEST_ASSERT_EQUAL_UINT64(10000, meter.get());
+}
+
+void test_meters_split_import_and_export(void)
+{
+  EnergyMeters meters;
+  const uint16_t countLoadON[NO_OF_DUMPLOADS]{ 250, 0, 125 };
+
+  // 1 hour of 5-s periods, alternating import and export, loads ON 100% and 50%
+  for (uint16_t i = 0; i < 360; ++i)
+  {
+    meters.update(3600, countLoadON, 250, 50);
+    meters.update(-1800, countLoadON, 250, 50);
+  }
+
+  TEST_ASSERT_EQUAL_UINT64(1800, meters.getImport());
+  TEST_ASSERT_EQUAL_UINT64(900, meters.getExport());
+  TEST_ASSERT_EQUAL_UINT64(loadRatedPowerInWatts[0], meters.getDiverted(0));
+  TEST_ASSERT_EQUAL_UINT64(0, meters.getDiverted(1));
+  TEST_ASSERT_EQUAL_UINT64(loadRatedPowerInWatts[2] / 2, meters.getDiverted(2));
+}
+
+void test_record_round_trip(void)
+{
+  EnergyMeters meters;
+  const uint16_t countLoadON[NO_OF_DUMPLOADS]{ 50, 50, 50 };
+
+  meters.update(-32768, countLoadON, 3600, 1);  // 32768 Wh exported in one go
+
+  const auto record{ meters.toRecord(7) };
+  TEST_ASSERT_TRUE(isEnergyRecordValid(record));
+
+  EnergyMeters restored;
+  restored.restore(record);
+  TEST_ASSERT_EQUAL_UINT64(32768, restored.getExport());
+  TEST_ASSERT_EQUAL_UINT64(0, restored.getImport());
+
+  auto corrupted{ record };
+  corrupted.exportWh ^= 1ULL << 40;
+  TEST_ASSERT_FALSE(isEnergyRecordValid(corrupted));
+
+  auto otherLayout{ record };
+  otherLayout.noOfDumpLoads = NO_OF_DUMPLOADS + 1;
+  otherLayout.checksum = energyRecordChecksum(otherLayout);
+  TEST_ASSERT_FALSE(isEnergyRecordValid(otherLayout));
+}
+
+void test_latest_record_of_the_ring(void)
+{
+  EnergyRecord latest;
+  EnergyMeters meters;
+
+  eraseEeprom();
+  TEST_ASSERT_EQUAL_UINT8(kNoOfSlots, findLatestEnergyRecord(readSlot, kNoOfSlots, latest));
+
+  // 6 saves in a ring of 4 slots: the latest one (#6) is in slot 1
+  uint8_t slot{ kNoOfSlots - 1 };
+  for (uint32_t sequence = 1; sequence <= 6; ++sequence)
+  {
+    EnergyRecord record{ meters.toRecord(sequence) };
+    record.importWh = sequence * 1000;
+    record.checksum = energyRecordChecksum(record);
+
+    slot = (slot + 1) % kNoOfSlots;
+    eeprom[slot] = record;
+  }
+  TEST_ASSERT_EQUAL_UINT8(1, findLatestEnergyRecord(readSlot, kNoOfSlots, latest));
+  TEST_ASSERT_EQUAL_UINT32(6, latest.sequence);
+  TEST_ASSERT_EQUAL_UINT64(6000, latest.importWh);
+
+  // torn write of the latest record: the previous one is used
+  eeprom[1].importWh = 0;
+  TEST_ASSERT_EQUAL_UINT8(0, findLatestEnergyRecord(readSlot, kNoOfSlots, latest));
+  TEST_ASSERT_EQUAL_UINT32(5, latest.sequence);
+}
+
+void test_uint64_to_decimal(void)
+{
+  char digits[UINT64_MAX_DIGITS + 1];
+
+  TEST_ASSERT_EQUAL_STRING("0", uint64ToDecimal(0, digits));
+  TEST_ASSERT_EQUAL_STRING("4294967296", uint64ToDecimal(1ULL << 32, digits));
+  TEST_ASSERT_EQUAL_STRING("18446744073709551615", uint64ToDecimal(UINT64_MAX, digits));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_wh_meter_keeps_the_fractions);
+  RUN_TEST(test_meters_split_import_and_export);
+  RUN_TEST(test_record_round_trip);
+  RUN_TEST(test_latest_record_of_the_ring);
+  RUN_TEST(test_uint64_to_decimal);
+
+  return UNITY_END();
+}
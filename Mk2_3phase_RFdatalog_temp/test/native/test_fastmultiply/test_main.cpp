@@ -0,0 +1,84 @@
+#include <unity.h>
+
+#include "FastMultiply.h"
+
+namespace
+{
+constexpr int16_t kEdgeValues[]{ INT16_MIN, INT16_MIN + 1, -256, -255, -129, -128, -127, -1, 0, 1, 127, 128, 255, 256, INT16_MAX - 1, INT16_MAX };
+
+uint32_t seed{ 12345 };
+
+/**
+ * @brief Pseudo-random 16-bit value (LCG), so that the test is reproducible
+ */
+int16_t random16()
+{
+  seed = seed * 1103515245UL + 12345UL;
+  return static_cast< int16_t >(seed >> 16);
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_multiply_edge_values(void)
+{
+  for (const auto a : kEdgeValues)
+  {
+    for (const auto b : kEdgeValues)
+    {
+      TEST_ASSERT_EQUAL_INT32(static_cast< int64_t >(a) * b, mulS16(a, b));
+    }
+  }
+}
+
+void test_multiply_random_values(void)
+{
+  for (uint32_t i = 0; i < 1000000; ++i)
+  {
+    const int16_t a{ random16() };
+    const int16_t b{ random16() };
+
+    TEST_ASSERT_EQUAL_INT32(static_cast< int64_t >(a) * b, mulS16(a, b));
+  }
+}
+
+void test_wide_operands(void)
+{
+  for (const auto a : kEdgeValues)
+  {
+    for (const auto b : kEdgeValues)
+    {
+      TEST_ASSERT_EQUAL_INT32(static_cast< int64_t >(a) * b, mulS32(a, b));
+    }
+  }
+
+  // a clipped sample 548 ADC steps away from the DC offset, x256 then / 4
+  constexpr int32_t clipped{ (548L << 8) >> 2 };
+  TEST_ASSERT_EQUAL_INT32(clipped * clipped, mulS32(clipped, clipped));
+  TEST_ASSERT_EQUAL_INT32(-clipped * 1000, mulS32(-clipped, 1000));
+  TEST_ASSERT_EQUAL_INT32(-clipped * INT16_MIN, mulS32(INT16_MIN, -clipped));
+
+  // up to ±43690, the product still fits in 32 bits
+  for (uint32_t i = 0; i < 1000000; ++i)
+  {
+    const int32_t a{ random16() + random16() / 3 };
+    const int32_t b{ random16() + random16() / 3 };
+
+    TEST_ASSERT_EQUAL_INT32(static_cast< int64_t >(a) * b, mulS32(a, b));
+  }
+}
+
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_multiply_edge_values);
+  RUN_TEST(test_multiply_random_values);
+  RUN_TEST(test_wide_operands);
+  return UNITY_END();
+}
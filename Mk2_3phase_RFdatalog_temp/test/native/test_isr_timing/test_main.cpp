@@ -0,0 +1,97 @@
+#include <unity.h>
+
+#include "isr_timing.h"
+
+namespace
+{
+constexpr uint16_t us(const uint16_t microseconds)
+{
+  return microseconds * TIMER1_TICKS_PER_US;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_min_max(void)
+{
+  TimingStats stats;
+
+  stats.record(us(40));
+  stats.record(us(25));
+  stats.record(us(82));
+  stats.record(us(53));
+
+  TEST_ASSERT_EQUAL_UINT16(25, ticksToMicroseconds(stats.minTicks));
+  TEST_ASSERT_EQUAL_UINT16(82, ticksToMicroseconds(stats.maxTicks));
+}
+
+void test_histogram_buckets(void)
+{
+  TimingStats stats;
+
+  stats.record(0);
+  stats.record(us(TIMING_BUCKET_WIDTH_US) - 1);  // still first bucket
+  stats.record(us(TIMING_BUCKET_WIDTH_US));      // second bucket
+  stats.record(us(100));                         // 100 / 16 => bucket #6
+  stats.record(us(104));                         // 104 / 16 => bucket #6
+  stats.record(us(500));                         // beyond the last bucket
+  stats.record(UINT16_MAX);
+
+  TEST_ASSERT_EQUAL_UINT32(2, stats.histogram[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.histogram[1]);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.histogram[6]);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.histogram[NO_OF_TIMING_BUCKETS - 1]);
+}
+
+void test_histogram_counts_a_whole_period(void)
+{
+  TimingStats stats;
+
+  // ISR runs during a datalog period of 5 s with ADC_PRESCALER_64
+  for (uint32_t i = 0; i < 96154; ++i)
+  {
+    stats.record(us(30));
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(96154, stats.histogram[1]);
+}
+
+void test_copy_and_reset(void)
+{
+  TimingStats stats;
+  volatile TimingStats copy;
+
+  stats.record(us(30));
+  stats.record(us(70));
+  stats.copyAndReset(copy);
+
+  TEST_ASSERT_EQUAL_UINT16(us(30), copy.minTicks);
+  TEST_ASSERT_EQUAL_UINT16(us(70), copy.maxTicks);
+  TEST_ASSERT_EQUAL_UINT32(1, copy.histogram[1]);
+  TEST_ASSERT_EQUAL_UINT32(1, copy.histogram[4]);
+
+  TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, stats.minTicks);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.maxTicks);
+  for (const auto count : stats.histogram)
+  {
+    TEST_ASSERT_EQUAL_UINT32(0, count);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_min_max);
+  RUN_TEST(test_histogram_buckets);
+  RUN_TEST(test_histogram_counts_a_whole_period);
+  RUN_TEST(test_copy_and_reset);
+
+  return UNITY_END();
+}
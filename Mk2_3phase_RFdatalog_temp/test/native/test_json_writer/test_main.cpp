@@ -0,0 +1,226 @@
+#include <unity.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_writer.h"
+
+namespace
+{
+/**
+ * @brief Output keeping the bytes written
+ */
+class StringPrint : public Print
+{
+public:
+  size_t write(uint8_t c) override
+  {
+    if (length < sizeof(text) - 1)
+    {
+      text[length++] = static_cast< char >(c);
+      text[length] = '\0';
+    }
+    return 1;
+  }
+
+  char text[256]{};
+  size_t length{ 0 };
+};
+
+/**
+ * @brief Float as written by ArduinoJson 6 (TextFormatter::writeFloat() and FloatParts), on AVR
+ *        where JsonFloat is a 4-byte float.
+ *
+ * @details Reference of the previous output, for the values without exponent (< 1e7 and >= 1e-5).
+ */
+void arduinoJsonFloat(float value, char* out)
+{
+  if (value < 0.0F)
+  {
+    *out++ = '-';
+    value = -value;
+  }
+
+  uint32_t maxDecimalPart{ 1000000 };
+  int8_t decimalPlaces{ 6 };
+
+  uint32_t integral{ static_cast< uint32_t >(value) };
+  for (uint32_t tmp = integral; tmp >= 10; tmp /= 10)
+  {
+    maxDecimalPart /= 10;
+    decimalPlaces--;
+  }
+
+  float remainder{ (value - static_cast< float >(integral)) * static_cast< float >(maxDecimalPart) };
+
+  uint32_t decimal{ static_cast< uint32_t >(remainder) };
+  remainder = remainder - static_cast< float >(decimal);
+
+  decimal += static_cast< uint32_t >(remainder * 2);
+  if (decimal >= maxDecimalPart)
+  {
+    decimal = 0;
+    integral++;
+  }
+
+  while (decimal % 10 == 0 && decimalPlaces > 0)
+  {
+    decimal /= 10;
+    decimalPlaces--;
+  }
+
+  out += sprintf(out, "%lu", static_cast< unsigned long >(integral));
+  if (decimalPlaces)
+  {
+    sprintf(out, ".%0*lu", decimalPlaces, static_cast< unsigned long >(decimal));
+  }
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_empty_object(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  json.end();
+
+  TEST_ASSERT_EQUAL_STRING("{}", output.text);
+}
+
+void test_integers(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  json.add(F("P"), -1234);
+  json.add(F("P"), 0, 1);
+  json.add(F("VA"), 65535, 3);
+  json.add(F("TXD"), 7);
+  json.end();
+
+  TEST_ASSERT_EQUAL_STRING("{\"P\":-1234,\"P1\":0,\"VA3\":65535,\"TXD\":7}", output.text);
+}
+
+void test_indexes_above_9(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  json.add(F("T"), 1, 12);
+  json.end();
+
+  TEST_ASSERT_EQUAL_STRING("{\"T12\":1}", output.text);
+}
+
+void test_hundredths(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  json.addHundredths(F("F"), 5002);
+  json.addHundredths(F("F"), 5010);
+  json.addHundredths(F("F"), 5000);
+  json.addHundredths(F("PF"), -98, 1);
+  json.addHundredths(F("PF"), -5, 2);
+  json.addHundredths(F("PF"), 0, 3);
+  json.end();
+
+  TEST_ASSERT_EQUAL_STRING("{\"F\":50.02,\"F\":50.1,\"F\":50,\"PF1\":-0.98,\"PF2\":-0.05,\"PF3\":0}", output.text);
+}
+
+void test_text_and_raw(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  json.addText(F("TA"), "low");
+  json.addRaw(F("EI"), "18446744073709551615");
+  json.addRaw(F("ED"), "0", 2);
+  json.end();
+
+  TEST_ASSERT_EQUAL_STRING("{\"TA\":\"low\",\"EI\":18446744073709551615,\"ED2\":0}", output.text);
+}
+
+void test_hundredths_match_arduinojson(void)
+{
+  uint16_t roundingErrors{ 0 };
+
+  // Whole range of the values in 100th: temperature, power factor, frequency and current
+  for (int32_t value_x100 = -32768; value_x100 <= 65535; ++value_x100)
+  {
+    StringPrint output;
+    JsonWriter json{ output };
+    json.addHundredths(F("X"), value_x100);
+
+    char expected[32];
+    arduinoJsonFloat(static_cast< float >(value_x100) * 0.01F, expected);
+
+    const char* written{ output.text + strlen("{\"X\":") };
+
+    if (strcmp(expected, written))
+    {
+      // ArduinoJson showed the rounding error of the float: the exact value is written instead
+      ++roundingErrors;
+      TEST_ASSERT_FLOAT_WITHIN(0.00002, value_x100 * 0.01, strtod(expected, nullptr));
+      TEST_ASSERT_FLOAT_WITHIN(0.0000001, value_x100 * 0.01, strtod(written, nullptr));
+    }
+  }
+
+  // only some magnitudes between 64 and 100 are concerned
+  TEST_ASSERT_EQUAL(646, roundingErrors);
+}
+
+void test_frame_matches_arduinojson(void)
+{
+  StringPrint output;
+  JsonWriter json{ output };
+
+  // Same members, in the same order, as printForJSON() for 3 phases, relays, current, 2 sensors, dual tariff
+  json.add(F("P"), -1523);
+  json.add(F("R"), -1490);
+  json.add(F("P"), -812, 1);
+  json.add(F("P"), 104, 2);
+  json.add(F("P"), -815, 3);
+  json.addHundredths(F("F"), 4998);
+  for (uint8_t phase = 0; phase < 3; ++phase)
+  {
+    json.addHundredths(F("I"), 352 + phase, phase + 1);
+    json.add(F("VA"), 810 + phase, phase + 1);
+    json.addHundredths(F("PF"), -97 + phase, phase + 1);
+  }
+  json.addHundredths(F("T"), 2150, 1);
+  json.addHundredths(F("T"), -325, 2);
+  json.addText(F("TA"), "high");
+  json.add(F("TXD"), 0);
+  json.end();
+  output.println();
+
+  // Output of ArduinoJson 6 for a StaticJsonDocument holding the same integers and floats
+  TEST_ASSERT_EQUAL_STRING("{\"P\":-1523,\"R\":-1490,\"P1\":-812,\"P2\":104,\"P3\":-815,\"F\":49.98,"
+                           "\"I1\":3.52,\"VA1\":810,\"PF1\":-0.97,\"I2\":3.53,\"VA2\":811,\"PF2\":-0.96,"
+                           "\"I3\":3.54,\"VA3\":812,\"PF3\":-0.95,\"T1\":21.5,\"T2\":-3.25,\"TA\":\"high\",\"TXD\":0}\r\n",
+                           output.text);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_empty_object);
+  RUN_TEST(test_integers);
+  RUN_TEST(test_indexes_above_9);
+  RUN_TEST(test_hundredths);
+  RUN_TEST(test_text_and_raw);
+  RUN_TEST(test_hundredths_match_arduinojson);
+  RUN_TEST(test_frame_matches_arduinojson);
+
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <unity.h>
+
+#include "config.h"
+#include "hal.h"
+#include "load_ports.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_masks_of_config(void)
+{
+  constexpr auto masks{ makeLoadPortMasks(physicalLoadPin) };
+
+  uint16_t all{ 0 };
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    const uint16_t expected{ static_cast< uint16_t >(1U << physicalLoadPin[i]) };
+
+    TEST_ASSERT_EQUAL_HEX8(lowByte(expected), masks.load[i].portD);
+    TEST_ASSERT_EQUAL_HEX8(highByte(expected), masks.load[i].portB);
+
+    all |= expected;
+  }
+
+  TEST_ASSERT_EQUAL_HEX8(lowByte(all), masks.all.portD);
+  TEST_ASSERT_EQUAL_HEX8(highByte(all), masks.all.portB);
+}
+
+void test_masks_across_ports(void)
+{
+  constexpr uint8_t pins[]{ 2, 7, 8, 13 };
+  constexpr auto masks{ makeLoadPortMasks(pins) };
+
+  TEST_ASSERT_EQUAL_HEX8(0x04, masks.load[0].portD);
+  TEST_ASSERT_EQUAL_HEX8(0x00, masks.load[0].portB);
+  TEST_ASSERT_EQUAL_HEX8(0x80, masks.load[1].portD);
+  TEST_ASSERT_EQUAL_HEX8(0x00, masks.load[1].portB);
+  TEST_ASSERT_EQUAL_HEX8(0x00, masks.load[2].portD);
+  TEST_ASSERT_EQUAL_HEX8(0x01, masks.load[2].portB);
+  TEST_ASSERT_EQUAL_HEX8(0x00, masks.load[3].portD);
+  TEST_ASSERT_EQUAL_HEX8(0x20, masks.load[3].portB);
+
+  TEST_ASSERT_EQUAL_HEX8(0x84, masks.all.portD);
+  TEST_ASSERT_EQUAL_HEX8(0x21, masks.all.portB);
+}
+
+void test_masks_are_compile_time(void)
+{
+  constexpr uint8_t pins[]{ 5, 9, unused_pin };
+  constexpr auto masks{ makeLoadPortMasks(pins) };
+
+  static_assert(masks.load[0].portD == 0x20);
+  static_assert(masks.load[1].portB == 0x02);
+  static_assert(masks.load[2].portD == 0 && masks.load[2].portB == 0);  // not in PORTD or PORTB
+
+  TEST_ASSERT_EQUAL_HEX8(0x20, masks.all.portD);
+  TEST_ASSERT_EQUAL_HEX8(0x02, masks.all.portB);
+}
+
+void test_to_port_bits(void)
+{
+  const auto bits{ toPortBits(0xC3A5) };
+
+  TEST_ASSERT_EQUAL_HEX8(0xA5, bits.portD);
+  TEST_ASSERT_EQUAL_HEX8(0x03, bits.portB);  // pins 14 and 15 do not exist
+}
+
+void test_single_masked_write(void)
+{
+  constexpr uint8_t pins[]{ 5, 6, 9 };
+  constexpr auto masks{ makeLoadPortMasks(pins) };
+
+  // the pins outside of the masks are left untouched
+  HAL::Native::pinsState = 0x1010;
+  HAL::Native::pinsWriteCount = 0;
+
+  HAL::writeLoadPorts(masks.all, PortBits{ masks.load[0].portD, masks.load[2].portB });
+  TEST_ASSERT_EQUAL_HEX16(0x1230, HAL::Native::pinsState);
+
+  HAL::writeLoadPorts(masks.all, PortBits{ masks.load[1].portD, 0 });
+  TEST_ASSERT_EQUAL_HEX16(0x1050, HAL::Native::pinsState);
+
+  // a bit outside of the masks (e.g. an override of a relay) is switched ON
+  HAL::writeLoadPorts(masks.all, PortBits{ 0, 0x08 });
+  TEST_ASSERT_EQUAL_HEX16(0x1810, HAL::Native::pinsState);
+
+  TEST_ASSERT_EQUAL_UINT32(3, HAL::Native::pinsWriteCount);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_masks_of_config);
+  RUN_TEST(test_masks_across_ports);
+  RUN_TEST(test_masks_are_compile_time);
+  RUN_TEST(test_to_port_bits);
+  RUN_TEST(test_single_masked_write);
+
+  return UNITY_END();
+}
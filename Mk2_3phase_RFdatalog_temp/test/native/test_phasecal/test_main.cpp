@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "phase_cal.h"
+
+namespace
+{
+constexpr double kPi{ 3.14159265358979323846 };
+constexpr double kConversionTime{ 104e-6 };                            /**< duration of an ADC conversion, in seconds */
+constexpr double kSampleSetTime{ kConversionTime * 2 * NO_OF_PHASES }; /**< interval between two samples of a phase, in seconds */
+constexpr double kOmega{ 2 * kPi * SUPPLY_FREQUENCY };                 /**< angular frequency of the mains */
+constexpr double kDegree{ kPi / 180 };                                 /**< one degree, in radians */
+constexpr uint32_t kSampleSets{ 100000 };                              /**< ~60 s of mains for 3 phases */
+constexpr double kVpk{ 400 };                                          /**< peak voltage, in ADC steps */
+constexpr double kIpk{ 300 };                                          /**< peak current, in ADC steps */
+
+uint32_t rngState{ 0x12345678 };
+
+/**
+ * @brief Small xorshift generator, reproducible on every host
+ */
+uint32_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+int32_t randomSample()
+{
+  return static_cast< int32_t >(nextRandom() % (1024UL * 256UL)) - 512L * 256L;
+}
+
+/**
+ * @brief Value of f_phaseCal * 256 cancelling a timing error of the current samples
+ *
+ * @param currentPhaseError Phase of the current samples relatively to the voltage samples, in radians
+ * @return The rounded phaseCal
+ */
+int16_t phaseCalFor(const double currentPhaseError)
+{
+  return static_cast< int16_t >(std::lround(256 * (1 + currentPhaseError / (kOmega * kSampleSetTime))));
+}
+
+/**
+ * @brief Average real power measured the same way as processCurrentRawSample()
+ *
+ * @details The current is sampled one conversion after the voltage of its phase,
+ *          and the CT adds a phase lag to the current.
+ *
+ * @param loadAngle Angle of the load (positive when the current lags the voltage), in radians
+ * @param ctLag Phase lag of the CT, in radians
+ * @param phaseCal f_phaseCal * 256 to apply
+ * @return The average real power, in ADC steps * ADC steps
+ */
+double measuredPower(const double loadAngle, const double ctLag, const int16_t phaseCal)
+{
+  int32_t lastSampleV{ 0 };
+  int64_t sumP{ 0 };
+
+  for (uint32_t n = 0; n < kSampleSets; ++n)
+  {
+    const double t{ n * kSampleSetTime };
+
+    const int32_t sampleV{ static_cast< int32_t >(std::lround(kVpk * std::sin(kOmega * t))) << 8 };
+    const int32_t sampleI{ static_cast< int32_t >(std::lround(kIpk * std::sin(kOmega * (t + kConversionTime) - loadAngle - ctLag))) << 8 };
+
+    const int32_t filtV_div4{ phaseShiftedSampleV(lastSampleV, sampleV, phaseCal) >> 2 };
+    const int32_t filtI_div4{ sampleI >> 2 };
+    sumP += (filtV_div4 * filtI_div4) >> 12;
+
+    lastSampleV = sampleV;
+  }
+
+  return static_cast< double >(sumP) / kSampleSets;
+}
+
+/**
+ * @brief Relative error of the measured power against the true power of the load
+ */
+double powerError(const double loadAngle, const double ctLag, const int16_t phaseCal)
+{
+  const double truePower{ kVpk * kIpk / 2 * std::cos(loadAngle) };
+
+  return std::fabs(measuredPower(loadAngle, ctLag, phaseCal) - truePower) / (kVpk * kIpk / 2);
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_nominal_calibration_is_identity(void)
+{
+  TEST_ASSERT_EQUAL_INT16(256, i_phaseCal);
+
+  for (uint32_t i = 0; i < 100000; ++i)
+  {
+    const auto last{ randomSample() };
+    const auto sample{ randomSample() };
+
+    TEST_ASSERT_EQUAL_INT32(sample, phaseShiftedSampleV(last, sample));
+  }
+}
+
+void test_previous_sample_and_midpoint(void)
+{
+  TEST_ASSERT_EQUAL_INT32(-1000, phaseShiftedSampleV(-1000, 3000, 0));
+  TEST_ASSERT_EQUAL_INT32(1000, phaseShiftedSampleV(-1000, 3000, 128));
+  TEST_ASSERT_EQUAL_INT32(7000, phaseShiftedSampleV(-1000, 3000, 512));
+  TEST_ASSERT_EQUAL_INT32(-5000, phaseShiftedSampleV(-1000, 3000, -256));
+}
+
+void test_matches_float_interpolation(void)
+{
+  const int16_t phaseCals[]{ -256, 0, 1, 77, 128, 200, 255, 256, 300, 512 };
+
+  for (const auto phaseCal : phaseCals)
+  {
+    const double f{ phaseCal / 256.0 };
+
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+      const auto last{ randomSample() };
+      const auto sample{ randomSample() };
+
+      const double reference{ last + f * (sample - last) };
+      const double shifted{ static_cast< double >(phaseShiftedSampleV(last, sample, phaseCal)) };
+
+      // the integer version floors the correction
+      TEST_ASSERT_TRUE(shifted <= reference && reference - shifted < 1.0);
+    }
+  }
+}
+
+void test_corrects_phase_shifted_waveforms(void)
+{
+  // the current lags by the CT error, but is sampled one conversion after the voltage
+  const double ctLags[]{ 4 * kDegree, 6 * kDegree };
+  const double loadAngles[]{ 0, 60 * kDegree, -60 * kDegree };
+
+  for (const auto ctLag : ctLags)
+  {
+    const int16_t phaseCal{ phaseCalFor(kOmega * kConversionTime - ctLag) };
+
+    TEST_ASSERT_TRUE(phaseCal > 0 && phaseCal < 256);  // interpolation between the two samples
+
+    for (const auto loadAngle : loadAngles)
+    {
+      const double errorUncorrected{ powerError(loadAngle, ctLag, 256) };
+      const double errorCorrected{ powerError(loadAngle, ctLag, phaseCal) };
+
+      printf("CT lag %.1f deg, load %+.0f deg, phaseCal %d: error %.3f%% -> %.3f%%\n",
+             ctLag / kDegree, loadAngle / kDegree, phaseCal, 100 * errorUncorrected, 100 * errorCorrected);
+
+      // the interpolation slightly reduces the amplitude of the voltage (absorbed by f_powerCal)
+      TEST_ASSERT_TRUE(errorCorrected < 0.005);
+      if (loadAngle != 0)
+      {
+        TEST_ASSERT_TRUE(errorCorrected * 4 < errorUncorrected);
+      }
+    }
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_nominal_calibration_is_identity);
+  RUN_TEST(test_previous_sample_and_midpoint);
+  RUN_TEST(test_matches_float_interpolation);
+  RUN_TEST(test_corrects_phase_shifted_waveforms);
+
+  return UNITY_END();
+}
@@ -0,0 +1,239 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "pll.h"
+
+namespace
+{
+constexpr double kPi{ 3.14159265358979323846 };
+constexpr double kSampleSetTime{ ADC_SAMPLE_PERIOD_CYCLES * 2.0 * NO_OF_PHASES / F_CPU }; /**< interval between two samples of a phase, in seconds */
+constexpr double kVpk{ 400 * 256 };                                                   /**< peak voltage, in ADC steps x256 */
+
+uint32_t rngState{ 0x12345678 };
+
+/**
+ * @brief Small xorshift generator, reproducible on every host
+ */
+uint32_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+/**
+ * @brief Uniform noise in [-amplitude..amplitude]
+ */
+double noise(const double amplitude)
+{
+  return amplitude * (2.0 * (nextRandom() & 0xFFFF) / 0xFFFF - 1.0);
+}
+
+/**
+ * @brief Synthetic mains waveform
+ */
+struct Waveform
+{
+  double frequency;
+  double noiseAmplitude{ 0 };
+  double phase0{ 0.3 };
+  uint32_t n{ 0 };
+
+  double time() const
+  {
+    return n * kSampleSetTime;
+  }
+
+  int32_t next()
+  {
+    const double t{ (n++) * kSampleSetTime };
+    return static_cast< int32_t >(std::lround(kVpk * std::sin(2 * kPi * frequency * t + phase0) + noise(noiseAmplitude)));
+  }
+};
+
+/**
+ * @brief Runs the PLL for the given duration
+ *
+ * @return The number of sample sets until the lock, UINT32_MAX if never locked
+ */
+uint32_t run(ZeroCrossingPll &pll, Waveform &waveform, const double seconds)
+{
+  uint32_t lockedAt{ UINT32_MAX };
+  const auto count{ static_cast< uint32_t >(seconds / kSampleSetTime) };
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    pll.update(waveform.next());
+    if (pll.isLocked() && UINT32_MAX == lockedAt)
+    {
+      lockedAt = i;
+    }
+  }
+  return lockedAt;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_period_constants(void)
+{
+  // 16 MHz / 128 / 13 / 6 = 1602.56 sample sets per second for 3 phases with the default free-running ADC
+  TEST_ASSERT_EQUAL_UINT32(static_cast< uint32_t >(F_CPU * 25600.0 / (ADC_SAMPLE_PERIOD_CYCLES * 2 * NO_OF_PHASES)), PLL_SAMPLE_SETS_PER_SECOND_X100_Q8);
+  TEST_ASSERT_TRUE(PLL_MIN_PERIOD < pllPeriodFor(60));
+  TEST_ASSERT_TRUE(pllPeriodFor(60) < pllPeriodFor(50));
+  TEST_ASSERT_TRUE(pllPeriodFor(50) < PLL_MAX_PERIOD);
+
+  TEST_ASSERT_INT_WITHIN(1, 5000, pllFrequency_x100(pllPeriodFor(50)));
+  TEST_ASSERT_INT_WITHIN(1, 6000, pllFrequency_x100(pllPeriodFor(60)));
+}
+
+void test_measures_frequency(void)
+{
+  const double frequencies[]{ 50.0, 49.87, 50.23, 60.0, 59.91, 60.12 };
+
+  for (const auto frequency : frequencies)
+  {
+    ZeroCrossingPll pll;
+    Waveform waveform{ frequency };
+
+    const auto lockedAt{ run(pll, waveform, 5) };
+
+    const auto measured{ pllFrequency_x100(pll.getPeriod()) };
+    printf("%.2f Hz: locked after %.0f ms, measured %u.%02u Hz\n", frequency, lockedAt * kSampleSetTime * 1000, measured / 100, measured % 100);
+
+    TEST_ASSERT_TRUE(pll.isLocked());
+    TEST_ASSERT_TRUE(lockedAt * kSampleSetTime < 0.5);
+    TEST_ASSERT_INT_WITHIN(1, static_cast< int >(std::lround(frequency * 100)), measured);
+  }
+}
+
+void test_locks_around_50_and_60_hz(void)
+{
+  const double frequencies[]{ 48.5, 50.0, 51.5, 58.5, 60.0, 61.5 };
+
+  for (const auto frequency : frequencies)
+  {
+    ZeroCrossingPll pll;
+    Waveform waveform{ frequency, 2000 };
+
+    run(pll, waveform, 1);
+
+    TEST_ASSERT_TRUE(pll.isLocked());
+    TEST_ASSERT_INT_WITHIN(1, static_cast< int >(std::lround(frequency * 100)), pllFrequency_x100(pll.getPeriod()));
+  }
+}
+
+void test_predicts_polarity(void)
+{
+  // once locked, the predicted polarity only differs from the true one right at the zero-crossings
+  ZeroCrossingPll pll;
+  Waveform waveform{ 50.0, 3000 };
+
+  run(pll, waveform, 1);
+  TEST_ASSERT_TRUE(pll.isLocked());
+
+  uint32_t mismatches{ 0 };
+  uint32_t samples{ 0 };
+  for (; samples < 20000; ++samples)
+  {
+    const double t{ waveform.time() };
+    pll.update(waveform.next());
+
+    const double trueV{ std::sin(2 * kPi * waveform.frequency * t + waveform.phase0) };
+    const auto truePolarity{ trueV >= 0 ? Polarities::POSITIVE : Polarities::NEGATIVE };
+
+    if (pll.polarity() != truePolarity)
+    {
+      ++mismatches;
+      TEST_ASSERT_TRUE(std::fabs(trueV) < std::sin(2 * kPi * waveform.frequency * kSampleSetTime));  // within one sample of a crossing
+    }
+  }
+
+  printf("Polarity mismatches: %u / %u samples\n", mismatches, samples);
+}
+
+void test_tracks_frequency_drift(void)
+{
+  ZeroCrossingPll pll;
+  Waveform waveform{ 50.0, 2000 };
+
+  run(pll, waveform, 1);
+
+  // slow drift to 50.2 Hz, keeping the phase of the waveform continuous
+  for (uint8_t step = 0; step < 20; ++step)
+  {
+    const double t{ waveform.time() };
+    const double newFrequency{ waveform.frequency + 0.01 };
+    waveform.phase0 += 2 * kPi * (waveform.frequency - newFrequency) * t;
+    waveform.frequency = newFrequency;
+
+    run(pll, waveform, 0.5);
+    TEST_ASSERT_TRUE(pll.isLocked());
+  }
+
+  run(pll, waveform, 2);
+  TEST_ASSERT_INT_WITHIN(1, 5020, pllFrequency_x100(pll.getPeriod()));
+}
+
+void test_ignores_spikes_once_locked(void)
+{
+  ZeroCrossingPll pll;
+  Waveform waveform{ 50.0 };
+
+  run(pll, waveform, 1);
+  const auto period{ pll.getPeriod() };
+
+  // a negative spike every 7 samples: fake crossings far from the predicted ones
+  for (uint32_t i = 0; i < 20000; ++i)
+  {
+    int32_t sample{ waveform.next() };
+    if (0 == i % 7 && sample > 0)
+    {
+      sample = -sample;
+    }
+    pll.update(sample);
+  }
+
+  TEST_ASSERT_TRUE(pll.isLocked());
+  TEST_ASSERT_INT_WITHIN(4, period, pll.getPeriod());
+}
+
+void test_loses_lock_without_mains(void)
+{
+  ZeroCrossingPll pll;
+  Waveform waveform{ 50.0 };
+
+  run(pll, waveform, 1);
+  TEST_ASSERT_TRUE(pll.isLocked());
+
+  for (uint16_t i = 0; i < 500; ++i)
+  {
+    pll.update(1000);  // DC only
+  }
+
+  TEST_ASSERT_FALSE(pll.isLocked());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_period_constants);
+  RUN_TEST(test_measures_frequency);
+  RUN_TEST(test_locks_around_50_and_60_hz);
+  RUN_TEST(test_predicts_polarity);
+  RUN_TEST(test_tracks_frequency_drift);
+  RUN_TEST(test_ignores_spikes_once_locked);
+  RUN_TEST(test_loses_lock_without_mains);
+
+  return UNITY_END();
+}
@@ -0,0 +1,342 @@
+#include <unity.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "calibration.h"
+#include "energy_bucket.h"
+#include "hal.h"
+#include "pll.h"
+#include "processing.h"
+#include "shared_var.h"
+
+extern energy_t f_energyInBucket_main;
+
+namespace
+{
+constexpr double kPi{ 3.14159265358979323846 };
+constexpr double kVoltageAmplitude{ 230.0 * 1.41421356 / 0.8151 }; /**< ~230 V with the default f_voltageCal */
+
+double powerPerPhaseInWatts{ 0 }; /**< +ve = import, as in the telemetry */
+int16_t currentBias{ 0 };          /**< drift of the bias of the current sensors, in ADC steps */
+int16_t voltageBias{ 0 };          /**< drift of the bias of the voltage sensors, in ADC steps */
+double voltageGain{ 1 };           /**< gain of the voltage sensors, beyond ~1.3 the waveforms are clipped at the rails */
+
+/**
+ * @brief The value converted by the ADC, clipped at the rails
+ */
+int16_t adcValue(const double value)
+{
+  return static_cast< int16_t >(value < 0 ? 0 : (value > 1023 ? 1023 : value));
+}
+
+/**
+ * @brief Voltage sample of a phase
+ */
+int16_t voltageSample(const double angle)
+{
+  return adcValue(512 + voltageBias + voltageGain * kVoltageAmplitude * sin(angle));
+}
+
+/**
+ * @brief Current sample of a phase, in phase (export) or anti-phase (import) with the voltage
+ */
+int16_t currentSample(const uint8_t phase, const double angle)
+{
+  // P = Vrms_ADC * Irms_ADC * f_powerCal
+  const double currentAmplitude{ 2 * powerPerPhaseInWatts / (f_powerCal[phase] * kVoltageAmplitude) };
+  return adcValue(512 + currentBias - currentAmplitude * sin(angle));
+}
+
+/**
+ * @brief 50 Hz three-phase synthetic source
+ */
+int16_t syntheticSample(const uint8_t channel)
+{
+  const double t{ micros() * 1e-6 };
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    const double angle{ 2 * kPi * SUPPLY_FREQUENCY * t - phase * 2 * kPi / 3 };
+
+    if (channel == sensorV[phase])
+    {
+      return voltageSample(angle);
+    }
+    if (channel == sensorI[phase])
+    {
+      return currentSample(phase, angle);
+    }
+  }
+  return 512;
+}
+
+/**
+ * @brief No conversion missed, all the mains cycles with the nominal number of sample sets (32.05 for 3 phases @ 50 Hz)
+ * @details A template, the sampleIntegrity member only exists with SAMPLE_INTEGRITY_DIAGNOSTICS.
+ */
+template< typename Datalog >
+void checkSampleIntegrity(const Datalog& data)
+{
+  TEST_ASSERT_EQUAL_UINT16(0, data.sampleIntegrity.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(0, data.sampleIntegrity.lateConversions);
+  TEST_ASSERT_EQUAL_UINT16(DATALOG_PERIOD_IN_SECONDS * SUPPLY_FREQUENCY,
+                           data.sampleIntegrity.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2] + data.sampleIntegrity.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2 + 1]);
+}
+
+/**
+ * @brief Mains frequency measured by the PLL of the first phase
+ * @details A template, the mainsPeriod member only exists with MAINS_FREQUENCY_MEASUREMENT.
+ */
+template< typename Datalog >
+void checkMainsFrequency(const Datalog& data)
+{
+  TEST_ASSERT_INT_WITHIN(1, SUPPLY_FREQUENCY * 100, pllFrequency_x100(data.mainsPeriod));
+}
+
+/**
+ * @brief Current, from the sum of I^2, of a phase with a resistive load
+ * @details A template, the sum_Isquared member only exists with CURRENT_RMS_MEASUREMENT.
+ */
+template< typename Datalog >
+void checkCurrentRms(const Datalog& data, const uint8_t phase)
+{
+  // scaling of the sums, as in updatePowerAndVoltageData()
+  constexpr float scale{ DATALOG_PERIOD_IN_SECONDS > 10 ? 16.0F : 1.0F };
+  const float samples{ static_cast< float >(data.sampleSetsDuringThisDatalogPeriod) };
+
+  const float Vrms{ f_voltageCal[phase] * sqrtf(scale * data.sum_Vsquared[phase] / samples) };
+  const float Irms{ f_powerCal[phase] / f_voltageCal[phase] * sqrtf(scale * data.sum_Isquared[phase] / samples) };
+  const float power{ f_powerCal[phase] * data.sumP_atSupplyPoint[phase] / samples };
+
+  TEST_ASSERT_FLOAT_WITHIN(0.2F, 2000.0F / 230.0F, Irms);
+  TEST_ASSERT_FLOAT_WITHIN(0.02F, 1.0F, power / (Vrms * Irms));  // resistive load
+}
+
+/**
+ * @brief DC offset of the current of a phase
+ * @details A template, the DCoffset_I member only exists with CURRENT_DC_OFFSET_TRACKING.
+ */
+template< typename Datalog >
+void checkCurrentDCoffset(const Datalog& data, const uint8_t phase)
+{
+  // the synthetic samples are truncated, their mean is half a step lower
+  TEST_ASSERT_INT_WITHIN(256 / 4, (512 + 8) * 256 - 256 / 2, data.DCoffset_I[phase]);
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_emulated_adc_follows_lookahead(void)
+{
+  HAL::Native::reset();
+  HAL::Native::setADCSource(syntheticSample);
+  initializeProcessing();
+
+  // The ISR selects the channel for the conversion after next (free-running), or the next one (Timer1-triggered)
+  HAL::Native::runADCConversions(1);
+  TEST_ASSERT_EQUAL_UINT8(ADC_TIMER_TRIGGERED ? sensorI[0] : sensorV[1], HAL::Native::adcChannelSelected);
+  HAL::Native::runADCConversions(1);
+  TEST_ASSERT_EQUAL_UINT8(ADC_TIMER_TRIGGERED ? sensorV[1] : sensorI[1], HAL::Native::adcChannelSelected);
+  TEST_ASSERT_EQUAL_UINT8(sensorV[1], HAL::Native::adcChannelConverting);
+  TEST_ASSERT_EQUAL_UINT32(2UL * ADC_SAMPLE_PERIOD_CYCLES / (F_CPU / 1000000UL), micros());
+}
+
+void test_export_switches_loads_on(void)
+{
+  powerPerPhaseInWatts = -2000;  // 6 kW surplus
+
+  Shared::b_datalogEventPending = false;
+
+  // start-up period + 2 datalog periods
+  const uint32_t seconds{ (initialDelay + startUpPeriod) / 1000U + 2U * DATALOG_PERIOD_IN_SECONDS };
+  HAL::Native::runADCConversions(seconds * 1000000UL / ADC_SAMPLE_PERIOD_US);
+
+  TEST_ASSERT_TRUE(Shared::b_datalogEventPending);
+  Shared::datalog.read(copyOf_datalog);
+  TEST_ASSERT_GREATER_THAN(0, copyOf_datalog.sumP_atSupplyPoint[0]);  // export
+  TEST_ASSERT_GREATER_THAN(0, energyToFloat(f_energyInBucket_main));
+
+  // mains frequency measured by the PLL
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    checkMainsFrequency(copyOf_datalog);
+  }
+
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    checkSampleIntegrity(copyOf_datalog);
+  }
+
+  for (const auto& loadPin : physicalLoadPin)
+  {
+    TEST_ASSERT_TRUE(HAL::Native::pinsState & bit(loadPin));
+  }
+}
+
+void test_current_rms_measurement(void)
+{
+  if constexpr (!CURRENT_RMS_MEASUREMENT)
+  {
+    TEST_IGNORE();
+  }
+
+  // one more datalog period, the first one after start-up may include the start-up period
+  HAL::Native::runADCConversions(DATALOG_PERIOD_IN_SECONDS * 1000000UL / ADC_SAMPLE_PERIOD_US);
+  Shared::datalog.read(copyOf_datalog);
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    if constexpr (CURRENT_RMS_MEASUREMENT)
+    {
+      checkCurrentRms(copyOf_datalog, phase);
+    }
+  }
+}
+
+void test_import_switches_loads_off(void)
+{
+  powerPerPhaseInWatts = 2000;  // 6 kW import
+
+  HAL::Native::runADCConversions(2UL * 1000000UL / ADC_SAMPLE_PERIOD_US);
+
+  for (const auto& loadPin : physicalLoadPin)
+  {
+    TEST_ASSERT_FALSE(HAL::Native::pinsState & bit(loadPin));
+  }
+}
+
+void test_current_dc_offset_tracking(void)
+{
+  if constexpr (!CURRENT_DC_OFFSET_TRACKING)
+  {
+    TEST_IGNORE();
+  }
+
+  powerPerPhaseInWatts = 0;
+  currentBias = 8;
+
+  // ~8 time constants of the filter, then one full datalog period
+  HAL::Native::runADCConversions((20UL + DATALOG_PERIOD_IN_SECONDS) * 1000000UL / ADC_SAMPLE_PERIOD_US);
+
+  currentBias = 0;
+  Shared::datalog.read(copyOf_datalog);
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    if constexpr (CURRENT_DC_OFFSET_TRACKING)
+    {
+      checkCurrentDCoffset(copyOf_datalog, phase);
+    }
+
+    // no phantom power left
+    const float power{ f_powerCal[phase] * copyOf_datalog.sumP_atSupplyPoint[phase] / copyOf_datalog.sampleSetsDuringThisDatalogPeriod };
+    TEST_ASSERT_FLOAT_WITHIN(2.0F, 0.0F, power);
+  }
+}
+
+void test_clipped_waveforms_do_not_wrap(void)
+{
+  // voltage clipped at both rails, with a bias drift: the peaks are more than 511 ADC steps away from the DC offset
+  powerPerPhaseInWatts = -1500;
+  voltageBias = -48;
+  voltageGain = 1.6;
+
+  // reference, from one mains cycle of the clipped waveforms
+  constexpr uint16_t steps{ 10000 };
+  double sumV{ 0 }, sumI{ 0 }, sumVV{ 0 }, sumVI{ 0 };
+  int16_t maxV{ 0 };
+  for (uint16_t n = 0; n < steps; ++n)
+  {
+    const double angle{ 2 * kPi * n / steps };
+    const double v{ static_cast< double >(voltageSample(angle)) };
+    const double i{ static_cast< double >(currentSample(0, angle)) };
+
+    sumV += v;
+    sumI += i;
+    sumVV += v * v;
+    sumVI += v * i;
+    maxV = v > maxV ? static_cast< int16_t >(v) : maxV;
+  }
+  const double meanV{ sumV / steps };
+  const double refVsquared{ sumVV / steps - meanV * meanV };
+  const double refP{ sumVI / steps - meanV * sumI / steps };
+
+  TEST_ASSERT_GREATER_THAN(0, refP);
+  TEST_ASSERT_EQUAL_INT16(1023, maxV);
+  TEST_ASSERT_GREATER_THAN(511 + 16, static_cast< int32_t >(maxV - meanV));
+
+  // the DC offset of the voltage settles, then one full datalog period
+  HAL::Native::runADCConversions((20UL + DATALOG_PERIOD_IN_SECONDS) * 1000000UL / ADC_SAMPLE_PERIOD_US);
+
+  powerPerPhaseInWatts = 0;
+  voltageBias = 0;
+  voltageGain = 1;
+  Shared::datalog.read(copyOf_datalog);
+
+  // scaling of the sums, as in updatePowerAndVoltageData()
+  constexpr double scale{ DATALOG_PERIOD_IN_SECONDS > 10 ? 16.0 : 1.0 };
+  const double samples{ static_cast< double >(copyOf_datalog.sampleSetsDuringThisDatalogPeriod) };
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    // the peaks beyond 511 ADC steps are multiplied on 32 bits, instead of wrapping around to the
+    // opposite sign once truncated to 16 bits (V^2: -6%, and power: -63%)
+    TEST_ASSERT_FLOAT_WITHIN(0.005F * refVsquared, refVsquared, scale * copyOf_datalog.sum_Vsquared[phase] / samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.005F * refP, refP, copyOf_datalog.sumP_atSupplyPoint[phase] / samples);  // export
+  }
+}
+
+void test_direct_feed_throughput(void)
+{
+  constexpr uint32_t pairs{ 3000000 };
+  constexpr uint16_t samplesPerCycle{ 32 };
+
+  int16_t v[samplesPerCycle];
+  int16_t i[samplesPerCycle];
+  for (uint16_t n = 0; n < samplesPerCycle; ++n)
+  {
+    v[n] = static_cast< int16_t >(512 + kVoltageAmplitude * sin(2 * kPi * n / samplesPerCycle));
+    i[n] = static_cast< int16_t >(512 + 100 * sin(2 * kPi * n / samplesPerCycle));
+  }
+
+  const auto start{ std::chrono::steady_clock::now() };
+  for (uint32_t n = 0; n < pairs; ++n)
+  {
+    const uint8_t phase{ static_cast< uint8_t >(n % NO_OF_PHASES) };
+    const uint16_t idx{ static_cast< uint16_t >((n / NO_OF_PHASES) % samplesPerCycle) };
+
+    processVoltageRawSample(phase, v[idx]);
+    processCurrentRawSample(phase, i[idx]);
+    HAL::Native::advanceClock(2 * ADC_SAMPLE_PERIOD_US);
+  }
+  const std::chrono::duration< double > elapsed{ std::chrono::steady_clock::now() - start };
+
+  const double pairsPerSecond{ pairs / elapsed.count() };
+  printf("Direct feed: %.2f M sample pairs/s (%.0fx real time)\n", pairsPerSecond * 1e-6,
+         pairsPerSecond * 2 * ADC_SAMPLE_PERIOD_US * 1e-6);
+
+  // Real time is one pair every 208 us, anything below 100x would make long replays impractical
+  TEST_ASSERT_GREATER_THAN(100.0, pairsPerSecond * 2 * ADC_SAMPLE_PERIOD_US * 1e-6);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_emulated_adc_follows_lookahead);
+  RUN_TEST(test_export_switches_loads_on);
+  RUN_TEST(test_current_rms_measurement);
+  RUN_TEST(test_import_switches_loads_off);
+  RUN_TEST(test_current_dc_offset_tracking);
+  RUN_TEST(test_clipped_waveforms_do_not_wrap);
+  RUN_TEST(test_direct_feed_throughput);
+
+  return UNITY_END();
+}
@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <cstdio>
+
+#include "replay/replay.h"
+
+namespace
+{
+class RecordingObserver : public Replay::Observer
+{
+public:
+  void onCycle(const Replay::CycleRecord& record) override
+  {
+    ++cycles;
+    lastCycle = record;
+  }
+  void onDatalog(const Replay::DatalogRecord& record) override
+  {
+    ++datalogs;
+    lastDatalog = record;
+  }
+
+  uint32_t cycles{ 0 };
+  uint32_t datalogs{ 0 };
+  Replay::CycleRecord lastCycle;
+  Replay::DatalogRecord lastDatalog;
+};
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_csv_source_parses_sample_sets(void)
+{
+  FILE* file{ tmpfile() };
+  fputs("# V1,I1,V2,I2,V3,I3\n", file);
+  fputs("512,500,600,400,10,1023\n", file);
+  fputs("\n", file);
+  fputs("1, 2; 3 ,4,5,6\n", file);
+  rewind(file);
+
+  Replay::CsvSampleSource source{ file };
+  Replay::SampleSet set;
+
+  TEST_ASSERT_TRUE(source.next(set));
+  TEST_ASSERT_EQUAL_INT16(512, set.raw[0]);
+  TEST_ASSERT_EQUAL_INT16(1023, set.raw[5]);
+  TEST_ASSERT_TRUE(source.next(set));
+  TEST_ASSERT_EQUAL_INT16(1, set.raw[0]);
+  TEST_ASSERT_EQUAL_INT16(6, set.raw[5]);
+  TEST_ASSERT_FALSE(source.next(set));
+
+  fclose(file);
+}
+
+void test_binary_source_is_little_endian(void)
+{
+  FILE* file{ tmpfile() };
+  const uint8_t bytes[]{ 0x00, 0x02, 0xFF, 0x03, 0x01, 0x00, 0x00, 0x00, 0x34, 0x12, 0x00, 0x01 };
+  fwrite(bytes, sizeof(bytes), 1, file);
+  fputc(0x42, file);  // truncated sample set
+  rewind(file);
+
+  Replay::BinarySampleSource source{ file };
+  Replay::SampleSet set;
+
+  TEST_ASSERT_TRUE(source.next(set));
+  TEST_ASSERT_EQUAL_INT16(512, set.raw[0]);
+  TEST_ASSERT_EQUAL_INT16(1023, set.raw[1]);
+  TEST_ASSERT_EQUAL_INT16(0x1234, set.raw[4]);
+  TEST_ASSERT_FALSE(source.next(set));
+
+  fclose(file);
+}
+
+void test_synthetic_replay_closes_the_loop(void)
+{
+  // 1500 W exported per phase, 1000 W dump load per phase => 500 W still exported per phase
+  std::vector< Replay::SyntheticSampleSource::Segment > profile{ { 30, { -1500, -1500, -1500 } } };
+  Replay::SyntheticSampleSource source{ profile };
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    source.setLoadPower(i, 1000);
+  }
+
+  RecordingObserver observer;
+  const auto summary{ Replay::run(source, observer) };
+
+  TEST_ASSERT_EQUAL_UINT32(summary.cycles, observer.cycles);
+  TEST_ASSERT_EQUAL_UINT32(summary.datalogs, observer.datalogs);
+  TEST_ASSERT_UINT32_WITHIN(SUPPLY_FREQUENCY * 10, SUPPLY_FREQUENCY * 30, summary.cycles);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(3, summary.datalogs);
+
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    TEST_ASSERT_INT_WITHIN(10, -500, observer.lastDatalog.power_L[phase]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0F, 230.0F, observer.lastDatalog.Vrms_L[phase]);
+  }
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    TEST_ASSERT_FLOAT_WITHIN(0.1F, 100.0F, observer.lastDatalog.loadDutyInPercent[i]);
+    TEST_ASSERT_TRUE(observer.lastCycle.loadsON & bit(i));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.01F, 0.0F, static_cast< float >(summary.importInWh));
+  TEST_ASSERT_TRUE(summary.exportInWh > 0);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_csv_source_parses_sample_sets);
+  RUN_TEST(test_binary_source_is_little_endian);
+  RUN_TEST(test_synthetic_replay_closes_the_loop);
+
+  return UNITY_END();
+}
@@ -0,0 +1,168 @@
+#include <unity.h>
+
+#include "runtime_params.h"
+
+namespace
+{
+/**
+ * @brief Default parameters, with a valid checksum
+ */
+StoredParams defaultParams()
+{
+  StoredParams params;
+  params.checksum = paramsChecksum(params);
+  return params;
+}
+
+/**
+ * @brief Compares the stored bytes of two parameter blocks, without the padding of the host
+ */
+void assertSameParams(const StoredParams &expected, const StoredParams &actual)
+{
+  TEST_ASSERT_EQUAL_MEMORY(&expected, &actual, offsetof(StoredParams, checksum) + 1);
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_defaults_match_constexpr(void)
+{
+  const auto values{ makeRuntimeParams(StoredParams{}) };
+
+  TEST_ASSERT_TRUE(outputMode == values.outputMode);
+  TEST_ASSERT_TRUE(toEnergy(REQUIRED_EXPORT_IN_WATTS) == values.requiredExport);
+  TEST_ASSERT_TRUE(toEnergy(DIVERSION_START_THRESHOLD_WATTS) == values.diversionStartThreshold);
+
+  // the thresholds are stored in percent of the working zone
+  TEST_ASSERT_FLOAT_WITHIN(0.01F, energyToFloat(f_lowerThreshold_default), energyToFloat(values.lowerThreshold));
+  TEST_ASSERT_FLOAT_WITHIN(0.01F, energyToFloat(f_upperThreshold_default), energyToFloat(values.upperThreshold));
+}
+
+void test_getters_follow_build(void)
+{
+  runtimeParams = makeRuntimeParams(StoredParams{});
+
+  TEST_ASSERT_TRUE(outputMode == getOutputMode());
+  TEST_ASSERT_TRUE(toEnergy(REQUIRED_EXPORT_IN_WATTS) == getRequiredExport());
+  TEST_ASSERT_TRUE(toEnergy(DIVERSION_START_THRESHOLD_WATTS) == getDiversionStartThreshold());
+
+  // the constexpr build ignores the runtime values
+  StoredParams params{ defaultParams() };
+  TEST_ASSERT_TRUE(parseParamsCommand("E 500", params));
+  applyRuntimeParams(params);
+
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    TEST_ASSERT_TRUE(toEnergy(500) == getRequiredExport());
+  }
+  else
+  {
+    TEST_ASSERT_TRUE(toEnergy(REQUIRED_EXPORT_IN_WATTS) == getRequiredExport());
+  }
+
+  runtimeParams = makeRuntimeParams(StoredParams{});
+}
+
+void test_default_thresholds_of_modes(void)
+{
+  TEST_ASSERT_EQUAL_UINT8(50, defaultThresholdInPercent(OutputModes::NORMAL, true));
+  TEST_ASSERT_EQUAL_UINT8(50, defaultThresholdInPercent(OutputModes::NORMAL, false));
+  TEST_ASSERT_EQUAL_UINT8(40, defaultThresholdInPercent(OutputModes::ANTI_FLICKER, true));
+  TEST_ASSERT_EQUAL_UINT8(60, defaultThresholdInPercent(OutputModes::ANTI_FLICKER, false));
+  TEST_ASSERT_EQUAL_UINT8(50, defaultThresholdInPercent(OutputModes::CYCLE_DISTRIBUTION, true));
+}
+
+void test_parse_commands(void)
+{
+  StoredParams params{ defaultParams() };
+
+  TEST_ASSERT_TRUE(parseParamsCommand("M A", params));
+  TEST_ASSERT_TRUE(OutputModes::ANTI_FLICKER == params.outputMode);
+  TEST_ASSERT_EQUAL_UINT8(40, params.lowerThresholdInPercent);
+  TEST_ASSERT_EQUAL_UINT8(60, params.upperThresholdInPercent);
+
+  TEST_ASSERT_TRUE(parseParamsCommand("l 35", params));
+  TEST_ASSERT_EQUAL_UINT8(35, params.lowerThresholdInPercent);
+
+  TEST_ASSERT_TRUE(parseParamsCommand("U75", params));
+  TEST_ASSERT_EQUAL_UINT8(75, params.upperThresholdInPercent);
+
+  TEST_ASSERT_TRUE(parseParamsCommand("E -250", params));
+  TEST_ASSERT_EQUAL_INT16(-250, params.requiredExportInWatts);
+
+  TEST_ASSERT_TRUE(parseParamsCommand("S 100", params));
+  TEST_ASSERT_EQUAL_INT16(100, params.diversionStartThresholdInWatts);
+
+  TEST_ASSERT_TRUE(parseParamsCommand("m c", params));
+  TEST_ASSERT_TRUE(OutputModes::CYCLE_DISTRIBUTION == params.outputMode);
+  TEST_ASSERT_EQUAL_UINT8(50, params.lowerThresholdInPercent);
+
+  TEST_ASSERT_TRUE(areParamsValid(params));
+
+  TEST_ASSERT_TRUE(parseParamsCommand("D", params));
+  assertSameParams(defaultParams(), params);
+}
+
+void test_rejects_invalid_commands(void)
+{
+  const char *commands[]{ "", "X 1", "M", "M Z", "L", "L 51", "L -1", "U 49", "U 101", "E", "E 40000", "S -1", "S 12a" };
+
+  for (const auto *command : commands)
+  {
+    StoredParams params{ defaultParams() };
+
+    TEST_ASSERT_FALSE_MESSAGE(parseParamsCommand(command, params), command);
+    assertSameParams(defaultParams(), params);
+  }
+}
+
+void test_validation(void)
+{
+  TEST_ASSERT_TRUE(areParamsValid(defaultParams()));
+
+  // checksum not set
+  StoredParams params;
+  params.checksum = paramsChecksum(params) + 1;
+  TEST_ASSERT_FALSE(areParamsValid(params));
+
+  // corrupted value
+  params = defaultParams();
+  params.requiredExportInWatts += 1;
+  TEST_ASSERT_FALSE(areParamsValid(params));
+
+  // erased EEPROM
+  memset(&params, 0xFF, sizeof(params));
+  TEST_ASSERT_FALSE(areParamsValid(params));
+
+  // other layout
+  params = defaultParams();
+  params.version = RUNTIME_PARAMS_VERSION + 1;
+  params.checksum = paramsChecksum(params);
+  TEST_ASSERT_FALSE(areParamsValid(params));
+
+  // out-of-range value with a valid checksum
+  params = defaultParams();
+  params.lowerThresholdInPercent = 60;
+  params.checksum = paramsChecksum(params);
+  TEST_ASSERT_FALSE(areParamsValid(params));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_defaults_match_constexpr);
+  RUN_TEST(test_getters_follow_build);
+  RUN_TEST(test_default_thresholds_of_modes);
+  RUN_TEST(test_parse_commands);
+  RUN_TEST(test_rejects_invalid_commands);
+  RUN_TEST(test_validation);
+
+  return UNITY_END();
+}
@@ -0,0 +1,145 @@
+#include <unity.h>
+#include <cstdint>
+
+#include "sample_block.h"
+
+namespace
+{
+constexpr uint8_t kBlockSize{ 12 }; /**< two sample sets of 3 phases */
+
+/**
+ * @brief Checks that a block holds consecutive samples, starting from 'first'
+ *
+ * @return The number of mismatches
+ */
+uint8_t countMismatches(const int16_t *block, const int16_t first)
+{
+  uint8_t mismatches{ 0 };
+  for (uint8_t i = 0; i < kBlockSize; ++i)
+  {
+    if (block[i] != first + i)
+    {
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_nothing_pending_until_block_full(void)
+{
+  SampleBlocks< kBlockSize > blocks;
+
+  for (int16_t i = 0; i < kBlockSize - 1; ++i)
+  {
+    TEST_ASSERT_FALSE(blocks.store(i));
+    TEST_ASSERT_NULL(blocks.pendingBlock());
+  }
+
+  TEST_ASSERT_TRUE(blocks.store(kBlockSize - 1));
+  TEST_ASSERT_NOT_NULL(blocks.pendingBlock());
+  TEST_ASSERT_EQUAL_UINT8(0, countMismatches(blocks.pendingBlock(), 0));
+}
+
+void test_blocks_alternate(void)
+{
+  SampleBlocks< kBlockSize > blocks;
+  int16_t sample{ 0 };
+  const int16_t *previous{ nullptr };
+
+  for (uint8_t n = 0; n < 10; ++n)
+  {
+    const int16_t first{ sample };
+    bool handedOver{ false };
+    for (uint8_t i = 0; i < kBlockSize; ++i)
+    {
+      handedOver = blocks.store(sample++);
+    }
+
+    TEST_ASSERT_TRUE(handedOver);
+
+    const int16_t *block{ blocks.pendingBlock() };
+    TEST_ASSERT_TRUE(block != previous);  // the other block
+    TEST_ASSERT_EQUAL_UINT8(0, countMismatches(block, first));
+
+    previous = block;
+    blocks.release();
+    TEST_ASSERT_NULL(blocks.pendingBlock());
+  }
+
+  TEST_ASSERT_EQUAL_UINT16(0, blocks.getOverruns());
+}
+
+void test_producer_runs_while_block_is_processed(void)
+{
+  // the ISR goes on filling the other block while the batch stage reads the pending one
+  SampleBlocks< kBlockSize > blocks;
+
+  for (int16_t i = 0; i < kBlockSize; ++i)
+  {
+    blocks.store(i);
+  }
+  const int16_t *block{ blocks.pendingBlock() };
+
+  for (int16_t i = 0; i < kBlockSize - 1; ++i)
+  {
+    TEST_ASSERT_FALSE(blocks.store(1000 + i));
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(0, countMismatches(block, 0));  // untouched
+  blocks.release();
+
+  TEST_ASSERT_TRUE(blocks.store(1000 + kBlockSize - 1));
+  TEST_ASSERT_EQUAL_UINT8(0, countMismatches(blocks.pendingBlock(), 1000));
+  TEST_ASSERT_EQUAL_UINT16(0, blocks.getOverruns());
+}
+
+void test_overrun_drops_the_new_block(void)
+{
+  SampleBlocks< kBlockSize > blocks;
+
+  for (int16_t i = 0; i < kBlockSize; ++i)
+  {
+    blocks.store(i);
+  }
+  const int16_t *block{ blocks.pendingBlock() };
+
+  // the batch stage does not keep up: two more blocks while the first one is pending
+  for (int16_t i = 0; i < 2 * kBlockSize; ++i)
+  {
+    TEST_ASSERT_FALSE(blocks.store(2000 + i));
+  }
+
+  TEST_ASSERT_EQUAL_UINT16(2, blocks.getOverruns());
+  TEST_ASSERT_TRUE(block == blocks.pendingBlock());
+  TEST_ASSERT_EQUAL_UINT8(0, countMismatches(block, 0));  // the pending block is never overwritten
+
+  // the filling restarts at the beginning of a block, so the blocks stay aligned on the sample sets
+  blocks.release();
+  for (int16_t i = 0; i < kBlockSize - 1; ++i)
+  {
+    TEST_ASSERT_FALSE(blocks.store(3000 + i));
+  }
+  TEST_ASSERT_TRUE(blocks.store(3000 + kBlockSize - 1));
+  TEST_ASSERT_EQUAL_UINT8(0, countMismatches(blocks.pendingBlock(), 3000));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_nothing_pending_until_block_full);
+  RUN_TEST(test_blocks_alternate);
+  RUN_TEST(test_producer_runs_while_block_is_processed);
+  RUN_TEST(test_overrun_drops_the_new_block);
+
+  return UNITY_END();
+}
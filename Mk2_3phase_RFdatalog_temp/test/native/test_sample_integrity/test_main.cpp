@@ -0,0 +1,172 @@
+#include <unity.h>
+
+#include "hal.h"
+#include "processing.h"
+#include "sample_integrity.h"
+#include "shared_var.h"
+
+namespace
+{
+/**
+ * @brief Mid-point of the ADC on all the channels
+ */
+int16_t flatSample(const uint8_t)
+{
+  return 512;
+}
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_nominal_sample_sets(void)
+{
+  // 20 ms / (104 µs * 2 * NO_OF_PHASES)
+  TEST_ASSERT_EQUAL_UINT8(32 * 3 / NO_OF_PHASES, NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);
+  TEST_ASSERT_EQUAL_UINT8(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE - NO_OF_SAMPLE_SET_BUCKETS / 2, SAMPLE_SETS_HISTOGRAM_BASE);
+}
+
+void test_histogram_buckets(void)
+{
+  IntegrityStats stats;
+
+  stats.recordMainsCycle(0);                                                      // start-up, first bucket
+  stats.recordMainsCycle(SAMPLE_SETS_HISTOGRAM_BASE);                             // first bucket
+  stats.recordMainsCycle(SAMPLE_SETS_HISTOGRAM_BASE + 1);                         // second bucket
+  stats.recordMainsCycle(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);                    // nominal
+  stats.recordMainsCycle(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);                    // nominal
+  stats.recordMainsCycle(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE + 1);                // nominal + 1
+  stats.recordMainsCycle(SAMPLE_SETS_HISTOGRAM_BASE + NO_OF_SAMPLE_SET_BUCKETS);  // beyond the last bucket
+  stats.recordMainsCycle(UINT8_MAX);
+
+  TEST_ASSERT_EQUAL_UINT16(2, stats.histogram[0]);
+  TEST_ASSERT_EQUAL_UINT16(1, stats.histogram[1]);
+  TEST_ASSERT_EQUAL_UINT16(2, stats.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2]);
+  TEST_ASSERT_EQUAL_UINT16(1, stats.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2 + 1]);
+  TEST_ASSERT_EQUAL_UINT16(2, stats.histogram[NO_OF_SAMPLE_SET_BUCKETS - 1]);
+}
+
+void test_counters_saturate(void)
+{
+  IntegrityStats stats;
+
+  for (uint32_t i = 0; i < 70000; ++i)
+  {
+    stats.recordMissedConversions(1);
+    stats.recordLateConversion();
+    stats.recordMainsCycle(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);
+  }
+  stats.recordMissedConversions(UINT16_MAX);
+
+  TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, stats.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, stats.lateConversions);
+  TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, stats.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2]);
+}
+
+void test_copy_and_reset(void)
+{
+  IntegrityStats stats;
+  volatile IntegrityStats copy;
+
+  stats.recordMissedConversions(1);
+  stats.recordLateConversion();
+  stats.recordLateConversion();
+  stats.recordMainsCycle(NOMINAL_SAMPLE_SETS_PER_MAINS_CYCLE);
+  stats.copyAndReset(copy);
+
+  TEST_ASSERT_EQUAL_UINT16(1, copy.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(2, copy.lateConversions);
+  TEST_ASSERT_EQUAL_UINT16(1, copy.histogram[NO_OF_SAMPLE_SET_BUCKETS / 2]);
+
+  TEST_ASSERT_EQUAL_UINT16(0, stats.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.lateConversions);
+  for (const auto count : stats.histogram)
+  {
+    TEST_ASSERT_EQUAL_UINT16(0, count);
+  }
+}
+
+void test_skipped_conversion_slots(void)
+{
+  ConversionSlots slots;
+  uint16_t now{ 60000 };
+
+  TEST_ASSERT_EQUAL_UINT16(0, slots.skipped(now));  // first run
+
+  // jitter of the entry of the ISR
+  now += ADC_SAMPLE_PERIOD_CYCLES + ADC_ISR_ENTRY_WORST_CASE_CYCLES;
+  TEST_ASSERT_EQUAL_UINT16(0, slots.skipped(now));
+  now += ADC_SAMPLE_PERIOD_CYCLES - ADC_ISR_ENTRY_WORST_CASE_CYCLES;
+  TEST_ASSERT_EQUAL_UINT16(0, slots.skipped(now));
+
+  // one and three conversions skipped, across the wrap-around of the clock
+  now += 2 * ADC_SAMPLE_PERIOD_CYCLES + ADC_ISR_ENTRY_WORST_CASE_CYCLES;
+  TEST_ASSERT_EQUAL_UINT16(1, slots.skipped(now));
+  now += 4 * ADC_SAMPLE_PERIOD_CYCLES - ADC_ISR_ENTRY_WORST_CASE_CYCLES;
+  TEST_ASSERT_EQUAL_UINT16(3, slots.skipped(now));
+}
+
+void test_isr_detects_late_conversions(void)
+{
+  if constexpr (!SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    TEST_IGNORE();
+  }
+
+  HAL::Native::reset();
+  HAL::Native::setADCSource(flatSample);
+  initializeProcessing();
+
+  sampleIntegrity = IntegrityStats{};
+
+  HAL::Native::runADCConversions(100);
+  TEST_ASSERT_EQUAL_UINT16(0, sampleIntegrity.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(0, sampleIntegrity.lateConversions);
+
+  // ADIF set at the exit of the ISR
+  HAL::Native::adcFlag = true;
+  HAL::Native::runADCConversions(3);
+  HAL::Native::adcFlag = false;
+
+  TEST_ASSERT_EQUAL_UINT16(0, sampleIntegrity.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(3, sampleIntegrity.lateConversions);
+}
+
+void test_isr_detects_dropped_conversion(void)
+{
+  if constexpr (!SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    TEST_IGNORE();
+  }
+
+  HAL::Native::reset();
+  HAL::Native::setADCSource(flatSample);
+  initializeProcessing();
+
+  HAL::Native::runADCConversions(100);
+  sampleIntegrity = IntegrityStats{};
+
+  HAL::Native::dropConversion = true;
+  HAL::Native::runADCConversions(100);
+
+  TEST_ASSERT_EQUAL_UINT16(1, sampleIntegrity.missedConversions);
+  TEST_ASSERT_EQUAL_UINT16(0, sampleIntegrity.lateConversions);
+}
+
+int main(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_nominal_sample_sets);
+  RUN_TEST(test_histogram_buckets);
+  RUN_TEST(test_counters_saturate);
+  RUN_TEST(test_copy_and_reset);
+  RUN_TEST(test_skipped_conversion_slots);
+  RUN_TEST(test_isr_detects_late_conversions);
+  RUN_TEST(test_isr_detects_dropped_conversion);
+  return UNITY_END();
+}
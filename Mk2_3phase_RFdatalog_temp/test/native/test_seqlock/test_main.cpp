@@ -0,0 +1,161 @@
+#include <unity.h>
+
+#include "seqlock.h"
+
+namespace
+{
+constexpr uint8_t kNoOfValues{ 16 };
+
+void (*onCopyStep)(){ nullptr }; /**< simulated ISR, called by the reader between the copies of two values */
+
+/**
+ * @brief Data whose copy can be interrupted, a coherent set has all its values equal
+ */
+struct Payload
+{
+  uint32_t values[kNoOfValues]{};
+
+  Payload& operator=(const Payload& other)
+  {
+    for (uint8_t i = 0; i < kNoOfValues; ++i)
+    {
+      values[i] = other.values[i];
+      if (onCopyStep)
+      {
+        onCopyStep();
+      }
+    }
+    return *this;
+  }
+
+  bool isCoherent() const
+  {
+    for (uint8_t i = 1; i < kNoOfValues; ++i)
+    {
+      if (values[i] != values[0])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+Seqlock< Payload > seqlock;
+Payload unprotected;
+uint32_t published{ 0 };
+uint32_t rngState{ 0x12345678 };
+
+/**
+ * @brief Small xorshift generator, reproducible on every host
+ */
+uint32_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+/**
+ * @brief Simulated ISR, publishing a new set of values from time to time
+ */
+void simulatedISR()
+{
+  if (nextRandom() % 8)
+  {
+    return;
+  }
+
+  ++published;
+
+  auto& data{ seqlock.beginWrite() };
+  for (auto& value : data.values)
+  {
+    value = published;
+  }
+  seqlock.endWrite();
+
+  for (auto& value : unprotected.values)
+  {
+    value = published;
+  }
+}
+}
+
+void setUp(void)
+{
+  onCopyStep = nullptr;
+}
+
+void tearDown(void)
+{
+  onCopyStep = nullptr;
+}
+
+void test_read_without_writer(void)
+{
+  Seqlock< Payload > buffer;
+  Payload copy;
+
+  TEST_ASSERT_EQUAL_UINT8(0, buffer.read(copy));
+  TEST_ASSERT_TRUE(copy.isCoherent());
+  TEST_ASSERT_EQUAL_UINT32(0, copy.values[0]);
+
+  auto& data{ buffer.beginWrite() };
+  for (auto& value : data.values)
+  {
+    value = 42;
+  }
+  buffer.endWrite();
+
+  TEST_ASSERT_EQUAL_UINT8(1, buffer.getVersion());
+  TEST_ASSERT_EQUAL_UINT8(1, buffer.read(copy));
+  TEST_ASSERT_EQUAL_UINT32(42, copy.values[15]);
+}
+
+void test_naive_copy_tears(void)
+{
+  // without the sequence check, an ISR in the middle of the copy gives a torn set
+  onCopyStep = simulatedISR;
+
+  uint16_t torn{ 0 };
+  for (uint16_t i = 0; i < 1000; ++i)
+  {
+    Payload copy;
+    copy = unprotected;
+    torn += !copy.isCoherent();
+  }
+
+  TEST_ASSERT_TRUE(torn > 500);
+}
+
+void test_stress_interleaved_writes(void)
+{
+  onCopyStep = simulatedISR;
+
+  uint32_t previous{ 0 };
+  for (uint32_t i = 0; i < 100000; ++i)
+  {
+    Payload copy;
+    const auto version{ seqlock.read(copy) };
+
+    TEST_ASSERT_TRUE(copy.isCoherent());
+    TEST_ASSERT_EQUAL_UINT8(copy.values[0] & 0x7F, version);  // the version wraps at 128
+    TEST_ASSERT_TRUE(copy.values[0] >= previous);  // never older than a previous copy
+    previous = copy.values[0];
+  }
+
+  TEST_ASSERT_GREATER_THAN_UINT32(100000, published);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_read_without_writer);
+  RUN_TEST(test_naive_copy_tears);
+  RUN_TEST(test_stress_interleaved_writes);
+
+  return UNITY_END();
+}
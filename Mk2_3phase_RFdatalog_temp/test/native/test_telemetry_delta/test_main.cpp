@@ -0,0 +1,188 @@
+#include <unity.h>
+
+#include "telemetry_delta.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_first_frame_is_a_keyframe(void)
+{
+  DeltaFilter< 4 > filter;
+
+  TEST_ASSERT_TRUE(filter.startFrame());
+  TEST_ASSERT_EQUAL_UINT16(0, filter.getSequence());
+  TEST_ASSERT_TRUE(filter.changed(1, 0, 100));
+}
+
+void test_keyframe_period(void)
+{
+  DeltaFilter< 4 > filter;
+
+  for (uint8_t frame = 0; frame < 3 * TELEMETRY_KEYFRAME_PERIOD; ++frame)
+  {
+    TEST_ASSERT_EQUAL(frame % TELEMETRY_KEYFRAME_PERIOD == 0, filter.startFrame());
+    TEST_ASSERT_EQUAL_UINT16(frame, filter.getSequence());
+  }
+}
+
+void test_keyframe_sends_unchanged_values(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 230, 50);
+
+  for (uint8_t frame = 1; frame < TELEMETRY_KEYFRAME_PERIOD; ++frame)
+  {
+    filter.startFrame();
+    TEST_ASSERT_FALSE(filter.changed(1, 230, 50));
+  }
+
+  filter.startFrame();
+  TEST_ASSERT_TRUE(filter.changed(1, 230, 50));
+}
+
+void test_deadband(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 1000, 20);
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 1020, 20));
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 980, 20));
+
+  filter.startFrame();
+  TEST_ASSERT_TRUE(filter.changed(1, 979, 20));
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 990, 20));
+}
+
+void test_slow_drift_is_sent(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 1000, 20);
+
+  // the change is measured from the last value sent, not from the previous frame
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 1010, 20));
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 1020, 20));
+  filter.startFrame();
+  TEST_ASSERT_TRUE(filter.changed(1, 1030, 20));
+}
+
+void test_negative_values(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, static_cast< uint16_t >(-5), 20);
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 10, 20));
+
+  filter.startFrame();
+  TEST_ASSERT_TRUE(filter.changed(1, static_cast< uint16_t >(-30), 20));
+}
+
+void test_lines_are_tracked_by_position(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 100, 0);
+  filter.changed(2, 200, 0);
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 100, 0));
+  TEST_ASSERT_TRUE(filter.changed(2, 201, 0));
+}
+
+void test_shifted_line_is_sent(void)
+{
+  DeltaFilter< 4 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 100, 0);
+  filter.changed(2, 100, 0);
+  filter.changed(3, 100, 0);
+
+  // line 2 is missing, line 3 takes its place
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 100, 0));
+  TEST_ASSERT_TRUE(filter.changed(3, 100, 0));
+}
+
+void test_extra_lines_are_sent(void)
+{
+  DeltaFilter< 1 > filter;
+
+  filter.startFrame();
+  filter.changed(1, 100, 0);
+  filter.changed(2, 100, 0);
+
+  filter.startFrame();
+  TEST_ASSERT_FALSE(filter.changed(1, 100, 0));
+  TEST_ASSERT_TRUE(filter.changed(2, 100, 0));
+}
+
+void test_disabled_filter_sends_everything(void)
+{
+  DeltaFilter< 0 > filter;
+
+  // empty class, no state kept
+  TEST_ASSERT_EQUAL_UINT(1, sizeof(filter));
+
+  for (uint8_t frame = 0; frame < 3; ++frame)
+  {
+    TEST_ASSERT_TRUE(filter.startFrame());
+    TEST_ASSERT_TRUE(filter.changed(1, 100, 20));
+    TEST_ASSERT_TRUE(filter.changed(2, 100, 20));
+  }
+}
+
+void test_deadband_lookup(void)
+{
+  TEST_ASSERT_EQUAL_UINT16(20, telemetryDeadband("P"));
+  TEST_ASSERT_EQUAL_UINT16(20, telemetryDeadband("VA"));
+  TEST_ASSERT_EQUAL_UINT16(0, telemetryDeadband("TXD"));
+}
+
+void test_line_keys(void)
+{
+  TEST_ASSERT_NOT_EQUAL(telemetryLineKey("V", 1), telemetryLineKey("V", 2));
+  TEST_ASSERT_NOT_EQUAL(telemetryLineKey("P", 1), telemetryLineKey("V", 1));
+  TEST_ASSERT_NOT_EQUAL(telemetryTextHash("1234"), telemetryTextHash("1235"));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_first_frame_is_a_keyframe);
+  RUN_TEST(test_keyframe_period);
+  RUN_TEST(test_keyframe_sends_unchanged_values);
+  RUN_TEST(test_deadband);
+  RUN_TEST(test_slow_drift_is_sent);
+  RUN_TEST(test_negative_values);
+  RUN_TEST(test_lines_are_tracked_by_position);
+  RUN_TEST(test_shifted_line_is_sent);
+  RUN_TEST(test_extra_lines_are_sent);
+  RUN_TEST(test_disabled_filter_sends_everything);
+  RUN_TEST(test_deadband_lookup);
+  RUN_TEST(test_line_keys);
+
+  return UNITY_END();
+}
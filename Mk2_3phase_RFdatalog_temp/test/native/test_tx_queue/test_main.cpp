@@ -0,0 +1,163 @@
+#include <unity.h>
+
+#include "tx_queue.h"
+
+namespace
+{
+/**
+ * @brief Serial link whose hardware buffer takes a limited number of bytes
+ */
+struct FakePort
+{
+  int room{ 0 };
+  uint8_t sent[64]{};
+  uint8_t count{ 0 };
+
+  int availableForWrite()
+  {
+    return room;
+  }
+  size_t write(uint8_t c)
+  {
+    --room;
+    sent[count++] = c;
+    return 1;
+  }
+};
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_frame_is_sent_when_ended(void)
+{
+  TxQueue< 16 > queue;
+  FakePort port;
+  port.room = 64;
+
+  queue.beginFrame();
+  queue.print("abc");
+
+  // nothing is sent before the end of the frame
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(0, port.count);
+  TEST_ASSERT_EQUAL_UINT16(0, queue.size());
+
+  TEST_ASSERT_TRUE(queue.endFrame());
+  TEST_ASSERT_EQUAL_UINT16(3, queue.size());
+
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(3, port.count);
+  TEST_ASSERT_EQUAL_MEMORY("abc", port.sent, 3);
+  TEST_ASSERT_EQUAL_UINT16(0, queue.size());
+}
+
+void test_drain_respects_budget(void)
+{
+  TxQueue< 16 > queue;
+  FakePort port;
+
+  queue.beginFrame();
+  queue.print("0123456789");
+  queue.endFrame();
+
+  port.room = 4;
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(4, port.count);
+  TEST_ASSERT_EQUAL_UINT16(6, queue.size());
+
+  // hardware buffer full: nothing more is written
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(4, port.count);
+
+  port.room = 64;
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(10, port.count);
+  TEST_ASSERT_EQUAL_MEMORY("0123456789", port.sent, 10);
+}
+
+void test_overflowing_frame_is_dropped(void)
+{
+  TxQueue< 8 > queue;
+  FakePort port;
+
+  queue.beginFrame();
+  queue.print("12345");
+  TEST_ASSERT_TRUE(queue.endFrame());
+
+  // only 3 bytes left: the whole frame is dropped, the previous one is kept
+  queue.beginFrame();
+  queue.print("abcd");
+  TEST_ASSERT_FALSE(queue.endFrame());
+  TEST_ASSERT_EQUAL_UINT16(1, queue.getDroppedFrames());
+  TEST_ASSERT_EQUAL_UINT16(5, queue.size());
+
+  // a frame fitting in the space left is still queued
+  queue.beginFrame();
+  queue.print("xyz");
+  TEST_ASSERT_TRUE(queue.endFrame());
+
+  port.room = 64;
+  queue.drain(port);
+  TEST_ASSERT_EQUAL_UINT8(8, port.count);
+  TEST_ASSERT_EQUAL_MEMORY("12345xyz", port.sent, 8);
+}
+
+void test_indices_wrap_around(void)
+{
+  TxQueue< 8 > queue;
+  FakePort port;
+
+  // the free-running 16-bit indices wrap around after 65536 bytes
+  for (uint16_t lap = 0; lap < 20000; ++lap)
+  {
+    queue.beginFrame();
+    queue.write(static_cast< uint8_t >(lap));
+    queue.write(static_cast< uint8_t >(lap >> 8));
+    queue.write(static_cast< uint8_t >(0x5A));
+    queue.write(static_cast< uint8_t >(0xA5));
+    queue.write(static_cast< uint8_t >(lap ^ 0xFF));
+    TEST_ASSERT_TRUE(queue.endFrame());
+
+    port.count = 0;
+    port.room = 64;
+    queue.drain(port);
+    TEST_ASSERT_EQUAL_UINT8(5, port.count);
+    TEST_ASSERT_EQUAL_HEX8(lap, port.sent[0]);
+    TEST_ASSERT_EQUAL_HEX8(lap >> 8, port.sent[1]);
+    TEST_ASSERT_EQUAL_HEX8(lap ^ 0xFF, port.sent[4]);
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, queue.getDroppedFrames());
+}
+
+void test_telemetry_port(void)
+{
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    TEST_ASSERT_EQUAL_PTR(&txQueue, &telemetryPort());
+  }
+  else
+  {
+    // no buffer, the telemetry is written to the serial link
+    TEST_ASSERT_EQUAL_PTR(&Serial, &telemetryPort());
+    TEST_ASSERT_EQUAL_UINT(1, sizeof(txQueue));
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_frame_is_sent_when_ended);
+  RUN_TEST(test_drain_respects_budget);
+  RUN_TEST(test_overflowing_frame_is_dropped);
+  RUN_TEST(test_indices_wrap_around);
+  RUN_TEST(test_telemetry_port);
+
+  return UNITY_END();
+}
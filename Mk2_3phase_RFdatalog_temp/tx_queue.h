@@ -0,0 +1,214 @@
+/**
+ * @file tx_queue.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Transmit queue of the serial telemetry, sent in the background
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @details At 9600 bauds, a telemetry frame takes up to ~300 ms to be sent, while the hardware buffer
+ *          of the serial link only holds 64 bytes: writing a frame directly blocks loop() until most
+ *          of it has been sent.
+ *
+ *          When TELEMETRY_TX_QUEUE is set (see config.h), the frames are written to this queue
+ *          instead, and loop() moves at each iteration only as many bytes as the hardware buffer
+ *          can take without blocking. The UDRE interrupt of the serial link then sends them.
+ *
+ *          A frame is queued entirely or not at all: if it doesn't fit, it is dropped and counted,
+ *          so the receiver never gets a truncated frame.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "type_traits.hpp"
+
+/**
+ * @brief Byte queue with frame-atomic writes
+ *
+ * @details The bytes of the frame being written are stored after the head, which is only moved
+ *          when the frame is complete. Producer and consumer both run in loop().
+ *
+ * @tparam N Capacity in bytes, a power of two
+ */
+template< uint16_t N >
+class TxQueue : public Print
+{
+  static_assert(N >= 2 && !(N & (N - 1)), "******** The capacity of the TX queue must be a power of two ! ********");
+
+public:
+  /**
+   * @brief Starts a new frame, dropping the current one if it has not been ended.
+   *
+   */
+  void beginFrame()
+  {
+    frameEnd = head;
+    overflowed = false;
+  }
+
+  /**
+   * @brief Adds a byte to the current frame.
+   *
+   * @param c The byte
+   * @return 0 if the queue is full, the frame being dropped when ended
+   */
+  size_t write(uint8_t c) override
+  {
+    if (overflowed || static_cast< uint16_t >(frameEnd - tail) == N)
+    {
+      overflowed = true;
+      return 0;
+    }
+
+    buffer[frameEnd++ & (N - 1)] = c;
+    return 1;
+  }
+
+  using Print::write;
+
+  /**
+   * @brief Ends the current frame, which is then sent, or dropped if it didn't fit.
+   *
+   * @return true if the frame has been queued
+   */
+  bool endFrame()
+  {
+    if (overflowed)
+    {
+      if (droppedFrames != UINT16_MAX)
+      {
+        ++droppedFrames;
+      }
+      frameEnd = head;
+      return false;
+    }
+
+    head = frameEnd;
+    return true;
+  }
+
+  /**
+   * @brief Moves the queued bytes to a serial link, without blocking.
+   *
+   * @tparam Port Serial link, with availableForWrite() and write(uint8_t)
+   * @param port The serial link
+   */
+  template< typename Port >
+  void drain(Port &port)
+  {
+    int budget{ port.availableForWrite() };
+
+    while (budget > 0 && tail != head)
+    {
+      port.write(buffer[tail++ & (N - 1)]);
+      --budget;
+    }
+  }
+
+  /**
+   * @brief Number of bytes of the complete frames waiting to be sent.
+   *
+   */
+  uint16_t size() const
+  {
+    return head - tail;
+  }
+
+  /**
+   * @brief Number of frames dropped because the queue was full (saturated).
+   *
+   */
+  uint16_t getDroppedFrames() const
+  {
+    return droppedFrames;
+  }
+
+private:
+  uint8_t buffer[N]{};         /**< the bytes */
+  uint16_t head{ 0 };          /**< end of the last complete frame */
+  uint16_t tail{ 0 };          /**< next byte to send */
+  uint16_t frameEnd{ 0 };      /**< end of the frame being written */
+  uint16_t droppedFrames{ 0 }; /**< number of dropped frames */
+  bool overflowed{ false };    /**< the frame being written doesn't fit */
+};
+
+/**
+ * @brief Stand-in for the TX queue when TELEMETRY_TX_QUEUE is not set
+ *
+ * @details No buffer: the frames are written directly to the serial link (see telemetryPort()).
+ *          It only provides the interface of TxQueue used by the code disabled with if constexpr.
+ */
+class NoTxQueue
+{
+public:
+  void beginFrame()
+  {
+  }
+
+  bool endFrame()
+  {
+    return true;
+  }
+
+  template< typename Port >
+  void drain(Port & /*port*/)
+  {
+  }
+
+  uint16_t size() const
+  {
+    return 0;
+  }
+
+  uint16_t getDroppedFrames() const
+  {
+    return 0;
+  }
+};
+
+/**
+ * @brief Type of the TX queue
+ * @details TxQueue< TX_QUEUE_SIZE > is not instantiated, and takes no RAM, when TELEMETRY_TX_QUEUE is not set.
+ */
+using TelemetryTxQueue = typename conditional< TELEMETRY_TX_QUEUE, TxQueue< TX_QUEUE_SIZE >, NoTxQueue >::type;
+
+inline TelemetryTxQueue txQueue; /**< telemetry waiting to be sent (TELEMETRY_TX_QUEUE) */
+
+/**
+ * @brief Output of the serial telemetry, when written to the TX queue
+ *
+ * @param queue The TX queue
+ * @return The TX queue
+ */
+inline Print &telemetryOutput(Print &queue)
+{
+  return queue;
+}
+
+/**
+ * @brief Output of the serial telemetry, without TX queue
+ *
+ * @return The serial link
+ */
+inline Print &telemetryOutput(NoTxQueue & /*queue*/)
+{
+  return Serial;
+}
+
+/**
+ * @brief Output of the serial telemetry
+ *
+ * @return The TX queue if enabled, the serial link otherwise
+ */
+inline Print &telemetryPort()
+{
+  return telemetryOutput(txQueue);
+}
+
+#endif /* TX_QUEUE_H */
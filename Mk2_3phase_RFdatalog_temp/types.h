@@ -27,7 +27,8 @@ enum class SerialOutputType
 {
   HumanReadable, /**< Human-readable output for commissioning */
   IoT,           /**< Output for HomeAssistant or similar */
-  JSON           /**< Output in JSON format */
+  JSON,          /**< Output in JSON format */
+  Binary         /**< Compact binary frames with COBS framing and CRC16 (see binary_telemetry.h) */
 };
 
 /** Polarities */
@@ -40,8 +41,9 @@ enum class Polarities : uint8_t
 /** Output modes */
 enum class OutputModes : uint8_t
 {
-  ANTI_FLICKER, /**< Anti-flicker mode */
-  NORMAL        /**< Normal mode */
+  ANTI_FLICKER,       /**< Anti-flicker mode */
+  NORMAL,             /**< Normal mode */
+  CYCLE_DISTRIBUTION  /**< ON cycles spread evenly according to the surplus (see cycle_distribution.h) */
 };
 
 /** Load state (for use if loads are active high (Rev 2 PCB)) */
@@ -78,6 +80,20 @@ public:
   int16_t temperature_x100[S]{}; /**< temperature in 100th of °C */
 };
 
+/** @brief container for the current measurements
+ *  @details This class is used for datalogging when CURRENT_RMS_MEASUREMENT is set.
+ *           It is kept apart from PayloadTx_struct, whose layout is sent as is over RF.
+ *
+ * @tparam N # of phases
+ */
+template< uint8_t N = 3 > class CurrentData_struct
+{
+public:
+  uint16_t Irms_L_x100[N]{}; /**< average current over datalogging period (in 100th of Ampere) */
+  uint16_t VA_L[N]{};        /**< apparent power over datalogging period (in VA) */
+  int8_t PF_L_x100[N]{};     /**< power factor over datalogging period (in 100th), with the sign of the power */
+};
+
 /**
  * @brief Helper function to retrieve the dimension of a C-array
  *
@@ -13,16 +13,21 @@
 #define UTILS_H
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 
 #include "FastDivision.h"
 
+#include "binary_telemetry.h"
 #include "calibration.h"
 #include "constants.h"
 #include "dualtariff.h"
+#include "energy_meters.h"
+#include "isr_timing.h"
+#include "json_writer.h"
+#include "pll.h"
 #include "processing.h"
 #include "shared_var.h"
 #include "teleinfo.h"
+#include "tx_queue.h"
 
 #include "utils_rf.h"
 #include "utils_temp.h"
@@ -170,6 +175,126 @@ inline void printConfiguration()
   DBUGLN(F("is NOT present"));
 #endif
 
+  DBUG(F("ADC "));
+  if constexpr (ADC_TIMER_TRIGGERED)
+  {
+    DBUG(F("triggered by Timer1 every "));
+    DBUG(ADC_SAMPLE_PERIOD_CYCLES);
+    DBUG(F(" cycles"));
+  }
+  else
+  {
+    DBUG(F("free-running"));
+  }
+  DBUG(F(", clock F_CPU / "));
+  DBUGLN(ADC_PRESCALER);
+
+  DBUG(F("ISR timing instrumentation "));
+  if constexpr (ISR_TIMING_INSTRUMENTATION)
+  {
+    DBUGLN(F("is present"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT present"));
+  }
+
+  DBUG(F("Sample integrity diagnostics "));
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    DBUGLN(F("are present"));
+  }
+  else
+  {
+    DBUGLN(F("are NOT present"));
+  }
+
+  DBUG(F("Current DC offset tracking "));
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    DBUGLN(F("is enabled"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT enabled"));
+  }
+
+  DBUG(F("Current RMS measurement "));
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    DBUGLN(F("is enabled"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT enabled"));
+  }
+
+  DBUG(F("Per-cycle streaming "));
+  if constexpr (CYCLE_STREAMING)
+  {
+    DBUG(F("is enabled, "));
+    DBUG(CYCLE_STREAMING_BAUD_RATE);
+    DBUGLN(F(" bauds"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT enabled"));
+  }
+
+  DBUG(F("Runtime parameters (EEPROM, serial commands) "));
+  if constexpr (RUNTIME_PARAMETERS)
+  {
+    DBUGLN(F("are enabled"));
+  }
+  else
+  {
+    DBUGLN(F("are NOT enabled"));
+  }
+
+  DBUG(F("Energy meters (EEPROM) "));
+  if constexpr (ENERGY_METERS)
+  {
+    DBUGLN(F("are enabled"));
+  }
+  else
+  {
+    DBUGLN(F("are NOT enabled"));
+  }
+
+  DBUG(F("Telemetry TX queue "));
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    DBUG(F("is enabled, "));
+    DBUG(TX_QUEUE_SIZE);
+    DBUGLN(F(" bytes"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT enabled"));
+  }
+
+  DBUG(F("Telemetry delta frames "));
+  if constexpr (TELEMETRY_DELTA_FRAMES)
+  {
+    DBUG(F("are enabled, keyframe every "));
+    DBUG(TELEMETRY_KEYFRAME_PERIOD);
+    DBUGLN(F(" periods"));
+  }
+  else
+  {
+    DBUGLN(F("are NOT enabled"));
+  }
+
+  DBUG(F("Block processing "));
+  if constexpr (BLOCK_PROCESSING)
+  {
+    DBUGLN(F("is enabled"));
+  }
+  else
+  {
+    DBUGLN(F("is NOT enabled"));
+  }
+
   DBUG(F("Datalogging capability "));
   if constexpr (SERIAL_OUTPUT_TYPE == SerialOutputType::HumanReadable)
   {
@@ -183,12 +308,31 @@ inline void printConfiguration()
   {
     DBUGLN(F("in JSON format"));
   }
+  else if constexpr (SERIAL_OUTPUT_TYPE == SerialOutputType::Binary)
+  {
+    DBUGLN(F("in binary format"));
+  }
   else
   {
     DBUGLN(F("is NOT present"));
   }
 }
 
+/**
+ * @brief Returns the mains frequency measured during the datalog period.
+ *
+ * @tparam Datalog The datalog type, whose mainsPeriod member only exists with MAINS_FREQUENCY_MEASUREMENT
+ * @param data The datalog values
+ * @return uint16_t The mains frequency in 1/100 Hz, 0 if the PLL was not locked
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+uint16_t mainsFrequency_x100(const Datalog& data)
+{
+  return pllFrequency_x100(data.mainsPeriod);
+}
+
 /**
  * @brief Write telemetry data to Serial in JSON format.
  *
@@ -202,36 +346,50 @@ inline void printConfiguration()
  * - Includes load ON percentages for each load.
  * - Outputs temperature data if temperature sensing is enabled.
  * - Includes tariff information if dual tariff is enabled.
+ * - The members are streamed to the output (see json_writer.h), without building a document in RAM.
  *
  * @ingroup Telemetry
  */
 inline void printForJSON(const bool bOffPeak)
 {
-  ArduinoJson::StaticJsonDocument< 256 > doc;
+  Print &output{ telemetryPort() };
+  JsonWriter json{ output };
 
   // Total mean power over a data logging period
-  doc["P"] = tx_data.power;
+  json.add(F("P"), tx_data.power);
 
   if constexpr (RELAY_DIVERSION)
   {
-    doc["R"] = relays.get_average();
+    json.add(F("R"), relays.get_average());
   }
 
-  if constexpr (NO_OF_PHASES == 3)
+  static_assert(NO_OF_PHASES != 1, "Unsupported number of phases");
+
+  // Mean power for each phase over a data logging period
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
   {
-    // Mean power for each phase over a data logging period
-    doc["P1"] = tx_data.power_L[0];
-    doc["P2"] = tx_data.power_L[1];
-    doc["P3"] = tx_data.power_L[2];
+    json.add(F("P"), tx_data.power_L[phase], phase + 1);
   }
-  else if constexpr (NO_OF_PHASES == 2)
+
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
   {
-    // Mean power for each phase over a data logging period
-    doc["P1"] = tx_data.power_L[0];
-    doc["P2"] = tx_data.power_L[1];
+    // Mains frequency, as long as the PLL is locked
+    if (const uint16_t frequency_x100{ mainsFrequency_x100(copyOf_datalog) })
+    {
+      json.addHundredths(F("F"), frequency_x100);
+    }
+  }
+
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    // Current, apparent power and power factor for each phase over a data logging period
+    for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+    {
+      json.addHundredths(F("I"), current_data.Irms_L_x100[phase], phase + 1);
+      json.add(F("VA"), current_data.VA_L[phase], phase + 1);
+      json.addHundredths(F("PF"), current_data.PF_L_x100[phase], phase + 1);
+    }
   }
-  else
-    static_assert(NO_OF_PHASES != 1, "Unsupported number of phases");
 
   // Mean power for each load over a data logging period (in %)
   //for (idx = 0; idx < NO_OF_DUMPLOADS; ++idx)
@@ -252,18 +410,164 @@ inline void printForJSON(const bool bOffPeak)
         continue;
       }
 
-      doc[String("T") + (idx + 1)] = (float)tx_data.temperature_x100[idx] * 0.01F;
+      json.addHundredths(F("T"), tx_data.temperature_x100[idx], idx + 1);
     }
   }
 
   if constexpr (DUAL_TARIFF)
   {
     // Current tariff
-    doc["TA"] = bOffPeak ? "low" : "high";
+    json.addText(F("TA"), bOffPeak ? "low" : "high");
+  }
+
+  if constexpr (ENERGY_METERS)
+  {
+    // Cumulative energies in Wh, written as raw numbers since they don't fit in a float
+    char digits[UINT64_MAX_DIGITS + 1];
+
+    json.addRaw(F("EI"), uint64ToDecimal(energyMeters.getImport(), digits));
+    json.addRaw(F("EE"), uint64ToDecimal(energyMeters.getExport(), digits));
+    for (uint8_t idx = 0; idx < NO_OF_DUMPLOADS; ++idx)
+    {
+      json.addRaw(F("ED"), uint64ToDecimal(energyMeters.getDiverted(idx), digits), idx + 1);
+    }
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    // Frames dropped by the TX queue
+    json.add(F("TXD"), txQueue.getDroppedFrames());
+  }
+
+  json.end();
+  output.println();
+}
+
+/**
+ * @brief Prints the cumulative energies.
+ *
+ * @details Format: ", EI:import, EE:export, ED:load1/load2/...", in Wh.
+ *
+ * @ingroup Telemetry
+ */
+inline void printEnergyMeters()
+{
+  Print &output{ telemetryPort() };
+  char digits[UINT64_MAX_DIGITS + 1];
+
+  output.print(F(", EI:"));
+  output.print(uint64ToDecimal(energyMeters.getImport(), digits));
+  output.print(F(", EE:"));
+  output.print(uint64ToDecimal(energyMeters.getExport(), digits));
+  output.print(F(", ED:"));
+  for (uint8_t idx = 0; idx < NO_OF_DUMPLOADS; ++idx)
+  {
+    if (idx)
+    {
+      output.print(F("/"));
+    }
+    output.print(uint64ToDecimal(energyMeters.getDiverted(idx), digits));
+  }
+}
+
+/**
+ * @brief Prints the missed and late conversions, and the histogram of the sample sets per mains cycle.
+ *
+ * @details Format: ", missed/late m/l, S/MC [histogram from SAMPLE_SETS_HISTOGRAM_BASE]".
+ *          The first and the last buckets also count the lower and the higher numbers.
+ *
+ * @tparam Datalog The datalog type, whose sampleIntegrity member only exists with SAMPLE_INTEGRITY_DIAGNOSTICS
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void printSampleIntegrity(const Datalog& data)
+{
+  Print &output{ telemetryPort() };
+  const auto& integrity{ data.sampleIntegrity };
+
+  output.print(F(", missed/late "));
+  output.print(integrity.missedConversions);
+  output.print(F("/"));
+  output.print(integrity.lateConversions);
+
+  output.print(F(", S/MC "));
+  output.print(SAMPLE_SETS_HISTOGRAM_BASE);
+  output.print(F("+ ["));
+  for (uint8_t i = 0; i < NO_OF_SAMPLE_SET_BUCKETS; ++i)
+  {
+    if (i)
+    {
+      output.print(F(" "));
+    }
+    output.print(integrity.histogram[i]);
   }
+  output.print(F("]"));
+}
+
+/**
+ * @brief Prints the measured execution times of the ISR, in µs.
+ *
+ * @details Format: "ISR min-max us [histogram in 16 µs buckets], +HC max, NC max, DL max".
+ *
+ * @tparam Datalog The datalog type, whose isrTiming member only exists with ISR_TIMING_INSTRUMENTATION
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void printIsrTiming(const Datalog& data)
+{
+  Print &output{ telemetryPort() };
+  const auto& isr{ data.isrTiming[static_cast< uint8_t >(TimedSections::ISR)] };
 
-  serializeJson(doc, Serial);
-  Serial.println();
+  output.print(F(", ISR "));
+  output.print(ticksToMicroseconds(isr.minTicks));
+  output.print(F("-"));
+  output.print(ticksToMicroseconds(isr.maxTicks));
+  output.print(F("us ["));
+  for (uint8_t i = 0; i < NO_OF_TIMING_BUCKETS; ++i)
+  {
+    if (i)
+    {
+      output.print(F(" "));
+    }
+    output.print(isr.histogram[i]);
+  }
+  output.print(F("], +HC "));
+  output.print(ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::PLUS_HALF_CYCLE)].maxTicks));
+  output.print(F("us, NC "));
+  output.print(ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::START_NEW_CYCLE)].maxTicks));
+  output.print(F("us, DL "));
+  output.print(ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::DATALOGGING)].maxTicks));
+  output.print(F("us"));
+}
+
+/**
+ * @brief Prints the DC offset of the current of each phase, in ADC steps.
+ *
+ * @details Format: ", I_DC o1/o2/o3".
+ *
+ * @tparam Datalog The datalog type, whose DCoffset_I member only exists with CURRENT_DC_OFFSET_TRACKING
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void printCurrentDCoffset(const Datalog& data)
+{
+  Print &output{ telemetryPort() };
+
+  output.print(F(", I_DC "));
+  for (uint8_t phase = 0; phase < NO_OF_PHASES; ++phase)
+  {
+    if (phase)
+    {
+      output.print(F("/"));
+    }
+    output.print(data.DCoffset_I[phase] * (1.0F / 256));
+  }
 }
 
 /**
@@ -281,31 +585,59 @@ inline void printForJSON(const bool bOffPeak)
  */
 inline void printForSerialText()
 {
+  Print &output{ telemetryPort() };
   uint8_t phase{ 0 };
 
-  Serial.print(Shared::copyOf_energyInBucket_main * invSUPPLY_FREQUENCY);
-  Serial.print(F(", P:"));
-  Serial.print(tx_data.power);
+  output.print(copyOf_datalog.energyInBucket_main * invSUPPLY_FREQUENCY);
+  output.print(F(", P:"));
+  output.print(tx_data.power);
 
   if constexpr (RELAY_DIVERSION)
   {
-    Serial.print(F("/"));
-    Serial.print(relays.get_average());
+    output.print(F("/"));
+    output.print(relays.get_average());
   }
 
   for (phase = 0; phase < NO_OF_PHASES; ++phase)
   {
-    Serial.print(F(", P"));
-    Serial.print(phase + 1);
-    Serial.print(F(":"));
-    Serial.print(tx_data.power_L[phase]);
+    output.print(F(", P"));
+    output.print(phase + 1);
+    output.print(F(":"));
+    output.print(tx_data.power_L[phase]);
   }
   for (phase = 0; phase < NO_OF_PHASES; ++phase)
   {
-    Serial.print(F(", V"));
-    Serial.print(phase + 1);
-    Serial.print(F(":"));
-    Serial.print((float)tx_data.Vrms_L_x100[phase] * 0.01F);
+    output.print(F(", V"));
+    output.print(phase + 1);
+    output.print(F(":"));
+    output.print((float)tx_data.Vrms_L_x100[phase] * 0.01F);
+  }
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    for (phase = 0; phase < NO_OF_PHASES; ++phase)
+    {
+      output.print(F(", I"));
+      output.print(phase + 1);
+      output.print(F(":"));
+      output.print((float)current_data.Irms_L_x100[phase] * 0.01F);
+      output.print(F(", VA"));
+      output.print(phase + 1);
+      output.print(F(":"));
+      output.print(current_data.VA_L[phase]);
+      output.print(F(", PF"));
+      output.print(phase + 1);
+      output.print(F(":"));
+      output.print((float)current_data.PF_L_x100[phase] * 0.01F);
+    }
+  }
+
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    if (const uint16_t frequency_x100{ mainsFrequency_x100(copyOf_datalog) })
+    {
+      output.print(F(", F:"));
+      output.print(frequency_x100 * 0.01F);
+    }
   }
 
   if constexpr (TEMP_SENSOR_PRESENT)
@@ -318,25 +650,130 @@ inline void printForSerialText()
         continue;
       }
 
-      Serial.print(F(", T"));
-      Serial.print(idx + 1);
-      Serial.print(F(":"));
-      Serial.print((float)tx_data.temperature_x100[idx] * 0.01F);
+      output.print(F(", T"));
+      output.print(idx + 1);
+      output.print(F(":"));
+      output.print((float)tx_data.temperature_x100[idx] * 0.01F);
     }
   }
 
-  Serial.print(F(", (minSampleSets/MC "));
-  Serial.print(Shared::copyOf_lowestNoOfSampleSetsPerMainsCycle);
-  Serial.print(F(", #ofSampleSets "));
-  Serial.print(Shared::copyOf_sampleSetsDuringThisDatalogPeriod);
+  if constexpr (ENERGY_METERS)
+  {
+    printEnergyMeters();
+  }
+
+  output.print(F(", (minSampleSets/MC "));
+  output.print(copyOf_datalog.lowestNoOfSampleSetsPerMainsCycle);
+  output.print(F(", #ofSampleSets "));
+  output.print(copyOf_datalog.sampleSetsDuringThisDatalogPeriod);
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    printSampleIntegrity(copyOf_datalog);
+  }
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    printCurrentDCoffset(copyOf_datalog);
+  }
+  if constexpr (ISR_TIMING_INSTRUMENTATION)
+  {
+    printIsrTiming(copyOf_datalog);
+  }
 #ifndef DUAL_TARIFF
   if constexpr (PRIORITY_ROTATION != RotationModes::OFF)
   {
-    Serial.print(F(", NoED "));
-    Serial.print(Shared::absenceOfDivertedEnergyCountInSeconds);
+    output.print(F(", NoED "));
+    output.print(Shared::absenceOfDivertedEnergyCountInSeconds);
   }
 #endif  // DUAL_TARIFF
-  Serial.println(F(")"));
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    output.print(F(", TXD "));
+    output.print(txQueue.getDroppedFrames());
+  }
+  output.println(F(")"));
+}
+
+/**
+ * @brief Sends the missed and late conversions, and the histogram of the sample sets per mains cycle.
+ *
+ * @tparam Datalog The datalog type, whose sampleIntegrity member only exists with SAMPLE_INTEGRITY_DIAGNOSTICS
+ * @param teleInfo The frame being sent
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void sendSampleIntegrity(TeleInfo& teleInfo, const Datalog& data)
+{
+  teleInfo.send("MISS", data.sampleIntegrity.missedConversions);  // Send missed conversions
+  teleInfo.send("LATE", data.sampleIntegrity.lateConversions);    // Send late conversions
+
+  uint8_t idx{ NO_OF_SAMPLE_SET_BUCKETS };
+  do
+  {
+    --idx;
+    teleInfo.send("S_MC_H", data.sampleIntegrity.histogram[idx], idx + 1);  // Send the histogram of the sample sets per mains cycle
+  } while (idx);
+}
+
+/**
+ * @brief Sends the DC offset of the current of each phase.
+ *
+ * @tparam Datalog The datalog type, whose DCoffset_I member only exists with CURRENT_DC_OFFSET_TRACKING
+ * @param teleInfo The frame being sent
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void sendCurrentDCoffset(TeleInfo& teleInfo, const Datalog& data)
+{
+  uint8_t idx{ NO_OF_PHASES };
+  do
+  {
+    --idx;
+    teleInfo.send("I_DC", static_cast< int16_t >((data.DCoffset_I[idx] * 10 + 128) >> 8), idx + 1);  // Send DC offset of the current (in 10th of ADC steps)
+  } while (idx);
+}
+
+/**
+ * @brief Sends the measured execution times of the ISR, in µs, and the histogram of the ISR in ‰.
+ *
+ * @tparam Datalog The datalog type, whose isrTiming member only exists with ISR_TIMING_INSTRUMENTATION
+ * @param teleInfo The frame being sent
+ * @param data The datalog values
+ *
+ * @ingroup Telemetry
+ */
+template< typename Datalog >
+void sendIsrTiming(TeleInfo& teleInfo, const Datalog& data)
+{
+  const auto& isr{ data.isrTiming[static_cast< uint8_t >(TimedSections::ISR)] };
+
+  teleInfo.send("ISR_MIN", ticksToMicroseconds(isr.minTicks));
+  teleInfo.send("ISR_MAX", ticksToMicroseconds(isr.maxTicks));
+
+  uint32_t count{ 0 };
+  uint8_t idx{ NO_OF_TIMING_BUCKETS };
+  do
+  {
+    --idx;
+    count += isr.histogram[idx];
+  } while (idx);
+
+  if (count)
+  {
+    idx = NO_OF_TIMING_BUCKETS;
+    do
+    {
+      --idx;
+      teleInfo.send("ISR_H", static_cast< int16_t >(isr.histogram[idx] * 1000UL / count), idx + 1);  // Send the histogram in ‰
+    } while (idx);
+  }
+
+  teleInfo.send("PHC_MAX", ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::PLUS_HALF_CYCLE)].maxTicks));
+  teleInfo.send("SNC_MAX", ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::START_NEW_CYCLE)].maxTicks));
+  teleInfo.send("DL_MAX", ticksToMicroseconds(data.isrTiming[static_cast< uint8_t >(TimedSections::DATALOGGING)].maxTicks));
 }
 
 /**
@@ -356,6 +793,7 @@ inline void printForSerialText()
  * - **Power Data**: Sends the total power grid data.
  * - **Relay Data**: If relay diversion is enabled (`RELAY_DIVERSION`), sends the average relay data.
  * - **Voltage Data**: Sends the voltage data for each phase.
+ * - **Current Data**: If current measurement is enabled (`CURRENT_RMS_MEASUREMENT`), sends the current, apparent power and power factor for each phase.
  * - **Temperature Data**: If temperature sensing is enabled (`TEMP_SENSOR_PRESENT`), sends valid temperature readings.
  * - **Dual Tariff Data**: If dual tariff is enabled (`DUAL_TARIFF`), sends the current tariff state.
  * - **Absence of Diverted Energy Count**: The amount of seconds without diverting energy.
@@ -397,11 +835,33 @@ void sendTelemetryData(const bool bOffPeak)
     } while (idx);
   }
 
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    if (const uint16_t frequency_x100{ mainsFrequency_x100(copyOf_datalog) })
+    {
+      teleInfo.send("F", frequency_x100);  // Send mains frequency (in 100th of Hz)
+    }
+  }
+
+  if constexpr (CURRENT_RMS_MEASUREMENT)
+  {
+    idx = NO_OF_PHASES;
+    do
+    {
+      --idx;
+      const uint8_t index{ NO_OF_PHASES > 1 ? static_cast< uint8_t >(idx + 1) : static_cast< uint8_t >(0) };  // no index for a single phase
+
+      teleInfo.send("I", current_data.Irms_L_x100[idx], index);  // Send current (in 100th of A)
+      teleInfo.send("VA", current_data.VA_L[idx], index);        // Send apparent power
+      teleInfo.send("PF", current_data.PF_L_x100[idx], index);   // Send power factor (in 100th)
+    } while (idx);
+  }
+
   idx = NO_OF_DUMPLOADS;
   do
   {
     --idx;
-    teleInfo.send("D", Shared::copyOf_countLoadON[idx] * 100 * invDATALOG_PERIOD_IN_MAINS_CYCLES, idx + 1);  // Send load ON count for each load
+    teleInfo.send("D", copyOf_datalog.countLoadON[idx] * 100 * invDATALOG_PERIOD_IN_MAINS_CYCLES, idx + 1);  // Send load ON count for each load
   } while (idx);
 
   if constexpr (TEMP_SENSOR_PRESENT)
@@ -417,19 +877,116 @@ void sendTelemetryData(const bool bOffPeak)
     }
   }
 
-  teleInfo.send("N", static_cast< int16_t >(Shared::absenceOfDivertedEnergyCountInSeconds));  // Send absence of diverted energy count for 50Hz
+  if constexpr (ENERGY_METERS)
+  {
+    char digits[UINT64_MAX_DIGITS + 1];
+
+    teleInfo.send("EI", uint64ToDecimal(energyMeters.getImport(), digits));  // Send imported energy (in Wh)
+    teleInfo.send("EE", uint64ToDecimal(energyMeters.getExport(), digits));  // Send exported energy (in Wh)
+    for (uint8_t idx = 0; idx < NO_OF_DUMPLOADS; ++idx)
+    {
+      teleInfo.send("ED", uint64ToDecimal(energyMeters.getDiverted(idx), digits), idx + 1);  // Send diverted energy of each load (in Wh)
+    }
+  }
+
+  teleInfo.send("N", Shared::absenceOfDivertedEnergyCountInSeconds);  // Send absence of diverted energy count for 50Hz
 
   if constexpr (DUAL_TARIFF)
   {
     teleInfo.send("TA", static_cast< int16_t >(bOffPeak ? 1 : 0));  // Send current tariff state (0=high/on-peak, 1=low/off-peak)
   }
 
-  teleInfo.send("S", Shared::copyOf_sampleSetsDuringThisDatalogPeriod);
-  teleInfo.send("S_MC", Shared::copyOf_lowestNoOfSampleSetsPerMainsCycle);
+  teleInfo.send("S", copyOf_datalog.sampleSetsDuringThisDatalogPeriod);
+  teleInfo.send("S_MC", copyOf_datalog.lowestNoOfSampleSetsPerMainsCycle);
+
+  if constexpr (SAMPLE_INTEGRITY_DIAGNOSTICS)
+  {
+    sendSampleIntegrity(teleInfo, copyOf_datalog);
+  }
+
+  if constexpr (CURRENT_DC_OFFSET_TRACKING)
+  {
+    sendCurrentDCoffset(teleInfo, copyOf_datalog);
+  }
+
+  if constexpr (ISR_TIMING_INSTRUMENTATION)
+  {
+    sendIsrTiming(teleInfo, copyOf_datalog);
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    teleInfo.send("TXD", txQueue.getDroppedFrames());  // Send the number of frames dropped by the TX queue
+  }
 
   teleInfo.endFrame();  // Finalize and send the telemetry frame
 }
 
+/**
+ * @brief Sends the telemetry data as a compact binary frame.
+ *
+ * @param bOffPeak Indicates whether the system is in an off-peak tariff period.
+ *
+ * @details The frame is a BinaryPayload_struct followed by its CRC16, COBS-encoded and ended by a 0x00
+ *          delimiter (see binary_telemetry.h). Powers, voltages and temperatures are copied from `tx_data`,
+ *          with the same layout as the RF payload.
+ *
+ * @ingroup Telemetry
+ */
+inline void sendBinaryTelemetry(const bool bOffPeak)
+{
+  static uint8_t sequence{ 0 };
+
+  constexpr uint8_t noOfSensors{ size(tx_data.temperature_x100) };  // 0 without TEMP_ENABLED
+
+  BinaryPayload_struct< NO_OF_PHASES, noOfSensors, NO_OF_DUMPLOADS, relays.size() > payload;
+  static_assert(sizeof(payload) == binaryPayloadSize(NO_OF_PHASES, noOfSensors, NO_OF_DUMPLOADS), "******** Padding in the binary telemetry payload ! ********");
+  uint8_t frame[binaryFrameSize(sizeof(payload))];
+
+  payload.header.sequence = sequence++;
+  payload.data = tx_data;
+
+  if constexpr (RELAY_DIVERSION)
+  {
+    payload.header.flags |= BINARY_FLAG_RELAYS;
+    payload.relayAverage = static_cast< int16_t >(relays.get_average());
+
+    for (uint8_t idx = 0; idx < relays.size(); ++idx)
+    {
+      if (relays.get_relay(idx).isRelayON())
+      {
+        bit_set(payload.relayStates, idx);
+      }
+    }
+  }
+
+  if constexpr (DUAL_TARIFF)
+  {
+    payload.header.flags |= BINARY_FLAG_DUAL_TARIFF | (bOffPeak ? BINARY_FLAG_OFF_PEAK : 0);
+  }
+
+  if constexpr (MAINS_FREQUENCY_MEASUREMENT)
+  {
+    if (const uint16_t frequency_x100{ mainsFrequency_x100(copyOf_datalog) })
+    {
+      payload.header.flags |= BINARY_FLAG_FREQUENCY;
+      payload.frequency_x100 = frequency_x100;
+    }
+  }
+
+  for (uint8_t idx = 0; idx < NO_OF_DUMPLOADS; ++idx)
+  {
+    const uint32_t duty{ (copyOf_datalog.countLoadON[idx] * 200UL + DATALOG_PERIOD_IN_MAINS_CYCLES / 2) / DATALOG_PERIOD_IN_MAINS_CYCLES };
+    payload.loadDuty_x2[idx] = duty > 200 ? 200 : static_cast< uint8_t >(duty);
+  }
+
+  payload.absenceOfDivertedEnergyCount = Shared::absenceOfDivertedEnergyCountInSeconds;
+  payload.sampleSets = copyOf_datalog.sampleSetsDuringThisDatalogPeriod;
+  payload.lowestNoOfSampleSetsPerMainsCycle = copyOf_datalog.lowestNoOfSampleSetsPerMainsCycle;
+
+  telemetryPort().write(frame, encodeBinaryFrame(payload, frame));
+}
+
 /**
  * @brief Prints or sends telemetry data logs based on the selected output format.
  *
@@ -442,8 +999,9 @@ void sendTelemetryData(const bool bOffPeak)
  * @details
  * - If RF communication is enabled, it sends RF data.
  * - Depending on the `SERIAL_OUTPUT_TYPE`, it prints data in text format, sends telemetry
- *   data, or outputs data in JSON format.
+ *   data, outputs data in JSON format, or sends a binary frame.
  * - Skips the first datalogging event during startup to avoid incomplete data.
+ * - With TELEMETRY_TX_QUEUE, the output is queued as a single frame and sent in the background.
  *
  * @ingroup GeneralProcessing
  */
@@ -461,6 +1019,16 @@ inline void sendResults(bool bOffPeak)
   send_rf_data();  // *SEND RF DATA*
 #endif
 
+  if constexpr (CYCLE_STREAMING)
+  {
+    return;  // the serial link carries the per-cycle frames only
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    txQueue.beginFrame();
+  }
+
   if constexpr (SERIAL_OUTPUT_TYPE == SerialOutputType::HumanReadable)
   {
     printForSerialText();
@@ -473,6 +1041,36 @@ inline void sendResults(bool bOffPeak)
   {
     printForJSON(bOffPeak);
   }
+  else if constexpr (SERIAL_OUTPUT_TYPE == SerialOutputType::Binary)
+  {
+    sendBinaryTelemetry(bOffPeak);
+  }
+
+  if constexpr (TELEMETRY_TX_QUEUE)
+  {
+    txQueue.endFrame();  // queued entirely, or dropped if it doesn't fit
+  }
+}
+
+/**
+ * @brief Sends the queued per-cycle records as binary frames.
+ *
+ * @details A frame is only written when the transmit buffer of the serial link has room for all of it,
+ *          so that the main loop never blocks. Otherwise, the records wait in the ring buffer, and the
+ *          ISR drops the new ones when it is full (see cycle_stream.h).
+ *
+ * @ingroup GeneralProcessing
+ */
+inline void sendCycleRecords()
+{
+  CycleRecord record;
+  uint8_t frame[CYCLE_FRAME_SIZE];
+
+  while (Serial.availableForWrite() >= CYCLE_FRAME_SIZE && Shared::cycleStream.pop(record))
+  {
+    encodeCycleFrame(record, frame);
+    Serial.write(frame, CYCLE_FRAME_SIZE);
+  }
 }
 
 /**
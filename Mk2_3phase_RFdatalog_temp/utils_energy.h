@@ -0,0 +1,141 @@
+/**
+ * @file utils_energy.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Update of the energy meters and their wear-levelled storage in EEPROM
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UTILS_ENERGY_H
+#define UTILS_ENERGY_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "config.h"
+#include "debug.h"
+#include "energy_meters.h"
+#include "processing.h"
+#include "shared_var.h"
+#include "utils_params.h"
+
+inline constexpr uint16_t EEPROM_ENERGY_ADDRESS{ 16 }; /**< address of the ring of energy records in EEPROM, after the parameter block */
+
+static_assert(EEPROM_ENERGY_ADDRESS >= EEPROM_PARAMS_ADDRESS + sizeof(StoredParams), "******** The energy records overlap the runtime parameters ! ********");
+static_assert(EEPROM_ENERGY_ADDRESS + ENERGY_METERS_EEPROM_SLOTS * sizeof(EnergyRecord) <= E2END + 1, "******** The energy records don't fit in EEPROM ! ********");
+
+inline constexpr uint16_t ENERGY_METERS_SAVE_PERIOD_IN_DATALOGS{ ENERGY_METERS_SAVE_PERIOD_IN_MINUTES * 60U / DATALOG_PERIOD_IN_SECONDS }; /**< datalog periods between two saves */
+
+inline uint8_t energySlot{ 0 };      /**< slot of the latest record */
+inline uint32_t energySequence{ 0 }; /**< sequence number of the latest record */
+
+/**
+ * @brief Address of a slot of the ring
+ *
+ * @param slot The slot
+ * @return The address in EEPROM
+ */
+inline uint16_t energySlotAddress(const uint8_t slot)
+{
+  return EEPROM_ENERGY_ADDRESS + slot * sizeof(EnergyRecord);
+}
+
+/**
+ * @brief Restores the energy meters from the latest valid record in EEPROM
+ *
+ * @details If there's none (first start, or change of the number of loads), the meters start from 0
+ *          and the first save goes to the first slot.
+ *
+ * @ingroup Initialization
+ */
+inline void loadEnergyMeters()
+{
+  EnergyRecord latest;
+
+  energySlot = findLatestEnergyRecord([](const uint8_t slot, EnergyRecord &record) { EEPROM.get(energySlotAddress(slot), record); },
+                                      ENERGY_METERS_EEPROM_SLOTS, latest);
+
+  if (energySlot == ENERGY_METERS_EEPROM_SLOTS)
+  {
+    energySlot = ENERGY_METERS_EEPROM_SLOTS - 1;
+    return;
+  }
+
+  energySequence = latest.sequence;
+  energyMeters.restore(latest);
+}
+
+/**
+ * @brief Writes the energy meters to the next slot of the ring
+ *
+ * @details The previous records are left untouched, so that a reset during the write
+ *          only loses the last period.
+ *
+ * @ingroup GeneralProcessing
+ */
+inline void saveEnergyMeters()
+{
+  if (++energySlot == ENERGY_METERS_EEPROM_SLOTS)
+  {
+    energySlot = 0;
+  }
+
+  EEPROM.put(energySlotAddress(energySlot), energyMeters.toRecord(++energySequence));
+}
+
+/**
+ * @brief Adds the energies of the last datalog period, and saves the meters periodically
+ *
+ * @details Must be called after updatePowerAndVoltageData(). As for the outputs, the first
+ *          datalog period, which is incomplete, is skipped.
+ *
+ * @ingroup GeneralProcessing
+ */
+inline void updateEnergyMeters()
+{
+  static bool startup{ true };
+  static uint16_t datalogsSinceLastSave{ 0 };
+
+  if (startup)
+  {
+    startup = false;
+    return;
+  }
+
+  energyMeters.update(tx_data.power, copyOf_datalog.countLoadON, DATALOG_PERIOD_IN_MAINS_CYCLES, SUPPLY_FREQUENCY);
+
+  if (++datalogsSinceLastSave >= ENERGY_METERS_SAVE_PERIOD_IN_DATALOGS)
+  {
+    datalogsSinceLastSave = 0;
+    saveEnergyMeters();
+  }
+}
+
+/**
+ * @brief Prints the energy meters restored at start-up
+ *
+ * @ingroup Debugging
+ */
+inline void printRestoredEnergyMeters()
+{
+  char digits[UINT64_MAX_DIGITS + 1];
+
+  DBUG(F("Energy meters: import "));
+  DBUG(uint64ToDecimal(energyMeters.getImport(), digits));
+  DBUG(F(" Wh, export "));
+  DBUG(uint64ToDecimal(energyMeters.getExport(), digits));
+  DBUG(F(" Wh, diverted"));
+  for (uint8_t i = 0; i < NO_OF_DUMPLOADS; ++i)
+  {
+    DBUG(F(" "));
+    DBUG(uint64ToDecimal(energyMeters.getDiverted(i), digits));
+  }
+  DBUG(F(" Wh (record #"));
+  DBUG(energySequence);
+  DBUGLN(F(")"));
+}
+
+#endif /* UTILS_ENERGY_H */
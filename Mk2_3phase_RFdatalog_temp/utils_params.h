@@ -0,0 +1,128 @@
+/**
+ * @file utils_params.h
+ * @author Frédéric Metrich (frederic.metrich@live.fr)
+ * @brief Storage of the runtime parameters in EEPROM and serial commands to change them
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UTILS_PARAMS_H
+#define UTILS_PARAMS_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "config.h"
+#include "debug.h"
+#include "runtime_params.h"
+
+inline constexpr uint16_t EEPROM_PARAMS_ADDRESS{ 0 };     /**< address of the parameter block in EEPROM */
+inline constexpr uint8_t PARAMS_COMMAND_MAX_LENGTH{ 15 }; /**< longest serial command, without the terminator */
+
+inline StoredParams storedParams; /**< parameters as stored in EEPROM */
+
+/**
+ * @brief Prints the runtime parameters
+ *
+ * @ingroup Debugging
+ */
+inline void printRuntimeParams()
+{
+  DBUG(F("Runtime parameters: mode "));
+  DBUG(OutputModes::NORMAL == storedParams.outputMode ? F("normal") : OutputModes::ANTI_FLICKER == storedParams.outputMode ? F("anti-flicker")
+                                                                                                                            : F("cycle distribution"));
+  DBUG(F(", thresholds "));
+  DBUG(storedParams.lowerThresholdInPercent);
+  DBUG(F("% / "));
+  DBUG(storedParams.upperThresholdInPercent);
+  DBUG(F("%, export "));
+  DBUG(storedParams.requiredExportInWatts);
+  DBUG(F(" W, diversion start "));
+  DBUG(storedParams.diversionStartThresholdInWatts);
+  DBUGLN(F(" W"));
+}
+
+/**
+ * @brief Loads the runtime parameters from EEPROM, or the defaults of the build if the block is not valid
+ *
+ * @ingroup Initialization
+ */
+inline void loadRuntimeParams()
+{
+  EEPROM.get(EEPROM_PARAMS_ADDRESS, storedParams);
+
+  if (!areParamsValid(storedParams))
+  {
+    storedParams = StoredParams{};
+    storedParams.checksum = paramsChecksum(storedParams);
+  }
+
+  applyRuntimeParams(storedParams);
+}
+
+/**
+ * @brief Reads and applies the serial commands, one per line
+ *
+ * @details The parameters are written to EEPROM on each valid command (EEPROM.put only writes
+ *          the bytes which have changed). See parseParamsCommand() for the syntax.
+ *          A line longer than PARAMS_COMMAND_MAX_LENGTH is rejected as a whole, so that its
+ *          truncated text is never taken for another command.
+ *
+ * @ingroup GeneralProcessing
+ */
+inline void processSerialCommands()
+{
+  static char line[PARAMS_COMMAND_MAX_LENGTH + 1];
+  static uint8_t length{ 0 };
+  static bool overflow{ false };
+
+  while (Serial.available())
+  {
+    const char c{ static_cast< char >(Serial.read()) };
+
+    if (c != '\n' && c != '\r')
+    {
+      if (length < PARAMS_COMMAND_MAX_LENGTH)
+      {
+        line[length++] = c;
+      }
+      else
+      {
+        overflow = true;  // the rest of the line is dropped, and the line rejected
+      }
+      continue;
+    }
+
+    if (overflow)
+    {
+      overflow = false;
+      length = 0;
+      DBUGLN(F("Command too long, ignored"));
+      continue;
+    }
+
+    if (!length)
+    {
+      continue;
+    }
+
+    line[length] = '\0';
+    length = 0;
+
+    if (parseParamsCommand(line, storedParams))
+    {
+      applyRuntimeParams(storedParams);
+      EEPROM.put(EEPROM_PARAMS_ADDRESS, storedParams);
+    }
+    else
+    {
+      DBUGLN(F("Unknown command, use M N|A|C, L <%>, U <%>, E <W>, S <W> or D"));
+    }
+    printRuntimeParams();
+  }
+}
+
+#endif /* UTILS_PARAMS_H */
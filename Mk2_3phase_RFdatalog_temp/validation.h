@@ -43,6 +43,8 @@ static_assert(!EMONESP_CONTROL || (DIVERSION_PIN_PRESENT && (PRIORITY_ROTATION =
 
 static_assert(!RELAY_DIVERSION | (60 / DATALOG_PERIOD_IN_SECONDS * DATALOG_PERIOD_IN_SECONDS == 60), "******** Wrong configuration. DATALOG_PERIOD_IN_SECONDS must be a divider of 60 ! ********");
 
+static_assert(!(ADC_TIMER_TRIGGERED && ISR_TIMING_INSTRUMENTATION), "******** Timer1 cannot trigger the ADC and measure the ISR at the same time ! ********");
+
 static_assert(NO_OF_DUMPLOADS > 0, "Number of dump loads must be greater than 0");
 static_assert(iTemperatureThreshold > 0, "Temperature threshold must be greater than 0");
 static_assert(iTemperatureThreshold <= 100, "Temperature threshold must be lower than 100");
@@ -53,6 +55,16 @@ static_assert(DIVERSION_START_THRESHOLD_WATTS >= 0 && DIVERSION_START_THRESHOLD_
 static_assert(sizeof(physicalLoadPin) / sizeof(physicalLoadPin[0]) == NO_OF_DUMPLOADS, "******** physicalLoadPin array size mismatch ! ********");
 static_assert(sizeof(loadPrioritiesAtStartup) / sizeof(loadPrioritiesAtStartup[0]) == NO_OF_DUMPLOADS, "******** loadPrioritiesAtStartup array size mismatch ! ********");
 static_assert(sizeof(rg_ForceLoad) / sizeof(rg_ForceLoad[0]) == NO_OF_DUMPLOADS, "******** rg_ForceLoad array size mismatch ! ********");
+static_assert(sizeof(loadRatedPowerInWatts) / sizeof(loadRatedPowerInWatts[0]) == NO_OF_DUMPLOADS, "******** loadRatedPowerInWatts array size mismatch ! ********");
+
+static_assert(!TELEMETRY_DELTA_FRAMES || SERIAL_OUTPUT_TYPE == SerialOutputType::IoT, "******** Delta frames are only available in IoT format ! ********");
+
+#if defined(ENABLE_DEBUG) && defined(DEBUG_PORT)
+static_assert(!CYCLE_STREAMING || static_cast< const Print* >(&DEBUG_PORT) != static_cast< const Print* >(&Serial), "******** The debug output would corrupt the binary frames of CYCLE_STREAMING, please disable ENABLE_DEBUG or use another DEBUG_PORT ! ********");
+#endif
+static_assert(TELEMETRY_KEYFRAME_PERIOD > 0, "******** TELEMETRY_KEYFRAME_PERIOD must be at least 1 ! ********");
+
+static_assert(ENERGY_METERS_SAVE_PERIOD_IN_MINUTES * 60UL >= DATALOG_PERIOD_IN_SECONDS, "******** ENERGY_METERS_SAVE_PERIOD_IN_MINUTES must be longer than the datalog period ! ********");
 
 static_assert(ROTATION_AFTER_SECONDS > 0, "******** ROTATION_AFTER_SECONDS must be greater than 0 ! ********");
 static_assert(ROTATION_AFTER_SECONDS <= 86400UL, "******** ROTATION_AFTER_SECONDS cannot exceed 24 hours ! ********");